@@ -0,0 +1,200 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "cpuaffinity.h"
+#include "qtest_sysfs.h"
+
+#include <sched.h>
+
+using Solid::Backends::UDev::CpuAffinity;
+
+class CpuAffinityTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testCgroupPath();
+    void testParseCpuMax_data();
+    void testParseCpuMax();
+    void testCpuset();
+    void testNestedQuota();
+    void testUnknown();
+    void testSystem();
+    void testSystemFollowsAffinity();
+    void benchmarkSystem();
+};
+
+static QList<int> cpuRange(int first, int last)
+{
+    QList<int> cpus;
+    for (int cpu = first; cpu <= last; ++cpu) {
+        cpus << cpu;
+    }
+    return cpus;
+}
+
+void CpuAffinityTest::testCgroupPath()
+{
+    QCOMPARE(CpuAffinity::cgroupPath("0::/system.slice/analytics.service\n"),
+             QByteArray("/system.slice/analytics.service"));
+    // Hybrid hierarchies list the v1 controllers first
+    QCOMPARE(CpuAffinity::cgroupPath("12:cpuset:/\n"
+                                     "11:cpu,cpuacct:/user.slice\n"
+                                     "1:name=systemd:/user.slice/session-2.scope\n"
+                                     "0::/user.slice/session-2.scope\n"),
+             QByteArray("/user.slice/session-2.scope"));
+    // Inside a cgroup namespace the container is the root
+    QCOMPARE(CpuAffinity::cgroupPath("0::/\n"), QByteArray("/"));
+    QVERIFY(CpuAffinity::cgroupPath("4:cpuset:/docker/f00ba7\n").isEmpty());
+}
+
+void CpuAffinityTest::testParseCpuMax_data()
+{
+    QTest::addColumn<QByteArray>("cpuMax");
+    QTest::addColumn<qreal>("quota");
+
+    QTest::newRow("unlimited") << QByteArray("max 100000\n") << qreal(-1);
+    QTest::newRow("one and a half") << QByteArray("150000 100000\n") << qreal(1.5);
+    QTest::newRow("quarter") << QByteArray("25000 100000") << qreal(0.25);
+    QTest::newRow("missing") << QByteArray() << qreal(-1);
+    QTest::newRow("garbage") << QByteArray("lots 0") << qreal(-1);
+}
+
+void CpuAffinityTest::testParseCpuMax()
+{
+    QFETCH(QByteArray, cpuMax);
+    QFETCH(qreal, quota);
+
+    QCOMPARE(CpuAffinity::parseCpuMax(cpuMax), quota);
+}
+
+void CpuAffinityTest::testCpuset()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    const QString group = root.path() + QLatin1String("/system.slice/analytics.service");
+    QVERIFY(QDir().mkpath(group));
+    QVERIFY(writeAttribute(group + QLatin1String("/cpuset.cpus.effective"), "2-5,8"));
+
+    // The affinity mask of the process and the cpuset of its cgroup both apply
+    const CpuAffinity affinity(cpuRange(0, 5), root.path(), "/system.slice/analytics.service");
+    QVERIFY(affinity.isKnown());
+    QCOMPARE(affinity.usable(), QList<int>() << 2 << 3 << 4 << 5);
+    QVERIFY(affinity.isUsable(2));
+    QVERIFY(!affinity.isUsable(1));
+    QVERIFY(!affinity.isUsable(8));
+    QCOMPARE(affinity.quota(), qreal(-1));
+
+    // Without an affinity mask the cpuset alone decides
+    const CpuAffinity cpusetOnly(QList<int>(), root.path(), "/system.slice/analytics.service");
+    QCOMPARE(cpusetOnly.usable(), QList<int>() << 2 << 3 << 4 << 5 << 8);
+}
+
+void CpuAffinityTest::testNestedQuota()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    const QString slice = root.path() + QLatin1String("/batch.slice");
+    const QString service = slice + QLatin1String("/analytics.service");
+    QVERIFY(QDir().mkpath(service));
+
+    // The service may use 4 CPUs, but its slice only 2
+    QVERIFY(writeAttribute(root.path() + QLatin1String("/cpu.max"), "max 100000"));
+    QVERIFY(writeAttribute(slice + QLatin1String("/cpu.max"), "200000 100000"));
+    QVERIFY(writeAttribute(service + QLatin1String("/cpu.max"), "400000 100000"));
+
+    const CpuAffinity affinity(cpuRange(0, 15), root.path(), "/batch.slice/analytics.service/");
+    QCOMPARE(affinity.quota(), qreal(2));
+    QCOMPARE(affinity.usable().count(), 16);
+
+    QVERIFY(writeAttribute(service + QLatin1String("/cpu.max"), "50000 100000"));
+    QCOMPARE(CpuAffinity(cpuRange(0, 15), root.path(), "/batch.slice/analytics.service").quota(), qreal(0.5));
+
+    // A namespaced container reads its own limit at the root
+    QVERIFY(writeAttribute(root.path() + QLatin1String("/cpu.max"), "300000 100000"));
+    QCOMPARE(CpuAffinity(cpuRange(0, 15), root.path(), "/").quota(), qreal(3));
+}
+
+void CpuAffinityTest::testUnknown()
+{
+    // Nothing read, nothing restricted
+    const CpuAffinity affinity;
+    QVERIFY(!affinity.isKnown());
+    QVERIFY(affinity.isUsable(0));
+    QVERIFY(affinity.isUsable(4095));
+    QCOMPARE(affinity.quota(), qreal(-1));
+
+    const CpuAffinity noCgroup(QList<int>() << 1 << 3, QStringLiteral("/nonexistent"), QByteArray());
+    QCOMPARE(noCgroup.usable(), QList<int>() << 1 << 3);
+}
+
+void CpuAffinityTest::testSystem()
+{
+    CpuAffinity::invalidateSystem();
+    const CpuAffinity &affinity = CpuAffinity::system();
+
+    // Whatever confines this test, it runs on a usable CPU
+    QVERIFY(affinity.isKnown());
+    QVERIFY(!affinity.usable().isEmpty());
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        QVERIFY(affinity.isUsable(cpu));
+    }
+    QVERIFY(affinity.quota() == -1 || affinity.quota() > 0);
+}
+
+void CpuAffinityTest::testSystemFollowsAffinity()
+{
+    cpu_set_t original;
+    CPU_ZERO(&original);
+    QVERIFY(sched_getaffinity(0, sizeof(original), &original) == 0);
+    const QList<int> before = CpuAffinity::system().usable();
+    if (before.count() < 2) {
+        QSKIP("Needs two usable CPUs");
+    }
+
+    // Pinning the process shows without invalidating anything
+    const int pinned = before.first();
+    cpu_set_t single;
+    CPU_ZERO(&single);
+    CPU_SET(pinned, &single);
+    QVERIFY(sched_setaffinity(0, sizeof(single), &single) == 0);
+    const QList<int> narrowed = CpuAffinity::system().usable();
+    QVERIFY(sched_setaffinity(0, sizeof(original), &original) == 0);
+
+    QCOMPARE(narrowed, QList<int>() << pinned);
+    QCOMPARE(CpuAffinity::system().usable().count(), before.count());
+}
+
+void CpuAffinityTest::benchmarkSystem()
+{
+    // What sizing a thread pool costs at startup
+    QBENCHMARK {
+        CpuAffinity::invalidateSystem();
+        QVERIFY(!CpuAffinity::system().usable().isEmpty());
+    }
+}
+
+QTEST_GUILESS_MAIN(CpuAffinityTest)
+
+#include "cpuaffinitytest.moc"
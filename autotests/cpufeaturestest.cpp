@@ -0,0 +1,207 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QTest>
+
+#include "cpufeatures.h"
+
+using namespace Solid::Backends::Shared;
+
+class CpuFeaturesTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testX86_data();
+    void testX86();
+    void testHwcap_data();
+    void testHwcap();
+    void testCacheLeaf_data();
+    void testCacheLeaf();
+    void testCoreTypeLeaf();
+    void testDetectOnce();
+};
+
+static const Solid::Processor::InstructionSets sseFamily = Solid::Processor::IntelMmx
+        | Solid::Processor::IntelSse | Solid::Processor::IntelSse2 | Solid::Processor::IntelSse3
+        | Solid::Processor::IntelSsse3 | Solid::Processor::IntelSse41 | Solid::Processor::IntelSse42;
+
+static const Solid::Processor::InstructionSets avxFamily = Solid::Processor::IntelAvx
+        | Solid::Processor::IntelAvx2 | Solid::Processor::IntelFma3
+        | Solid::Processor::IntelVaes | Solid::Processor::IntelVpclmulqdq;
+
+static const Solid::Processor::InstructionSets avx512Family = Solid::Processor::IntelAvx512F
+        | Solid::Processor::IntelAvx512Cd | Solid::Processor::IntelAvx512Bw
+        | Solid::Processor::IntelAvx512Dq | Solid::Processor::IntelAvx512Vl;
+
+static const Solid::Processor::InstructionSets scalarFamily = Solid::Processor::IntelBmi1
+        | Solid::Processor::IntelBmi2 | Solid::Processor::IntelAes | Solid::Processor::IntelSha;
+
+void CpuFeaturesTest::testX86_data()
+{
+    QTest::addColumn<uint>("leaf1Ecx");
+    QTest::addColumn<uint>("leaf1Edx");
+    QTest::addColumn<uint>("leaf7Ebx");
+    QTest::addColumn<uint>("leaf7Ecx");
+    QTest::addColumn<uint>("extLeaf1Edx");
+    QTest::addColumn<qulonglong>("xcr0");
+    QTest::addColumn<int>("expected");
+
+    // Recorded on a Sapphire Rapids virtual machine
+    QTest::newRow("sapphire rapids")
+            << 0xfffa3203u << 0x0f8bfbffu << 0xf1bf27ebu << 0x1b415fdeu << 0x2c100800u << Q_UINT64_C(0x602e7)
+            << int(sseFamily | avxFamily | avx512Family | scalarFamily);
+    // The same processor under an OS that does not save the AVX-512 state
+    QTest::newRow("sapphire rapids, no zmm state")
+            << 0xfffa3203u << 0x0f8bfbffu << 0xf1bf27ebu << 0x1b415fdeu << 0x2c100800u << Q_UINT64_C(0x7)
+            << int(sseFamily | avxFamily | scalarFamily);
+    // ... nor the AVX state
+    QTest::newRow("sapphire rapids, no ymm state")
+            << 0xfffa3203u << 0x0f8bfbffu << 0xf1bf27ebu << 0x1b415fdeu << 0x2c100800u << Q_UINT64_C(0x3)
+            << int(sseFamily | scalarFamily);
+    // ... nor XSAVE at all
+    QTest::newRow("sapphire rapids, no osxsave")
+            << 0xf7fa3203u << 0x0f8bfbffu << 0xf1bf27ebu << 0x1b415fdeu << 0x2c100800u << Q_UINT64_C(0)
+            << int(sseFamily | scalarFamily);
+    // Core 2 (Penryn): highest standard leaf is 0xd but leaf 7 reads as zero
+    QTest::newRow("penryn")
+            << 0x0008e3fdu << 0xbfebfbffu << 0u << 0u << 0x20100000u << Q_UINT64_C(0)
+            << int(Solid::Processor::IntelMmx | Solid::Processor::IntelSse | Solid::Processor::IntelSse2
+                   | Solid::Processor::IntelSse3 | Solid::Processor::IntelSsse3 | Solid::Processor::IntelSse41);
+    // Athlon 64 (Venice): no leaf 7, 3DNow! in the extended leaf
+    QTest::newRow("athlon 64")
+            << 0x00000001u << 0x078bfbffu << 0u << 0u << 0xe3d3fbffu << Q_UINT64_C(0)
+            << int(Solid::Processor::IntelMmx | Solid::Processor::IntelSse | Solid::Processor::IntelSse2
+                   | Solid::Processor::IntelSse3 | Solid::Processor::Amd3DNow);
+    QTest::newRow("nothing") << 0u << 0u << 0u << 0u << 0u << Q_UINT64_C(0) << 0;
+}
+
+void CpuFeaturesTest::testX86()
+{
+    CpuIdRegisters registers;
+    QFETCH(uint, leaf1Ecx);
+    QFETCH(uint, leaf1Edx);
+    QFETCH(uint, leaf7Ebx);
+    QFETCH(uint, leaf7Ecx);
+    QFETCH(uint, extLeaf1Edx);
+    QFETCH(qulonglong, xcr0);
+    QFETCH(int, expected);
+
+    registers.leaf1Ecx = leaf1Ecx;
+    registers.leaf1Edx = leaf1Edx;
+    registers.leaf7Ebx = leaf7Ebx;
+    registers.leaf7Ecx = leaf7Ecx;
+    registers.extLeaf1Edx = extLeaf1Edx;
+    registers.xcr0 = xcr0;
+
+    QCOMPARE(int(x86Features(registers)), expected);
+}
+
+void CpuFeaturesTest::testHwcap_data()
+{
+    QTest::addColumn<int>("architecture");
+    QTest::addColumn<qulonglong>("hwcap");
+    QTest::addColumn<int>("expected");
+
+    // Cortex-A72 with 64 bit and 32 bit userlands, Neoverse-V1
+    QTest::newRow("cortex-a72 aarch64") << int(HwcapAArch64) << Q_UINT64_C(0x887) << int(Solid::Processor::ArmNeon);
+    QTest::newRow("cortex-a72 arm") << int(HwcapArm) << Q_UINT64_C(0x3fb0d6) << int(Solid::Processor::ArmNeon);
+    QTest::newRow("neoverse-v1") << int(HwcapAArch64) << Q_UINT64_C(0xefffffbfff)
+                                 << int(Solid::Processor::ArmNeon | Solid::Processor::ArmSve);
+    QTest::newRow("arm without neon") << int(HwcapArm) << Q_UINT64_C(0x400000) << 0;
+    QTest::newRow("power8") << int(HwcapPowerPC) << Q_UINT64_C(0xdc0065c2) << int(Solid::Processor::AltiVec);
+    QTest::newRow("power without altivec") << int(HwcapPowerPC) << Q_UINT64_C(0x8c000000) << 0;
+}
+
+void CpuFeaturesTest::testHwcap()
+{
+    QFETCH(int, architecture);
+    QFETCH(qulonglong, hwcap);
+    QFETCH(int, expected);
+
+    QCOMPARE(int(hwcapFeatures(HwcapArchitecture(architecture), hwcap)), expected);
+}
+
+void CpuFeaturesTest::testCacheLeaf_data()
+{
+    QTest::addColumn<uint>("eax");
+    QTest::addColumn<uint>("ebx");
+    QTest::addColumn<uint>("ecx");
+    QTest::addColumn<int>("level");
+    QTest::addColumn<int>("type");
+    QTest::addColumn<qulonglong>("size");
+    QTest::addColumn<int>("associativity");
+    QTest::addColumn<int>("threadsSharing");
+
+    // Leaf 4 recorded on the Sapphire Rapids virtual machine
+    QTest::newRow("l1d") << 0x00000121u << 0x02c0003fu << 0x0000003fu
+                         << 1 << int(Solid::Processor::DataCache) << Q_UINT64_C(49152) << 12 << 1;
+    QTest::newRow("l1i") << 0x00000122u << 0x01c0003fu << 0x0000003fu
+                         << 1 << int(Solid::Processor::InstructionCache) << Q_UINT64_C(32768) << 8 << 1;
+    QTest::newRow("l2") << 0x00000143u << 0x03c0003fu << 0x000007ffu
+                        << 2 << int(Solid::Processor::UnifiedCache) << Q_UINT64_C(2097152) << 16 << 1;
+    QTest::newRow("l3") << 0x00000163u << 0x04c0003fu << 0x0003bfffu
+                        << 3 << int(Solid::Processor::UnifiedCache) << Q_UINT64_C(314572800) << 20 << 1;
+    // An L2 shared by two threads, as on hosts with SMT
+    QTest::newRow("shared l2") << 0x00004143u << 0x03c0003fu << 0x000007ffu
+                               << 2 << int(Solid::Processor::UnifiedCache) << Q_UINT64_C(2097152) << 16 << 2;
+}
+
+void CpuFeaturesTest::testCacheLeaf()
+{
+    QFETCH(uint, eax);
+    QFETCH(uint, ebx);
+    QFETCH(uint, ecx);
+
+    CpuIdCache cache;
+    QVERIFY(decodeCacheLeaf(eax, ebx, ecx, &cache));
+    QTEST(cache.level, "level");
+    QTEST(int(cache.type), "type");
+    QTEST(cache.size, "size");
+    QCOMPARE(cache.lineSize, 64);
+    QTEST(cache.associativity, "associativity");
+    QTEST(cache.threadsSharing, "threadsSharing");
+
+    // The null subleaf ends the list
+    QVERIFY(!decodeCacheLeaf(0, 0, 0, &cache));
+}
+
+void CpuFeaturesTest::testCoreTypeLeaf()
+{
+    // Leaf 0x1A of the two core types of an Alder Lake, and of a non-hybrid part
+    QCOMPARE(decodeCoreTypeLeaf(0x40000001), Solid::Processor::PerformanceCore);
+    QCOMPARE(decodeCoreTypeLeaf(0x20000001), Solid::Processor::EfficiencyCore);
+    QCOMPARE(decodeCoreTypeLeaf(0), Solid::Processor::UnknownCore);
+}
+
+void CpuFeaturesTest::testDetectOnce()
+{
+    const Solid::Processor::InstructionSets features = cpuFeatures();
+    QCOMPARE(int(cpuFeatures()), int(features));
+
+#if defined(__x86_64__) || defined(_M_X64)
+    // SSE2 is part of the x86-64 baseline
+    QVERIFY(features & Solid::Processor::IntelSse2);
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    QVERIFY(features & Solid::Processor::ArmNeon);
+#endif
+}
+
+QTEST_GUILESS_MAIN(CpuFeaturesTest)
+#include "cpufeaturestest.moc"
@@ -0,0 +1,149 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QTest>
+
+#include "cpuinfo.h"
+
+using Solid::Backends::UDev::CpuInfo;
+
+class CpuInfoTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testParse();
+    void testArm();
+    void testSystemTable();
+    void benchmarkLookups_data();
+    void benchmarkLookups();
+};
+
+static QByteArray x86Record(int processor, double mhz)
+{
+    return "processor\t: " + QByteArray::number(processor) + "\n"
+           "vendor_id\t: GenuineIntel\n"
+           "cpu family\t: 6\n"
+           "model\t\t: 85\n"
+           "model name\t: Intel(R) Xeon(R) Gold 6230 CPU @ 2.10GHz\n"
+           "stepping\t: 7\n"
+           "cpu MHz\t\t: " + QByteArray::number(mhz, 'f', 3) + "\n"
+           "cache size\t: 28160 KB\n"
+           "physical id\t: " + QByteArray::number(processor / 40) + "\n"
+           "siblings\t: 40\n"
+           "core id\t\t: " + QByteArray::number(processor % 20) + "\n"
+           "cpu cores\t: 20\n"
+           "flags\t\t: fpu vme de pse tsc msr pae mce cx8 apic sep mtrr pge mca cmov pat pse36 clflush dts acpi mmx fxsr sse sse2 ss ht tm pbe syscall nx pdpe1gb rdtscp lm constant_tsc art arch_perfmon pebs bts rep_good nopl xtopology nonstop_tsc cpuid aperfmperf pni pclmulqdq dtes64 monitor ds_cpl vmx smx est tm2 ssse3 sdbg fma cx16 xtpr pdcm pcid dca sse4_1 sse4_2 x2apic movbe popcnt tsc_deadline_timer aes xsave avx f16c rdrand lahf_lm abm 3dnowprefetch cpuid_fault epb cat_l3 cdp_l3 invpcid_single intel_ppin ssbd mba ibrs ibpb stibp ibrs_enhanced tpr_shadow vnmi flexpriority ept vpid ept_ad fsgsbase tsc_adjust bmi1 hle avx2 smep bmi2 erms invpcid rtm cqm mpx rdt_a avx512f avx512dq rdseed adx smap clflushopt clwb intel_pt avx512cd avx512bw avx512vl xsaveopt xsavec xgetbv1 xsaves cqm_llc cqm_occup_llc cqm_mbm_total cqm_mbm_local dtherm ida arat pln pts pku ospke avx512_vnni md_clear flush_l1d arch_capabilities\n"
+           "bogomips\t: 4200.00\n"
+           "\n";
+}
+
+static QByteArray syntheticCpuInfo(int processors)
+{
+    QByteArray contents;
+    for (int i = 0; i < processors; ++i) {
+        contents += x86Record(i, 1000 + i);
+    }
+    return contents;
+}
+
+void CpuInfoTest::testParse()
+{
+    const CpuInfo info(x86Record(0, 2100) + x86Record(1, 799.998) + "processor\t: 3\n\n");
+
+    QCOMPARE(info.count(), 3);
+    QVERIFY(info.contains(1));
+    QVERIFY(!info.contains(2));
+    QCOMPARE(info.processor(0).vendor, QStringLiteral("GenuineIntel"));
+    QCOMPARE(info.processor(0).model, QStringLiteral("Intel(R) Xeon(R) Gold 6230 CPU @ 2.10GHz"));
+    QCOMPARE(info.processor(0).speed, 2100);
+    QCOMPARE(info.processor(1).speed, 799);
+
+    // Nothing leaks from one record into the next
+    QVERIFY(info.processor(3).vendor.isEmpty());
+    QCOMPARE(info.processor(3).speed, 0);
+    QVERIFY(info.processor(2).model.isEmpty());
+    QVERIFY(info.hardware().isEmpty());
+    QVERIFY(info.processorModel().isEmpty());
+}
+
+void CpuInfoTest::testArm()
+{
+    const CpuInfo info("Processor\t: ARMv7 Processor rev 10 (v7l)\n"
+                       "processor\t: 0\n"
+                       "BogoMIPS\t: 1581.05\n\n"
+                       "processor\t: 1\n"
+                       "BogoMIPS\t: 1581.05\n\n"
+                       "Features\t: swp half thumb fastmult vfp edsp neon vfpv3 tls\n"
+                       "Hardware\t: Freescale i.MX 6Quad/DualLite (Device Tree)\n"
+                       "Revision\t: 0000\n");
+
+    QCOMPARE(info.count(), 2);
+    QVERIFY(info.processor(1).model.isEmpty());
+    QCOMPARE(info.processorModel(), QStringLiteral("ARMv7 Processor rev 10 (v7l)"));
+    QCOMPARE(info.hardware(), QStringLiteral("Freescale i.MX 6Quad/DualLite (Device Tree)"));
+}
+
+void CpuInfoTest::testSystemTable()
+{
+    CpuInfo::system();
+    const int reads = CpuInfo::systemReads();
+
+    // Every processor, every lookup served from the same table
+    for (int i = 0; i < 16; ++i) {
+        Solid::Backends::UDev::extractCpuVendor(i);
+        Solid::Backends::UDev::extractCpuModel(i);
+        Solid::Backends::UDev::extractCurrentCpuSpeed(i);
+    }
+    QCOMPARE(CpuInfo::systemReads(), reads);
+
+    CpuInfo::invalidateSystem();
+    Solid::Backends::UDev::extractCpuModel(0);
+    Solid::Backends::UDev::extractCpuModel(1);
+    QCOMPARE(CpuInfo::systemReads(), reads + 1);
+}
+
+void CpuInfoTest::benchmarkLookups_data()
+{
+    QTest::addColumn<int>("processors");
+
+    QTest::newRow("64 cpus") << 64;
+    QTest::newRow("512 cpus") << 512;
+}
+
+void CpuInfoTest::benchmarkLookups()
+{
+    QFETCH(int, processors);
+
+    const QByteArray contents = syntheticCpuInfo(processors);
+
+    // What listing the processors costs: one parse, then vendor, model and speed of each
+    QBENCHMARK {
+        const CpuInfo info(contents);
+        for (int i = 0; i < processors; ++i) {
+            const CpuInfo::Processor processor = info.processor(i);
+            QCOMPARE(processor.speed, 1000 + i);
+            QVERIFY(!processor.vendor.isEmpty() && !processor.model.isEmpty());
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(CpuInfoTest)
+
+#include "cpuinfotest.moc"
@@ -0,0 +1,447 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "cputopology.h"
+#include "qtest_sysfs.h"
+
+using Solid::Backends::UDev::CpuTopology;
+
+class CpuTopologyTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testParseCpuList_data();
+    void testParseCpuList();
+    void testSysfsTree();
+    void testMissingAttributes();
+    void testCaches();
+    void testCpuIdCaches();
+    void testCpuIdCachesPerProcessor();
+    void testHybridTypes();
+    void testCapacities_data();
+    void testCapacities();
+    void testAppliedCoreClasses();
+    void benchmarkSysfsTree_data();
+    void benchmarkSysfsTree();
+};
+
+static QByteArray cpuRange(int first, int last)
+{
+    return first == last ? QByteArray::number(first)
+                         : QByteArray::number(first) + '-' + QByteArray::number(last);
+}
+
+/*
+ * Lays out a sysfs tree below @p root the way x86 kernels do: every core
+ * has two hardware threads, numbered N and N + processors / 2, and every
+ * package is one NUMA node with its own L3.
+ */
+static bool writeSysfsTree(const QString &root, int processors, int packages)
+{
+    const int cores = processors / 2;
+    const int coresPerPackage = cores / packages;
+    const QString cpuPath = root + QLatin1String("/devices/system/cpu/");
+
+    if (!QDir().mkpath(cpuPath + QLatin1String("cpufreq"))
+            || !writeAttribute(cpuPath + QLatin1String("online"), cpuRange(0, processors - 1))) {
+        return false;
+    }
+
+    for (int cpu = 0; cpu < processors; ++cpu) {
+        const int core = cpu % cores;
+        const QString topology = cpuPath + QStringLiteral("cpu%1/topology/").arg(cpu);
+        if (!QDir().mkpath(topology)
+                || !writeAttribute(topology + QLatin1String("physical_package_id"), QByteArray::number(core / coresPerPackage))
+                || !writeAttribute(topology + QLatin1String("die_id"), "0")
+                || !writeAttribute(topology + QLatin1String("core_id"), QByteArray::number(core % coresPerPackage))
+                || !writeAttribute(topology + QLatin1String("thread_siblings_list"),
+                                   QByteArray::number(core) + ',' + QByteArray::number(core + cores))) {
+            return false;
+        }
+
+        const int package = core / coresPerPackage;
+        const int packageFirst = package * coresPerPackage;
+        const int packageLast = packageFirst + coresPerPackage - 1;
+        const QByteArray coreCpus = QByteArray::number(core) + ',' + QByteArray::number(core + cores);
+        const QByteArray packageCpus = cpuRange(packageFirst, packageLast) + ','
+                                       + cpuRange(packageFirst + cores, packageLast + cores);
+        const struct {
+            const char *level;
+            const char *type;
+            const char *size;
+            const char *ways;
+            QByteArray shared;
+        } caches[] = {
+            { "1", "Data", "48K", "12", coreCpus },
+            { "1", "Instruction", "32K", "8", coreCpus },
+            { "2", "Unified", "2048K", "16", coreCpus },
+            { "3", "Unified", "107520K", "15", packageCpus }
+        };
+        for (int index = 0; index < 4; ++index) {
+            const QString cache = cpuPath + QStringLiteral("cpu%1/cache/index%2/").arg(cpu).arg(index);
+            if (!QDir().mkpath(cache)
+                    || !writeAttribute(cache + QLatin1String("level"), caches[index].level)
+                    || !writeAttribute(cache + QLatin1String("type"), caches[index].type)
+                    || !writeAttribute(cache + QLatin1String("size"), caches[index].size)
+                    || !writeAttribute(cache + QLatin1String("coherency_line_size"), "64")
+                    || !writeAttribute(cache + QLatin1String("ways_of_associativity"), caches[index].ways)
+                    || !writeAttribute(cache + QLatin1String("shared_cpu_list"), caches[index].shared)) {
+                return false;
+            }
+        }
+    }
+
+    for (int package = 0; package < packages; ++package) {
+        const QString node = root + QStringLiteral("/devices/system/node/node%1/").arg(package);
+        const int first = package * coresPerPackage;
+        const int last = first + coresPerPackage - 1;
+        if (!QDir().mkpath(node)
+                || !writeAttribute(node + QLatin1String("cpulist"),
+                                   cpuRange(first, last) + ',' + cpuRange(first + cores, last + cores))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CpuTopologyTest::testParseCpuList_data()
+{
+    QTest::addColumn<QByteArray>("list");
+    QTest::addColumn<QList<int> >("expected");
+
+    QTest::newRow("empty") << QByteArray() << QList<int>();
+    QTest::newRow("single") << QByteArray("5\n") << (QList<int>() << 5);
+    QTest::newRow("pair") << QByteArray("0,64") << (QList<int>() << 0 << 64);
+    QTest::newRow("ranges") << QByteArray("0-2,8,10-11") << (QList<int>() << 0 << 1 << 2 << 8 << 10 << 11);
+    QTest::newRow("unsorted") << QByteArray("4-5,0-1") << (QList<int>() << 0 << 1 << 4 << 5);
+    QTest::newRow("garbage") << QByteArray("x,3-1,2") << (QList<int>() << 2);
+}
+
+void CpuTopologyTest::testParseCpuList()
+{
+    QFETCH(QByteArray, list);
+    QFETCH(QList<int>, expected);
+
+    QCOMPARE(CpuTopology::parseCpuList(list), expected);
+}
+
+void CpuTopologyTest::testSysfsTree()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(writeSysfsTree(root.path(), 16, 2));
+
+    const CpuTopology topology(root.path());
+
+    QCOMPARE(topology.count(), 16);
+    QCOMPARE(topology.processors().first(), 0);
+    QCOMPARE(topology.processors().last(), 15);
+    QVERIFY(!topology.contains(16));
+
+    // cpu5 and cpu13 are the two threads of core 1 in package 1
+    const CpuTopology::Processor cpu5 = topology.processor(5);
+    QCOMPARE(cpu5.packageId, 1);
+    QCOMPARE(cpu5.dieId, 0);
+    QCOMPARE(cpu5.coreId, 1);
+    QCOMPARE(cpu5.numaNode, 1);
+    QCOMPARE(cpu5.siblings, QList<int>() << 5 << 13);
+
+    const CpuTopology::Processor cpu13 = topology.processor(13);
+    QCOMPARE(cpu13.packageId, cpu5.packageId);
+    QCOMPARE(cpu13.coreId, cpu5.coreId);
+    QCOMPARE(cpu13.numaNode, cpu5.numaNode);
+    QCOMPARE(cpu13.siblings, cpu5.siblings);
+
+    QCOMPARE(topology.processor(0).numaNode, 0);
+    QCOMPARE(topology.processor(8).packageId, 0);
+}
+
+void CpuTopologyTest::testMissingAttributes()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(writeSysfsTree(root.path(), 4, 1));
+
+    // Kernels before 5.2 have no die_id, machines without NUMA no node directory
+    const QString cpu1 = root.path() + QLatin1String("/devices/system/cpu/cpu1/topology/");
+    QVERIFY(QFile::remove(cpu1 + QLatin1String("die_id")));
+    QVERIFY(QDir(root.path() + QLatin1String("/devices/system/node")).removeRecursively());
+
+    const CpuTopology topology(root.path());
+    QCOMPARE(topology.count(), 4);
+    QCOMPARE(topology.processor(1).dieId, -1);
+    QCOMPARE(topology.processor(1).coreId, 1);
+    QCOMPARE(topology.processor(0).dieId, 0);
+    QCOMPARE(topology.processor(0).numaNode, -1);
+
+    // Unknown CPUs read as unknown rather than as CPU 0 of package 0
+    QCOMPARE(topology.processor(7).packageId, -1);
+    QVERIFY(topology.processor(7).siblings.isEmpty());
+
+    QCOMPARE(CpuTopology(root.path() + QLatin1String("/nonexistent")).count(), 0);
+}
+
+void CpuTopologyTest::testCaches()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(writeSysfsTree(root.path(), 16, 2));
+
+    const CpuTopology topology(root.path());
+
+    // Three caches per core, one L3 per package
+    QCOMPARE(topology.cacheInstances(), 8 * 3 + 2);
+
+    const QList<Solid::Processor::Cache> caches = topology.caches(5);
+    QCOMPARE(caches.size(), 4);
+
+    QCOMPARE(caches.at(0).level, 1);
+    QCOMPARE(caches.at(0).type, Solid::Processor::DataCache);
+    QCOMPARE(caches.at(0).size, Q_UINT64_C(48) * 1024);
+    QCOMPARE(caches.at(0).lineSize, 64);
+    QCOMPARE(caches.at(0).associativity, 12);
+    QCOMPARE(caches.at(0).sharedWith, QList<int>() << 5 << 13);
+    QCOMPARE(caches.at(1).type, Solid::Processor::InstructionCache);
+    QCOMPARE(caches.at(2).level, 2);
+    QCOMPARE(caches.at(2).type, Solid::Processor::UnifiedCache);
+
+    const Solid::Processor::Cache l3 = caches.at(3);
+    QCOMPARE(l3.level, 3);
+    QCOMPARE(l3.size, Q_UINT64_C(105) * 1024 * 1024);
+    QCOMPARE(l3.associativity, 15);
+    QCOMPARE(l3.sharedWith, QList<int>() << 4 << 5 << 6 << 7 << 12 << 13 << 14 << 15);
+
+    // Every processor of the package sees the same L3, none of the other
+    QCOMPARE(topology.caches(14).at(3).sharedWith, l3.sharedWith);
+    QVERIFY(!topology.caches(0).at(3).sharedWith.contains(5));
+
+    QVERIFY(topology.caches(16).isEmpty());
+}
+
+void CpuTopologyTest::testCpuIdCaches()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(writeSysfsTree(root.path(), 8, 1));
+
+    // Drop the cache directories, as some containers do
+    for (int cpu = 0; cpu < 8; ++cpu) {
+        QVERIFY(QDir(root.path() + QStringLiteral("/devices/system/cpu/cpu%1/cache").arg(cpu)).removeRecursively());
+    }
+    CpuTopology topology(root.path());
+    QCOMPARE(topology.cacheInstances(), 0);
+
+    QList<Solid::Backends::Shared::CpuIdCache> cpuIdCaches;
+    Solid::Backends::Shared::CpuIdCache l1;
+    l1.level = 1;
+    l1.type = Solid::Processor::DataCache;
+    l1.size = 32 * 1024;
+    l1.lineSize = 64;
+    l1.associativity = 8;
+    l1.threadsSharing = 2;
+    cpuIdCaches << l1;
+    Solid::Backends::Shared::CpuIdCache l3 = l1;
+    l3.level = 3;
+    l3.type = Solid::Processor::UnifiedCache;
+    l3.size = 16 * 1024 * 1024;
+    l3.threadsSharing = 16;
+    cpuIdCaches << l3;
+
+    topology.applyCpuIdCaches(cpuIdCaches);
+
+    const QList<Solid::Processor::Cache> caches = topology.caches(1);
+    QCOMPARE(caches.size(), 2);
+    QCOMPARE(caches.at(0).size, Q_UINT64_C(32) * 1024);
+    // The L1 count matches the SMT siblings, the L3 count matches nothing known
+    QCOMPARE(caches.at(0).sharedWith, QList<int>() << 1 << 5);
+    QVERIFY(caches.at(1).sharedWith.isEmpty());
+
+    // One L1 per core, and the L3 of each processor on its own
+    QCOMPARE(topology.cacheInstances(), 4 + 8);
+}
+
+void CpuTopologyTest::testCpuIdCachesPerProcessor()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(writeSysfsTree(root.path(), 8, 1));
+
+    for (int cpu = 0; cpu < 8; ++cpu) {
+        QVERIFY(QDir(root.path() + QStringLiteral("/devices/system/cpu/cpu%1/cache").arg(cpu)).removeRecursively());
+    }
+    CpuTopology topology(root.path());
+
+    // A hybrid reports a bigger L2 on the cores of one class
+    Solid::Backends::Shared::CpuIdCache big;
+    big.level = 2;
+    big.type = Solid::Processor::UnifiedCache;
+    big.size = 2 * 1024 * 1024;
+    big.lineSize = 64;
+    big.associativity = 16;
+    big.threadsSharing = 2;
+    Solid::Backends::Shared::CpuIdCache little = big;
+    little.size = 1024 * 1024;
+    little.threadsSharing = 1;
+
+    QHash<int, QList<Solid::Backends::Shared::CpuIdCache> > cpuIdCaches;
+    for (int cpu = 0; cpu < 7; ++cpu) {
+        cpuIdCaches.insert(cpu, QList<Solid::Backends::Shared::CpuIdCache>() << (cpu % 4 < 2 ? big : little));
+    }
+    topology.applyCpuIdCaches(cpuIdCaches);
+
+    QCOMPARE(topology.caches(1).size(), 1);
+    QCOMPARE(topology.caches(1).at(0).size, Q_UINT64_C(2) * 1024 * 1024);
+    QCOMPARE(topology.caches(1).at(0).sharedWith, QList<int>() << 1 << 5);
+    QCOMPARE(topology.caches(2).size(), 1);
+    QCOMPARE(topology.caches(2).at(0).size, Q_UINT64_C(1024) * 1024);
+    QCOMPARE(topology.caches(2).at(0).sharedWith, QList<int>() << 2);
+
+    // CPU 7 was left out
+    QVERIFY(topology.caches(7).isEmpty());
+
+    // One big L2 per core of CPUs 0, 1, 4 and 5, one little L2 for each of 2, 3 and 6
+    QCOMPARE(topology.cacheInstances(), 2 + 3);
+}
+
+void CpuTopologyTest::testHybridTypes()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(writeSysfsTree(root.path(), 8, 1));
+
+    // Cores of an Alder Lake style part: threads 0-3 are P-cores, 4-7 E-cores
+    const QString cpuPath = root.path() + QLatin1String("/devices/system/cpu/");
+    QVERIFY(QDir().mkpath(cpuPath + QLatin1String("types/intel_core_0")));
+    QVERIFY(QDir().mkpath(cpuPath + QLatin1String("types/intel_atom_0")));
+    QVERIFY(writeAttribute(cpuPath + QLatin1String("types/intel_core_0/cpulist"), "0-3"));
+    QVERIFY(writeAttribute(cpuPath + QLatin1String("types/intel_atom_0/cpulist"), "4-7"));
+    for (int cpu = 0; cpu < 8; ++cpu) {
+        const QString cpufreq = cpuPath + QStringLiteral("cpu%1/cpufreq/").arg(cpu);
+        QVERIFY(QDir().mkpath(cpufreq));
+        QVERIFY(writeAttribute(cpufreq + QLatin1String("cpuinfo_max_freq"), cpu < 4 ? "5000000" : "3800000"));
+    }
+
+    const CpuTopology topology(root.path());
+    QVERIFY(topology.hasCoreClasses());
+    QCOMPARE(topology.processor(3).coreClass, Solid::Processor::PerformanceCore);
+    QCOMPARE(topology.processor(4).coreClass, Solid::Processor::EfficiencyCore);
+
+    // No cpu_capacity, so capacities follow the maximum frequencies
+    QCOMPARE(topology.processor(0).capacity, 1024);
+    QCOMPARE(topology.processor(7).capacity, 3800 * 1024 / 5000);
+}
+
+void CpuTopologyTest::testCapacities_data()
+{
+    QTest::addColumn<QByteArray>("littleCapacity");
+    QTest::addColumn<int>("littleClass");
+    QTest::addColumn<QByteArray>("midCapacity");
+
+    QTest::newRow("big.LITTLE") << QByteArray("446") << int(Solid::Processor::EfficiencyCore) << QByteArray("1024");
+    QTest::newRow("symmetric") << QByteArray("1024") << int(Solid::Processor::PerformanceCore) << QByteArray("1024");
+    // Phones pair a prime core with mid cores; only the little ones save power
+    QTest::newRow("three tiers") << QByteArray("325") << int(Solid::Processor::EfficiencyCore) << QByteArray("870");
+}
+
+void CpuTopologyTest::testCapacities()
+{
+    QFETCH(QByteArray, littleCapacity);
+    QFETCH(int, littleClass);
+    QFETCH(QByteArray, midCapacity);
+
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(writeSysfsTree(root.path(), 8, 1));
+
+    // Like on the RK3399 and most phones, the little cores come first
+    const QString cpuPath = root.path() + QLatin1String("/devices/system/cpu/");
+    for (int cpu = 0; cpu < 8; ++cpu) {
+        QVERIFY(writeAttribute(cpuPath + QStringLiteral("cpu%1/cpu_capacity").arg(cpu),
+                               cpu < 4 ? littleCapacity : cpu < 6 ? midCapacity : QByteArray("1024")));
+    }
+
+    const CpuTopology topology(root.path());
+    QCOMPARE(int(topology.processor(0).coreClass), littleClass);
+    QCOMPARE(topology.processor(0).capacity, littleCapacity.toInt());
+    QCOMPARE(topology.processor(5).coreClass, Solid::Processor::PerformanceCore);
+    QCOMPARE(topology.processor(5).capacity, midCapacity.toInt());
+    QCOMPARE(topology.processor(7).coreClass, Solid::Processor::PerformanceCore);
+    QCOMPARE(topology.processor(7).capacity, 1024);
+}
+
+void CpuTopologyTest::testAppliedCoreClasses()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(writeSysfsTree(root.path(), 4, 1));
+
+    CpuTopology topology(root.path());
+    QVERIFY(!topology.hasCoreClasses());
+    QCOMPARE(topology.processor(0).coreClass, Solid::Processor::UnknownCore);
+    QCOMPARE(topology.processor(0).capacity, -1);
+
+    QHash<int, Solid::Processor::CoreClass> classes;
+    classes.insert(0, Solid::Processor::PerformanceCore);
+    classes.insert(1, Solid::Processor::EfficiencyCore);
+    classes.insert(9, Solid::Processor::EfficiencyCore);
+    topology.applyCoreClasses(classes);
+
+    QVERIFY(topology.hasCoreClasses());
+    QCOMPARE(topology.processor(0).coreClass, Solid::Processor::PerformanceCore);
+    QCOMPARE(topology.processor(1).coreClass, Solid::Processor::EfficiencyCore);
+    QCOMPARE(topology.processor(2).coreClass, Solid::Processor::UnknownCore);
+    QVERIFY(!topology.contains(9));
+}
+
+void CpuTopologyTest::benchmarkSysfsTree_data()
+{
+    QTest::addColumn<int>("processors");
+    QTest::addColumn<int>("packages");
+
+    QTest::newRow("64 cpus") << 64 << 2;
+    QTest::newRow("1024 cpus") << 1024 << 8;
+}
+
+void CpuTopologyTest::benchmarkSysfsTree()
+{
+    QFETCH(int, processors);
+    QFETCH(int, packages);
+
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(writeSysfsTree(root.path(), processors, packages));
+
+    QBENCHMARK {
+        const CpuTopology topology(root.path());
+        QCOMPARE(topology.count(), processors);
+        QCOMPARE(topology.processor(processors - 1).numaNode, packages - 1);
+        QCOMPARE(topology.cacheInstances(), processors / 2 * 3 + packages);
+    }
+}
+
+QTEST_GUILESS_MAIN(CpuTopologyTest)
+
+#include "cputopologytest.moc"
@@ -0,0 +1,221 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "fakeUdisks2.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusVariant>
+#include <QMutexLocker>
+
+FakeUdisks2::FakeUdisks2(const QString &connectionName, QObject *parent)
+    : QDBusVirtualObject(parent)
+    , m_connectionName(connectionName)
+{
+    qDBusRegisterMetaType<QByteArrayList>();
+    qDBusRegisterMetaType<QVariantMap>();
+    qDBusRegisterMetaType<VariantMapMap>();
+    qDBusRegisterMetaType<DBUSManagerStruct>();
+}
+
+void FakeUdisks2::setBlockDevices(int count)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_objects.clear();
+    for (int i = 0; i < count; ++i) {
+        const QString name = QStringLiteral("loop%1").arg(i);
+        const QByteArray device = "/dev/" + name.toLatin1();
+
+        QVariantMap block;
+        block.insert(QStringLiteral("Device"), device + '\0');
+        block.insert(QStringLiteral("PreferredDevice"), device + '\0');
+        block.insert(QStringLiteral("DeviceNumber"), qulonglong(7 * 256 + i));
+        block.insert(QStringLiteral("Size"), qulonglong(1024 * 1024 * 1024));
+        block.insert(QStringLiteral("ReadOnly"), false);
+        block.insert(QStringLiteral("Drive"), QVariant::fromValue(QDBusObjectPath("/")));
+        block.insert(QStringLiteral("CryptoBackingDevice"), QVariant::fromValue(QDBusObjectPath("/")));
+        block.insert(QStringLiteral("IdUsage"), QStringLiteral("filesystem"));
+        block.insert(QStringLiteral("IdType"), QStringLiteral("ext4"));
+        block.insert(QStringLiteral("IdUUID"), QStringLiteral("00000000-0000-0000-0000-%1").arg(i, 12, 10, QLatin1Char('0')));
+        block.insert(QStringLiteral("IdLabel"), name);
+        block.insert(QStringLiteral("HintIgnore"), false);
+        block.insert(QStringLiteral("HintSystem"), false);
+
+        QVariantMap filesystem;
+        filesystem.insert(QStringLiteral("MountPoints"), QVariant::fromValue(QByteArrayList()));
+
+        VariantMapMap interfaces;
+        interfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_BLOCK), block);
+        interfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_FILESYSTEM), filesystem);
+
+        m_objects.insert(QDBusObjectPath(QStringLiteral(UD2_DBUS_PATH_BLOCKDEVICES) + name), interfaces);
+    }
+}
+
+void FakeUdisks2::changeProperty(const QString &path, const QString &iface, const QString &key, const QVariant &value)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_objects[QDBusObjectPath(path)][iface].insert(key, value);
+    }
+
+    QDBusMessage signal = QDBusMessage::createSignal(path, QStringLiteral(DBUS_INTERFACE_PROPS), QStringLiteral("PropertiesChanged"));
+
+    QVariantMap changed;
+    changed.insert(key, value);
+    signal << iface << changed << QStringList();
+
+    QDBusConnection(m_connectionName).send(signal);
+}
+
+void FakeUdisks2::addObject(const QString &path, const VariantMapMap &interfaces)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_objects.insert(QDBusObjectPath(path), interfaces);
+    }
+
+    QDBusMessage signal = QDBusMessage::createSignal(QStringLiteral(UD2_DBUS_PATH), QStringLiteral(DBUS_INTERFACE_MANAGER), QStringLiteral("InterfacesAdded"));
+    signal << QVariant::fromValue(QDBusObjectPath(path)) << QVariant::fromValue(interfaces);
+
+    QDBusConnection(m_connectionName).send(signal);
+}
+
+void FakeUdisks2::removeObject(const QString &path)
+{
+    QStringList interfaces;
+    {
+        QMutexLocker locker(&m_lock);
+        interfaces = m_objects.take(QDBusObjectPath(path)).keys();
+    }
+
+    QDBusMessage signal = QDBusMessage::createSignal(QStringLiteral(UD2_DBUS_PATH), QStringLiteral(DBUS_INTERFACE_MANAGER), QStringLiteral("InterfacesRemoved"));
+    signal << QVariant::fromValue(QDBusObjectPath(path)) << interfaces;
+
+    QDBusConnection(m_connectionName).send(signal);
+}
+
+void FakeUdisks2::removeInterface(const QString &path, const QString &iface)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_objects[QDBusObjectPath(path)].remove(iface);
+    }
+
+    QDBusMessage signal = QDBusMessage::createSignal(QStringLiteral(UD2_DBUS_PATH), QStringLiteral(DBUS_INTERFACE_MANAGER), QStringLiteral("InterfacesRemoved"));
+    signal << QVariant::fromValue(QDBusObjectPath(path)) << (QStringList() << iface);
+
+    QDBusConnection(m_connectionName).send(signal);
+}
+
+int FakeUdisks2::callCount() const
+{
+    QMutexLocker locker(&m_lock);
+
+    int count = 0;
+    Q_FOREACH (int calls, m_calls) {
+        count += calls;
+    }
+    return count;
+}
+
+int FakeUdisks2::callCount(const QString &member) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_calls.value(member);
+}
+
+void FakeUdisks2::resetCallCount()
+{
+    QMutexLocker locker(&m_lock);
+    m_calls.clear();
+}
+
+QString FakeUdisks2::introspect(const QString &path) const
+{
+    const VariantMapMap interfaces = m_objects.value(QDBusObjectPath(path));
+
+    QString xml;
+    for (VariantMapMap::const_iterator it = interfaces.constBegin(); it != interfaces.constEnd(); ++it) {
+        xml += QStringLiteral("<interface name=\"%1\"/>").arg(it.key());
+    }
+    return xml;
+}
+
+QString FakeUdisks2::introspectNode(const QString &path) const
+{
+    QString xml = QStringLiteral("<node>");
+
+    if (path == QLatin1String(UD2_DBUS_PATH)) {
+        xml += QStringLiteral("<interface name=\"" DBUS_INTERFACE_MANAGER "\"/>");
+        xml += QStringLiteral("<node name=\"block_devices\"/>");
+    } else if (path + QLatin1Char('/') == QLatin1String(UD2_DBUS_PATH_BLOCKDEVICES)) {
+        Q_FOREACH (const QDBusObjectPath &object, m_objects.keys()) {
+            xml += QStringLiteral("<node name=\"%1\"/>").arg(object.path().section(QLatin1Char('/'), -1));
+        }
+    } else {
+        xml += introspect(path);
+    }
+
+    xml += QStringLiteral("</node>");
+    return xml;
+}
+
+bool FakeUdisks2::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    if (message.type() != QDBusMessage::MethodCallMessage) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_calls[message.member()]++;
+
+    const QString path = message.path();
+    const QString member = message.member();
+    QDBusMessage reply;
+
+    if (message.interface() == QLatin1String(DBUS_INTERFACE_MANAGER) && member == QLatin1String("GetManagedObjects")) {
+        reply = message.createReply(QVariant::fromValue(m_objects));
+    } else if (message.interface() == QLatin1String(DBUS_INTERFACE_INTROSPECT) && member == QLatin1String("Introspect")) {
+        reply = message.createReply(introspectNode(path));
+    } else if (message.interface() == QLatin1String(DBUS_INTERFACE_PROPS) && member == QLatin1String("GetAll")) {
+        const QString iface = message.arguments().value(0).toString();
+        reply = message.createReply(QVariant::fromValue(m_objects.value(QDBusObjectPath(path)).value(iface)));
+    } else if (message.interface() == QLatin1String(DBUS_INTERFACE_PROPS) && member == QLatin1String("Get")) {
+        const QString key = message.arguments().value(1).toString();
+        const VariantMapMap interfaces = m_objects.value(QDBusObjectPath(path));
+        for (VariantMapMap::const_iterator it = interfaces.constBegin(); it != interfaces.constEnd(); ++it) {
+            if (it.value().contains(key)) {
+                reply = message.createReply(QVariant::fromValue(QDBusVariant(it.value().value(key))));
+                break;
+            }
+        }
+        if (reply.type() == QDBusMessage::InvalidMessage) {
+            reply = message.createErrorReply(QDBusError::InvalidArgs, QStringLiteral("No such property ") + key);
+        }
+    } else {
+        reply = message.createErrorReply(QDBusError::UnknownMethod, member);
+    }
+
+    connection.send(reply);
+    return true;
+}
@@ -0,0 +1,67 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOLID_FAKE_UDISKS2_H
+#define SOLID_FAKE_UDISKS2_H
+
+#include <QDBusVirtualObject>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+#include "udisks2.h"
+
+/**
+ * Fake org.freedesktop.UDisks2 service exposing block devices through the
+ * ObjectManager, Introspectable and Properties interfaces.
+ *
+ * Every method call it answers is counted so that tests can check how
+ * many round-trips a client needs. Signals are emitted on the connection
+ * called connectionName.
+ */
+class FakeUdisks2 : public QDBusVirtualObject
+{
+    Q_OBJECT
+public:
+    explicit FakeUdisks2(const QString &connectionName, QObject *parent = nullptr);
+
+    void setBlockDevices(int count);
+    void changeProperty(const QString &path, const QString &iface, const QString &key, const QVariant &value);
+    void addObject(const QString &path, const VariantMapMap &interfaces);
+    void removeObject(const QString &path);
+    void removeInterface(const QString &path, const QString &iface);
+
+    int callCount() const;
+    int callCount(const QString &member) const;
+    void resetCallCount();
+
+    QString introspect(const QString &path) const Q_DECL_OVERRIDE;
+    bool handleMessage(const QDBusMessage &message, const QDBusConnection &connection) Q_DECL_OVERRIDE;
+
+private:
+    QString introspectNode(const QString &path) const;
+
+    QString m_connectionName;
+    mutable QMutex m_lock;
+    DBUSManagerStruct m_objects;
+    QMap<QString, int> m_calls;
+};
+
+#endif //SOLID_FAKE_UDISKS2_H
@@ -24,9 +24,11 @@
 #include <QDBusPendingCall>
 #include <QDBusConnection>
 #include <qdbusmessage.h>
+#include <QMutexLocker>
 
 FakeUpower::FakeUpower(QObject* parent) : QObject(parent),
-m_onBattery(false)
+m_onBattery(false),
+m_enumerateCalls(0)
 {
 
 }
@@ -94,6 +96,31 @@ void FakeUpower::emitPropertiesChanged(const QString& name, const QVariant& valu
 
 QList< QDBusObjectPath > FakeUpower::EnumerateDevices()
 {
-    QList<QDBusObjectPath> list;
-    return list;
+    QMutexLocker locker(&m_lock);
+    m_enumerateCalls++;
+    return m_devices;
+}
+
+void FakeUpower::addDevice(const QString &path)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_devices << QDBusObjectPath(path);
+    }
+    emit DeviceAdded(QDBusObjectPath(path));
+}
+
+void FakeUpower::removeDevice(const QString &path)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_devices.removeAll(QDBusObjectPath(path));
+    }
+    emit DeviceRemoved(QDBusObjectPath(path));
+}
+
+int FakeUpower::enumerateCalls() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_enumerateCalls;
 }
@@ -22,6 +22,7 @@
 #define SOLID_FAKE_UPOWER_H
 
 #include <QList>
+#include <QMutex>
 #include <QString>
 #include <QDBusAbstractAdaptor>
 #include <QDBusObjectPath>
@@ -45,10 +46,24 @@ public:
     bool m_onBattery;
 
     void emitPropertiesChanged(const QString &name, const QVariant &value);
+
+    void addDevice(const QString &path);
+    void removeDevice(const QString &path);
+    int enumerateCalls() const;
+
 public Q_SLOTS:
     QList<QDBusObjectPath> EnumerateDevices();
     QString GetCriticalAction();
     QDBusObjectPath GetDisplayDevice();
+
+Q_SIGNALS:
+    void DeviceAdded(const QDBusObjectPath &path);
+    void DeviceRemoved(const QDBusObjectPath &path);
+
+private:
+    mutable QMutex m_lock;
+    QList<QDBusObjectPath> m_devices;
+    int m_enumerateCalls;
 };
 
 #endif //SOLID_FAKE_UPOWER_H
\ No newline at end of file
@@ -0,0 +1,164 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "fakeUpowerDevice.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusVariant>
+#include <QMutexLocker>
+
+#define FAKE_UPOWER_DEVICES_PATH "/org/freedesktop/UPower/devices"
+#define FAKE_UPOWER_DEVICE_INTERFACE "org.freedesktop.UPower.Device"
+
+FakeUpowerDevice::FakeUpowerDevice(const QString &connectionName, QObject *parent)
+    : QDBusVirtualObject(parent)
+    , m_connectionName(connectionName)
+{
+    qDBusRegisterMetaType<QVariantMap>();
+}
+
+QString FakeUpowerDevice::addDevice(const QString &name, const QVariantMap &properties)
+{
+    QMutexLocker locker(&m_lock);
+
+    const QString path = QStringLiteral(FAKE_UPOWER_DEVICES_PATH "/") + name;
+    m_devices.insert(path, properties);
+    return path;
+}
+
+void FakeUpowerDevice::removeDevice(const QString &path)
+{
+    QMutexLocker locker(&m_lock);
+    m_devices.remove(path);
+}
+
+QStringList FakeUpowerDevice::devices() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_devices.keys();
+}
+
+void FakeUpowerDevice::changeProperty(const QString &path, const QString &key, const QVariant &value)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_devices[path].insert(key, value);
+    }
+
+    QVariantMap changed;
+    changed.insert(key, value);
+    emitPropertiesChanged(path, changed, QStringList());
+}
+
+void FakeUpowerDevice::invalidateProperty(const QString &path, const QString &key, const QVariant &value)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_devices[path].insert(key, value);
+    }
+
+    emitPropertiesChanged(path, QVariantMap(), QStringList() << key);
+}
+
+void FakeUpowerDevice::emitPropertiesChanged(const QString &path, const QVariantMap &changed, const QStringList &invalidated)
+{
+    QDBusMessage signal = QDBusMessage::createSignal(path, QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("PropertiesChanged"));
+    signal << QStringLiteral(FAKE_UPOWER_DEVICE_INTERFACE) << changed << invalidated;
+
+    QDBusConnection(m_connectionName).send(signal);
+}
+
+int FakeUpowerDevice::callCount() const
+{
+    QMutexLocker locker(&m_lock);
+
+    int count = 0;
+    Q_FOREACH (int calls, m_calls) {
+        count += calls;
+    }
+    return count;
+}
+
+int FakeUpowerDevice::callCount(const QString &member) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_calls.value(member);
+}
+
+void FakeUpowerDevice::resetCallCount()
+{
+    QMutexLocker locker(&m_lock);
+    m_calls.clear();
+}
+
+QString FakeUpowerDevice::introspect(const QString &path) const
+{
+    if (!m_devices.contains(path)) {
+        return QString();
+    }
+
+    QString xml = QStringLiteral("<interface name=\"" FAKE_UPOWER_DEVICE_INTERFACE "\">");
+    const QVariantMap properties = m_devices.value(path);
+    for (QVariantMap::const_iterator it = properties.constBegin(); it != properties.constEnd(); ++it) {
+        xml += QStringLiteral("<property name=\"%1\" type=\"%2\" access=\"read\"/>")
+               .arg(it.key(), QString::fromLatin1(QDBusMetaType::typeToSignature(it.value().userType())));
+    }
+    xml += QStringLiteral("<method name=\"Refresh\"/>");
+    xml += QStringLiteral("</interface>");
+    return xml;
+}
+
+bool FakeUpowerDevice::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    if (message.type() != QDBusMessage::MethodCallMessage) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_calls[message.member()]++;
+
+    const QString path = message.path();
+    const QString member = message.member();
+    QDBusMessage reply;
+
+    if (message.interface() == QLatin1String("org.freedesktop.DBus.Introspectable") && member == QLatin1String("Introspect")) {
+        reply = message.createReply(QStringLiteral("<node>") + introspect(path) + QStringLiteral("</node>"));
+    } else if (!m_devices.contains(path)) {
+        reply = message.createErrorReply(QDBusError::UnknownObject, path);
+    } else if (message.interface() == QLatin1String("org.freedesktop.DBus.Properties") && member == QLatin1String("GetAll")) {
+        reply = message.createReply(QVariant::fromValue(m_devices.value(path)));
+    } else if (message.interface() == QLatin1String("org.freedesktop.DBus.Properties") && member == QLatin1String("Get")) {
+        const QString key = message.arguments().value(1).toString();
+        if (m_devices.value(path).contains(key)) {
+            reply = message.createReply(QVariant::fromValue(QDBusVariant(m_devices.value(path).value(key))));
+        } else {
+            reply = message.createErrorReply(QDBusError::InvalidArgs, QStringLiteral("No such property ") + key);
+        }
+    } else if (member == QLatin1String("Refresh")) {
+        reply = message.createReply();
+    } else {
+        reply = message.createErrorReply(QDBusError::UnknownMethod, member);
+    }
+
+    connection.send(reply);
+    return true;
+}
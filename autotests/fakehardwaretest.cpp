@@ -22,6 +22,8 @@
 // Qt includes
 #include <QtTest/QtTest>
 #include <QtCore/QStringList>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QTextStream>
 
 // Solid includes
 #include <solid/devices/ifaces/device.h>
@@ -68,10 +70,127 @@ void FakeHardwareTest::testFakeBackend()
     instructionsets |= Solid::Processor::IntelSse;
     QCOMPARE(processor->instructionSets(), instructionsets);
 
+    QCOMPARE(processor->packageId(), 0);
+    QCOMPARE(processor->dieId(), 0);
+    QCOMPARE(processor->coreId(), 0);
+    QCOMPARE(processor->numaNode(), 0);
+    QCOMPARE(processor->siblings(), QList<int>() << 0 << 1);
+
+    const QList<Solid::Processor::Cache> caches = processor->caches();
+    QCOMPARE(caches.size(), 4);
+    QCOMPARE(caches.at(0).level, 1);
+    QCOMPARE(caches.at(0).type, Solid::Processor::DataCache);
+    QCOMPARE(caches.at(1).type, Solid::Processor::InstructionCache);
+    QCOMPARE(caches.at(2).size, Q_UINT64_C(256) * 1024);
+    QCOMPARE(caches.at(3).level, 3);
+    QCOMPARE(caches.at(3).type, Solid::Processor::UnifiedCache);
+    QCOMPARE(caches.at(3).size, Q_UINT64_C(8) * 1024 * 1024);
+    QCOMPARE(caches.at(3).lineSize, 64);
+    QCOMPARE(caches.at(3).associativity, 16);
+    QCOMPARE(caches.at(3).sharedWith, QList<int>() << 0 << 1);
+
+    QCOMPARE(processor->coreClass(), Solid::Processor::PerformanceCore);
+    QCOMPARE(processor->capacity(), 1024);
+    QVERIFY(processor->isUsable());
+    QCOMPARE(processor->cpuQuota(), qreal(1.5));
+
     delete processor;
     delete device;
     delete computer;
     delete fakeManager;
 }
 
+void FakeHardwareTest::testDevicesFromQuery()
+{
+    Solid::Backends::Fake::FakeManager fakeManager(nullptr, TEST_DATA);
+
+    const QStringList cpus{"/org/kde/solid/fakehw/acpi_CPU0", "/org/kde/solid/fakehw/acpi_CPU1"};
+    QCOMPARE(fakeManager.devicesFromQuery(QString(), Solid::DeviceInterface::Processor), cpus);
+    QCOMPARE(fakeManager.devicesFromQuery("/org/kde/solid/fakehw/computer", Solid::DeviceInterface::Processor), cpus);
+    QVERIFY(fakeManager.devicesFromQuery("/org/kde/solid/fakehw/acpi_CPU0", Solid::DeviceInterface::Unknown).isEmpty());
+
+    const QString volume = "/org/kde/solid/fakehw/volume_part2_size_1024";
+    const QString drive = fakeManager.findDevice(volume)->parentUdi();
+    QVERIFY(fakeManager.devicesFromQuery(drive, Solid::DeviceInterface::StorageVolume).contains(volume));
+
+    // The index follows hotplug
+    fakeManager.unplug(volume);
+    QVERIFY(!fakeManager.devicesFromQuery(drive, Solid::DeviceInterface::StorageVolume).contains(volume));
+    QVERIFY(!fakeManager.devicesFromQuery(QString(), Solid::DeviceInterface::StorageVolume).contains(volume));
+    fakeManager.plug(volume);
+    QVERIFY(fakeManager.devicesFromQuery(drive, Solid::DeviceInterface::StorageVolume).contains(volume));
+    QVERIFY(fakeManager.devicesFromQuery(QString(), Solid::DeviceInterface::StorageVolume).contains(volume));
+}
+
+// What devicesFromQuery() used to do: walk every device and ask it
+static QStringList scanDevices(Solid::Backends::Fake::FakeManager *manager,
+                               const QString &parentUdi, Solid::DeviceInterface::Type type)
+{
+    QStringList result;
+    Q_FOREACH (const QString &udi, manager->allDevices()) {
+        Solid::Backends::Fake::FakeDevice *device = manager->findDevice(udi);
+        if (device->queryDeviceInterface(type) && (parentUdi.isEmpty() || device->parentUdi() == parentUdi)) {
+            result << udi;
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void FakeHardwareTest::benchmarkDevicesFromQuery_data()
+{
+    QTest::addColumn<bool>("indexed");
+    QTest::addColumn<QString>("parentUdi");
+
+    QTest::newRow("scan by type") << false << QString();
+    QTest::newRow("catalog by type") << true << QString();
+    QTest::newRow("scan by parent") << false << "/org/kde/solid/fakehw/hub_42";
+    QTest::newRow("catalog by parent") << true << "/org/kde/solid/fakehw/hub_42";
+}
+
+void FakeHardwareTest::benchmarkDevicesFromQuery()
+{
+    QFETCH(bool, indexed);
+    QFETCH(QString, parentUdi);
+
+    // 100 hubs with 99 children each: processors, drives and volumes
+    static QTemporaryFile machine;
+    static QScopedPointer<Solid::Backends::Fake::FakeManager> fakeManager;
+    if (!fakeManager) {
+        QVERIFY(machine.open());
+        QTextStream stream(&machine);
+        stream << "<machine>\n";
+        stream << "<device udi=\"/org/kde/solid/fakehw/computer\"><property key=\"name\">Computer</property></device>\n";
+        static const char *const interfaces[] = {"Processor", "Block,StorageDrive", "Block,StorageVolume,StorageAccess"};
+        for (int hub = 0; hub < 100; ++hub) {
+            const QString hubUdi = QStringLiteral("/org/kde/solid/fakehw/hub_%1").arg(hub);
+            stream << "<device udi=\"" << hubUdi << "\"><property key=\"name\">Hub</property>"
+                   << "<property key=\"parent\">/org/kde/solid/fakehw/computer</property></device>\n";
+            for (int child = 0; child < 99; ++child) {
+                stream << "<device udi=\"" << hubUdi << "_" << child << "\"><property key=\"name\">Device</property>"
+                       << "<property key=\"interfaces\">" << interfaces[child % 3] << "</property>"
+                       << "<property key=\"parent\">" << hubUdi << "</property></device>\n";
+            }
+        }
+        stream << "</machine>\n";
+        stream.flush();
+        machine.close();
+
+        fakeManager.reset(new Solid::Backends::Fake::FakeManager(nullptr, machine.fileName()));
+    }
+    QCOMPARE(fakeManager->allDevices().size(), 10001);
+
+    const QStringList expected = scanDevices(fakeManager.data(), parentUdi, Solid::DeviceInterface::StorageVolume);
+    QCOMPARE(fakeManager->devicesFromQuery(parentUdi, Solid::DeviceInterface::StorageVolume), expected);
+    QCOMPARE(expected.size(), parentUdi.isEmpty() ? 3300 : 33);
+
+    QBENCHMARK {
+        if (indexed) {
+            fakeManager->devicesFromQuery(parentUdi, Solid::DeviceInterface::StorageVolume);
+        } else {
+            scanDevices(fakeManager.data(), parentUdi, Solid::DeviceInterface::StorageVolume);
+        }
+    }
+}
+
 #include "moc_fakehardwaretest.cpp"
@@ -27,6 +27,9 @@ class FakeHardwareTest : public QObject
     Q_OBJECT
 private Q_SLOTS:
     void testFakeBackend();
+    void testDevicesFromQuery();
+    void benchmarkDevicesFromQuery_data();
+    void benchmarkDevicesFromQuery();
 };
 
 #endif
@@ -41,6 +41,7 @@ public Q_SLOTS:
 Q_SIGNALS:
     void inhibitionRemoved();
     void newInhibition(const QString &what, const QString &who, const QString &why, const QString &mode);
+    void PrepareForSleep(bool start);
 
 private:
     int m_fd;
@@ -0,0 +1,163 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include "fstabhandling.h"
+#include "fstabwatcher.h"
+
+using Solid::Backends::Fstab::FstabWatcher;
+using Solid::Backends::Fstab::MountInfo;
+
+class FstabHandlingTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testMountInfoUpdate();
+    void benchmarkMountInfoUpdate_data();
+    void benchmarkMountInfoUpdate();
+    void testMtabEventMerging();
+};
+
+static QByteArray mountLine(int id, const QByteArray &mountPoint, const QByteArray &type, const QByteArray &source)
+{
+    return QByteArray::number(id) + " 1 0:" + QByteArray::number(id) + " / " + mountPoint
+           + " rw,relatime shared:" + QByteArray::number(id) + " - " + type + ' ' + source + " rw\n";
+}
+
+static QSet<QString> devices(const char *first, const char *second = nullptr)
+{
+    QSet<QString> result;
+    result << QString::fromLatin1(first);
+    if (second) {
+        result << QString::fromLatin1(second);
+    }
+    return result;
+}
+
+void FstabHandlingTest::testMountInfoUpdate()
+{
+    const QByteArray base = mountLine(20, "/", "ext4", "/dev/sda1")
+                            + mountLine(21, "/proc", "proc", "proc")
+                            + mountLine(30, "/mnt/export", "nfs", "server:/export")
+                            + mountLine(31, "/mnt/my\\040music", "cifs", "//nas/music");
+
+    MountInfo info;
+    QCOMPARE(info.update(base), devices("server:/export", "//nas/music"));
+    QCOMPARE(info.mounts().count(), 2);
+    QCOMPARE(info.mountPoints().values(QStringLiteral("//nas/music")), QStringList() << QStringLiteral("/mnt/my music"));
+    QCOMPARE(info.update(base), QSet<QString>());
+
+    // Other file systems come and go unnoticed, broken lines are skipped
+    const QByteArray busy = base + mountLine(40, "/var/lib/container/rootfs", "overlay", "overlay")
+                            + "41 1 0:41 / /broken\n" + "garbage\n";
+    QCOMPARE(info.update(busy), QSet<QString>());
+
+    QByteArray unmounted = busy;
+    unmounted.replace(mountLine(31, "/mnt/my\\040music", "cifs", "//nas/music"), QByteArray());
+    QCOMPARE(info.update(unmounted), devices("//nas/music"));
+
+    // Mounted again at the same place, which only the mount ID tells
+    QByteArray remounted = unmounted;
+    remounted.replace(mountLine(30, "/mnt/export", "nfs", "server:/export"), mountLine(50, "/mnt/export", "nfs", "server:/export"));
+    QCOMPARE(info.update(remounted), devices("server:/export"));
+
+    QByteArray moved = remounted;
+    moved.replace(mountLine(50, "/mnt/export", "nfs", "server:/export"), mountLine(50, "/srv/export", "nfs", "server:/export"));
+    QCOMPARE(info.update(moved), devices("server:/export"));
+    QCOMPARE(info.mountPoints().values(QStringLiteral("server:/export")), QStringList() << QStringLiteral("/srv/export"));
+
+    QCOMPARE(info.update(moved + mountLine(51, "/home", "nfs4", "server:/home")), devices("server:/home"));
+    QCOMPARE(info.update(QByteArray()), devices("server:/export", "server:/home"));
+    QVERIFY(info.mounts().isEmpty());
+}
+
+static QByteArray syntheticMountInfo(int entries)
+{
+    // Container hosts: mostly overlays and bind mounts, a share every hundred entries
+    QByteArray contents;
+    for (int id = 1; id <= entries; ++id) {
+        if (id % 100 == 0) {
+            contents += mountLine(id, "/mnt/share" + QByteArray::number(id), "nfs4", "server:/share" + QByteArray::number(id));
+        } else {
+            contents += mountLine(id, "/var/lib/containers/" + QByteArray::number(id) + "/rootfs", "overlay", "overlay");
+        }
+    }
+    return contents;
+}
+
+void FstabHandlingTest::benchmarkMountInfoUpdate_data()
+{
+    QTest::addColumn<QByteArray>("before");
+    QTest::addColumn<QByteArray>("after");
+    QTest::addColumn<int>("changes");
+
+    const int entries = 10000;
+    const QByteArray contents = syntheticMountInfo(entries);
+    QTest::newRow("10k entries, unchanged") << contents << contents << 0;
+    QTest::newRow("10k entries, bind mount added") << contents
+                                                   << contents + mountLine(entries + 1, "/var/lib/kubelet/pods/volume", "ext4", "/dev/sdb1")
+                                                   << 0;
+    QTest::newRow("10k entries, share mounted") << contents
+                                                << contents + mountLine(entries + 1, "/mnt/new", "cifs", "//nas/new")
+                                                << 1;
+}
+
+void FstabHandlingTest::benchmarkMountInfoUpdate()
+{
+    QFETCH(QByteArray, before);
+    QFETCH(QByteArray, after);
+    QFETCH(int, changes);
+
+    MountInfo info;
+    info.update(before);
+    QCOMPARE(info.mounts().count(), 100);
+
+    // Back and forth, each way a full parse and diff
+    QBENCHMARK {
+        QCOMPARE(info.update(after).count(), changes);
+        QCOMPARE(info.update(before).count(), changes);
+    }
+}
+
+void FstabHandlingTest::testMtabEventMerging()
+{
+    FstabWatcher *watcher = FstabWatcher::instance();
+    QSignalSpy changed(watcher, SIGNAL(mtabChanged()));
+    const qulonglong merged = watcher->mergedMtabEvents();
+
+    // A container runtime setting up its overlays
+    for (int i = 0; i < 200; ++i) {
+        QVERIFY(QMetaObject::invokeMethod(watcher, "onMtabEvent"));
+    }
+
+    QTRY_COMPARE(changed.count(), 1);
+    QCOMPARE(watcher->mergedMtabEvents() - merged, qulonglong(199));
+
+    // A later change is a burst of its own
+    QVERIFY(QMetaObject::invokeMethod(watcher, "onMtabEvent"));
+    QTRY_COMPARE(changed.count(), 2);
+    QCOMPARE(watcher->mergedMtabEvents() - merged, qulonglong(199));
+}
+
+QTEST_GUILESS_MAIN(FstabHandlingTest)
+
+#include "fstabhandlingtest.moc"
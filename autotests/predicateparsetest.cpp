@@ -0,0 +1,295 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest/QtTest>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <solid/predicate.h>
+#include "predicateparse.h"
+
+class PredicateParseTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testParse_data();
+    void testParse();
+    void testErrors_data();
+    void testErrors();
+    void testErrorPosition();
+    void testStringList();
+    void testUnknownInterface();
+    void testFuzz();
+    void testConcurrentParse();
+    void testNormalize();
+    void testCache();
+    void benchmarkParse_data();
+    void benchmarkParse();
+};
+
+static const char *s_placesQuery =
+    "[[[[ StorageVolume.ignored == false AND [ StorageVolume.usage == 'FileSystem' OR StorageVolume.usage == 'Encrypted' ]]"
+    " OR [ IS StorageAccess AND StorageDrive.driveType == 'Floppy' ]] OR OpticalDisc.availableContent & 'Audio' ]"
+    " OR StorageAccess.ignored == false ]";
+
+void PredicateParseTest::testParse_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("canonical");
+
+    QTest::newRow("atom") << "Processor.number == 1" << "Processor.number == 1";
+    QTest::newRow("no spaces") << "Processor.number==-1" << "Processor.number == -1";
+    QTest::newRow("is") << "IS StorageVolume" << "IS StorageVolume";
+    QTest::newRow("keywords case") << "[Processor.number==1 oR Is StorageVolume]" << "[Processor.number == 1 OR IS StorageVolume]";
+    QTest::newRow("bool") << "Processor.canChangeFrequency == TRUE" << "Processor.canChangeFrequency == true";
+    QTest::newRow("float") << "Battery.voltage == 12.5" << "Battery.voltage == '12.5'";
+    QTest::newRow("negative float") << "Battery.voltage == -.5" << "Battery.voltage == '-0.5'";
+    QTest::newRow("mask") << "OpticalDisc.availableContent & 'Audio|Data'" << "OpticalDisc.availableContent  & 'Audio|Data'";
+    QTest::newRow("escapes") << "StorageVolume.label == 'a\\tb\\nc'" << "StorageVolume.label == 'a\tb\nc'";
+    QTest::newRow("unicode") << QString::fromUtf8("StorageVolume.label == 'Фото'") << QString::fromUtf8("StorageVolume.label == 'Фото'");
+    QTest::newRow("places") << s_placesQuery
+                            << "[[[[StorageVolume.ignored == false AND [StorageVolume.usage == 'FileSystem' OR StorageVolume.usage == 'Encrypted']]"
+                               " OR [IS StorageAccess AND StorageDrive.driveType == 'Floppy']] OR OpticalDisc.availableContent  & 'Audio']"
+                               " OR StorageAccess.ignored == false]";
+}
+
+void PredicateParseTest::testParse()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, canonical);
+
+    const Solid::Predicate predicate = Solid::Predicate::fromString(text);
+    QVERIFY(predicate.isValid());
+    QCOMPARE(predicate.toString(), canonical);
+
+    // The canonical form parses back to itself
+    QCOMPARE(Solid::Predicate::fromString(canonical).toString(), canonical);
+}
+
+void PredicateParseTest::testErrors_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("position");
+
+    QTest::newRow("empty") << "" << 0;
+    QTest::newRow("missing value") << "Processor.number ==" << 19;
+    QTest::newRow("missing dot") << "Processor number == 1" << 10;
+    QTest::newRow("missing operator") << "[IS Processor IS Block]" << 14;
+    QTest::newRow("three operands") << "[IS Processor AND IS Block AND IS Battery]" << 27;
+    QTest::newRow("unclosed bracket") << "[IS Processor AND IS Block" << 26;
+    QTest::newRow("trailing input") << "IS Processor IS Block" << 13;
+    QTest::newRow("unterminated string") << "StorageVolume.label == 'foo" << 23;
+    QTest::newRow("single equal") << "Processor.number = 1" << 19;
+    QTest::newRow("overflow") << "Processor.number == 99999999999" << 20;
+    QTest::newRow("bad list") << "StorageVolume.label == {'a' 'b'}" << 28;
+    QTest::newRow("too deep") << QString(300, QLatin1Char('[')) + "IS Processor" << 257;
+}
+
+void PredicateParseTest::testErrors()
+{
+    QFETCH(QString, text);
+    QFETCH(int, position);
+
+    Solid::PredicateParse::Result result;
+    QVERIFY(!Solid::PredicateParse::parse(QStringRef(&text), &result));
+    QCOMPARE(result.root, -1);
+    QVERIFY(!result.errorMessage.isEmpty());
+    QCOMPARE(result.errorPosition, position);
+
+    QVERIFY(!Solid::Predicate::fromString(text).isValid());
+}
+
+void PredicateParseTest::testErrorPosition()
+{
+    // Reported at the offset of the unexpected IS in what the caller wrote,
+    // not in the normalized cache key
+    QTest::ignoreMessage(QtWarningMsg, "ERROR from solid predicate parser: expected AND or OR at position 17 in predicate '[IS   Processor  IS Block]'");
+    QVERIFY(!Solid::Predicate::fromString(QStringLiteral("[IS   Processor  IS Block]")).isValid());
+}
+
+void PredicateParseTest::testStringList()
+{
+    const QStringList values{QStringLiteral("a"), QStringLiteral("b c")};
+
+    Solid::Predicate predicate = Solid::Predicate::fromString(QStringLiteral("StorageVolume.label == {'a', 'b c'}"));
+    QVERIFY(predicate.isValid());
+    QCOMPARE(predicate.matchingValue().toStringList(), values);
+
+    predicate = Solid::Predicate::fromString(QStringLiteral("StorageVolume.label == {'a', 'b c',}"));
+    QCOMPARE(predicate.matchingValue().toStringList(), values);
+
+    predicate = Solid::Predicate::fromString(QStringLiteral("StorageVolume.label == {}"));
+    QVERIFY(predicate.isValid());
+    QVERIFY(predicate.matchingValue().toStringList().isEmpty());
+}
+
+void PredicateParseTest::testUnknownInterface()
+{
+    // Syntactically fine, but the operand can never match
+    const Solid::Predicate predicate = Solid::Predicate::fromString(QStringLiteral("[Foo.bar == 1 AND IS Processor]"));
+    QVERIFY(predicate.isValid());
+    QVERIFY(!predicate.firstOperand().isValid());
+    QCOMPARE(predicate.toString(), QStringLiteral("[False AND IS Processor]"));
+
+    QVERIFY(!Solid::Predicate::fromString(QStringLiteral("IS Foo")).isValid());
+}
+
+void PredicateParseTest::testFuzz()
+{
+    const QStringList seeds{
+        QString::fromLatin1(s_placesQuery),
+        QStringLiteral("[Processor.canChangeFrequency==true AND Processor.number==1]"),
+        QStringLiteral("StorageVolume.label == {'a', 'b'}"),
+        QStringLiteral("[Battery.voltage == -1.5 OR IS Camera]")
+    };
+    const QString alphabet = QStringLiteral("[]{}'.,=&-09aZ \\\t");
+
+    qsrand(42);
+    for (int round = 0; round < 20000; ++round) {
+        QString text = seeds.at(round % seeds.size());
+        const int mutations = 1 + qrand() % 4;
+        for (int i = 0; i < mutations; ++i) {
+            const int pos = qrand() % (text.size() + 1);
+            switch (qrand() % 3) {
+            case 0:
+                text.remove(pos, 1 + qrand() % 8);
+                break;
+            case 1:
+                text.insert(pos, alphabet.at(qrand() % alphabet.size()));
+                break;
+            default:
+                text.truncate(pos);
+                break;
+            }
+        }
+
+        Solid::PredicateParse::Result result;
+        if (Solid::PredicateParse::parse(QStringRef(&text), &result)) {
+            QVERIFY(result.root >= 0 && result.root < result.nodes.size());
+            const Solid::Predicate predicate = Solid::Predicate::fromString(text);
+            QCOMPARE(predicate.isValid(), result.nodes.at(result.root).isValid);
+            QVERIFY(!predicate.toString().isEmpty());
+        } else {
+            QVERIFY2(result.errorPosition >= 0 && result.errorPosition <= text.size(), qPrintable(text));
+        }
+    }
+}
+
+static QString canonicalForm(const QString &query)
+{
+    return Solid::Predicate::fromString(query).toString();
+}
+
+void PredicateParseTest::testConcurrentParse()
+{
+    QStringList queries;
+    for (int i = 0; i < 1000; ++i) {
+        queries << QStringLiteral("[Processor.number == %1 OR %2]").arg(i).arg(QString::fromLatin1(s_placesQuery));
+    }
+
+    const QList<QString> results = QtConcurrent::blockingMapped(queries, canonicalForm);
+
+    for (int i = 0; i < queries.size(); ++i) {
+        QCOMPARE(results.at(i), Solid::Predicate::fromString(queries.at(i)).toString());
+        QVERIFY(results.at(i).startsWith(QStringLiteral("[Processor.number == %1 OR").arg(i)));
+    }
+}
+
+void PredicateParseTest::testNormalize()
+{
+    using Solid::PredicateParse::Cache;
+
+    const QString clean = QStringLiteral("[IS Processor OR StorageVolume.label == 'a  b']");
+    QCOMPARE(Cache::normalize(clean), clean);
+    // Untouched queries are not copied
+    QVERIFY(Cache::normalize(clean).constData() == clean.constData());
+
+    QCOMPARE(Cache::normalize(QStringLiteral("  [IS\tProcessor   OR\n StorageVolume.label == 'a  b'] ")), clean);
+}
+
+void PredicateParseTest::testCache()
+{
+    using Solid::PredicateParse::Cache;
+
+    Cache::clear();
+
+    const Solid::Predicate first = Solid::Predicate::fromString(QString::fromLatin1(s_placesQuery));
+    QCOMPARE(Cache::misses(), 1ull);
+    QCOMPARE(Cache::hits(), 0ull);
+
+    // Same query once normalized
+    const Solid::Predicate second = Solid::Predicate::fromString(QStringLiteral(" %1\n").arg(QString::fromLatin1(s_placesQuery)));
+    QCOMPARE(Cache::misses(), 1ull);
+    QCOMPARE(Cache::hits(), 1ull);
+    QCOMPARE(second.toString(), first.toString());
+
+    // Also available to applications
+    QCOMPARE(Solid::Predicate::cacheMisses(), Cache::misses());
+    QCOMPARE(Solid::Predicate::cacheHits(), Cache::hits());
+
+    // Invalid queries are remembered as well
+    QVERIFY(!Solid::Predicate::fromString(QStringLiteral("[IS Processor")).isValid());
+    QVERIFY(!Solid::Predicate::fromString(QStringLiteral("[IS Processor")).isValid());
+    QCOMPARE(Cache::misses(), 2ull);
+    QCOMPARE(Cache::hits(), 2ull);
+    QCOMPARE(Cache::size(), 2);
+
+    // Least recently used entries go first
+    for (int i = 0; i < Cache::MaxSize; ++i) {
+        Solid::Predicate::fromString(QStringLiteral("Processor.number == %1").arg(i));
+        if (i % 2 == 0) {
+            Solid::Predicate::fromString(QString::fromLatin1(s_placesQuery));
+        }
+    }
+    QCOMPARE(Cache::size(), int(Cache::MaxSize));
+
+    const qulonglong misses = Cache::misses();
+    Solid::Predicate::fromString(QString::fromLatin1(s_placesQuery));
+    QCOMPARE(Cache::misses(), misses);
+    Solid::Predicate::fromString(QStringLiteral("[IS Processor"));
+    QCOMPARE(Cache::misses(), misses + 1);
+}
+
+void PredicateParseTest::benchmarkParse_data()
+{
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("atom") << "StorageVolume.usage == 'FileSystem'";
+    QTest::newRow("places") << QString::fromLatin1(s_placesQuery);
+
+    QString nested = QStringLiteral("IS Processor");
+    for (int i = 0; i < 64; ++i) {
+        nested = QStringLiteral("[Block.major == %1 OR %2]").arg(i).arg(nested);
+    }
+    QTest::newRow("nested") << nested;
+}
+
+void PredicateParseTest::benchmarkParse()
+{
+    QFETCH(QString, text);
+
+    QBENCHMARK {
+        Solid::PredicateParse::Result result;
+        QVERIFY(Solid::PredicateParse::parse(QStringRef(&text), &result));
+    }
+}
+
+QTEST_GUILESS_MAIN(PredicateParseTest)
+
+#include "predicateparsetest.moc"
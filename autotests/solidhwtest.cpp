@@ -371,6 +371,114 @@ void SolidHwTest::testPredicate()
 
 }
 
+// Tree walking reference matcher, resolving the property by name on every
+// check, which is what Predicate::matches() used to do
+static bool interpretedMatches(const Solid::Predicate &predicate, const Solid::Device &device)
+{
+    if (!predicate.isValid()) {
+        return false;
+    }
+
+    switch (predicate.type()) {
+    case Solid::Predicate::Disjunction:
+        return interpretedMatches(predicate.firstOperand(), device)
+               || interpretedMatches(predicate.secondOperand(), device);
+    case Solid::Predicate::Conjunction:
+        return interpretedMatches(predicate.firstOperand(), device)
+               && interpretedMatches(predicate.secondOperand(), device);
+    case Solid::Predicate::InterfaceCheck:
+        return device.isDeviceInterface(predicate.interfaceType());
+    case Solid::Predicate::PropertyCheck: {
+        const Solid::DeviceInterface *iface = device.asDeviceInterface(predicate.interfaceType());
+        if (!iface) {
+            return false;
+        }
+        const int index = iface->metaObject()->indexOfProperty(predicate.propertyName().toLatin1());
+        QMetaProperty metaProp = iface->metaObject()->property(index);
+        QVariant value = metaProp.isReadable() ? metaProp.read(iface) : QVariant();
+        QVariant expected = predicate.matchingValue();
+        if (metaProp.isEnumType() && expected.type() == QVariant::String) {
+            const int key = metaProp.enumerator().keysToValue(expected.toString().toLatin1());
+            expected = key >= 0 ? QVariant(key) : QVariant();
+        }
+        if (predicate.comparisonOperator() == Solid::Predicate::Mask) {
+            bool v_ok, e_ok;
+            const int v = value.toInt(&v_ok);
+            const int e = expected.toInt(&e_ok);
+            return e_ok && v_ok && (v & e);
+        }
+        return value == expected;
+    }
+    }
+    return false;
+}
+
+void SolidHwTest::benchmarkPredicateMatches_data()
+{
+    QTest::addColumn<bool>("compiled");
+
+    QTest::newRow("interpreted") << false;
+    QTest::newRow("compiled") << true;
+}
+
+void SolidHwTest::benchmarkPredicateMatches()
+{
+    QFETCH(bool, compiled);
+
+    const QStringList queries{
+        "[[[[ StorageVolume.ignored == false AND [ StorageVolume.usage == 'FileSystem' OR StorageVolume.usage == 'Encrypted' ]]"
+        " OR [ IS StorageAccess AND StorageDrive.driveType == 'Floppy' ]] OR OpticalDisc.availableContent & 'Audio' ]"
+        " OR StorageAccess.ignored == false ]",
+        "[Processor.canChangeFrequency == true AND Processor.number == 1]",
+        "[Processor.maxSpeed == 3201 OR IS StorageVolume]",
+        "StorageVolume.usage == 'Other'",
+        "StorageDrive.bus == 'Usb'",
+        "StorageDrive.driveType == 'CdromDrive'",
+        "[StorageDrive.removable == true AND StorageDrive.hotpluggable == true]",
+        "OpticalDrive.supportedMedia & 'Dvd'",
+        "OpticalDisc.discType & 'CdRecordable|CdRewritable'",
+        "[OpticalDisc.blank == true AND OpticalDisc.appendable == false]",
+        "StorageAccess.accessible == true",
+        "[IS Camera OR IS PortableMediaPlayer]",
+        "Battery.type == 'PrimaryBattery'",
+        "[Battery.present == true AND Battery.chargeState == 'Charging']",
+        "Block.major == 8",
+        "[Block.major == 3 AND Block.minor == 1]",
+        "StorageVolume.fsType == 'ext3'",
+        "StorageVolume.label == 'SOLIDMAN_BEGINS'",
+        "NetworkShare.type == 'Nfs'",
+        "[IS Processor AND Processor.instructionSets & 'IntelMmx']"
+    };
+
+    QList<Solid::Predicate> predicates;
+    for (const QString &query : queries) {
+        predicates << Solid::Predicate::fromString(query);
+        QVERIFY2(predicates.last().isValid(), qPrintable(query));
+    }
+
+    const QList<Solid::Device> devices = Solid::Device::allDevices();
+    QVERIFY(!devices.isEmpty());
+
+    // Both matchers have to agree, and warm up the interface caches
+    for (const Solid::Predicate &predicate : predicates) {
+        for (const Solid::Device &device : devices) {
+            QCOMPARE(predicate.matches(device), interpretedMatches(predicate, device));
+        }
+    }
+
+    int matched = 0;
+    QBENCHMARK {
+        for (const Solid::Predicate &predicate : predicates) {
+            for (const Solid::Device &device : devices) {
+                if (compiled ? predicate.matches(device) : interpretedMatches(predicate, device)) {
+                    ++matched;
+                }
+            }
+        }
+    }
+    QVERIFY(matched > 0);
+}
+
 void SolidHwTest::testQueryStorageVolumeOrProcessor()
 {
     auto list = Solid::Device::listFromQuery("[Processor.number==1 OR IS StorageVolume]");
@@ -447,6 +555,57 @@ void SolidHwTest::testListFromTypeProcessor()
     QCOMPARE(list.at(1).udi(), QString("/org/kde/solid/fakehw/acpi_CPU1"));
 }
 
+void SolidHwTest::testProcessorTopology()
+{
+    const QList<Solid::Processor::Topology> topology = Solid::Processor::topology();
+    QCOMPARE(topology.size(), 2);
+
+    QCOMPARE(topology.at(0).number, 0);
+    QCOMPARE(topology.at(0).packageId, 0);
+    QCOMPARE(topology.at(0).dieId, 0);
+    QCOMPARE(topology.at(0).coreId, 0);
+    QCOMPARE(topology.at(0).numaNode, 0);
+    QCOMPARE(topology.at(0).siblings, QList<int>() << 0 << 1);
+
+    // The second thread of the same core, without die or node information
+    QCOMPARE(topology.at(1).number, 1);
+    QCOMPARE(topology.at(1).coreId, topology.at(0).coreId);
+    QCOMPARE(topology.at(1).dieId, -1);
+    QCOMPARE(topology.at(1).numaNode, -1);
+    QCOMPARE(topology.at(1).siblings, topology.at(0).siblings);
+
+    Solid::Device cpu("/org/kde/solid/fakehw/acpi_CPU1");
+    QCOMPARE(cpu.as<Solid::Processor>()->property("packageId").toInt(), 0);
+
+    QCOMPARE(topology.at(0).coreClass, Solid::Processor::PerformanceCore);
+    QCOMPARE(topology.at(0).capacity, 1024);
+    QCOMPARE(topology.at(1).coreClass, Solid::Processor::UnknownCore);
+    QCOMPARE(topology.at(1).capacity, -1);
+
+    const QMap<Solid::Processor::CoreClass, QList<int> > classes = Solid::Processor::coreClasses();
+    QCOMPARE(classes.value(Solid::Processor::PerformanceCore), QList<int>() << 0);
+    QCOMPARE(classes.value(Solid::Processor::UnknownCore), QList<int>() << 1);
+    QVERIFY(!classes.contains(Solid::Processor::EfficiencyCore));
+}
+
+void SolidHwTest::benchmarkProcessorTopology()
+{
+    QBENCHMARK {
+        const QList<Solid::Processor::Topology> topology = Solid::Processor::topology();
+        Q_UNUSED(topology);
+    }
+}
+
+void SolidHwTest::testUsableProcessors()
+{
+    // The second processor is outside the affinity of the process
+    QCOMPARE(Solid::Processor::usableProcessors(), QList<int>() << 0);
+    QVERIFY(!Solid::Device("/org/kde/solid/fakehw/acpi_CPU1").as<Solid::Processor>()->property("usable").toBool());
+
+    QCOMPARE(Solid::Processor::cpuQuota(), qreal(1.5));
+    QCOMPARE(Solid::Processor::idealThreadCount(), 1);
+}
+
 void SolidHwTest::testListFromTypeInvalid()
 {
     const auto list = Solid::Device::listFromQuery("blup", QString());
@@ -51,10 +51,15 @@ private Q_SLOTS:
     void testDeviceInterfaces();
     void testInvalidPredicate();
     void testPredicate();
+    void benchmarkPredicateMatches_data();
+    void benchmarkPredicateMatches();
     void testQueryStorageVolumeOrProcessor();
     void testQueryStorageVolumeOrStorageAccess();
     void testQueryWithParentUdi();
     void testListFromTypeProcessor();
+    void testProcessorTopology();
+    void benchmarkProcessorTopology();
+    void testUsableProcessors();
     void testListFromTypeInvalid();
     void testSetupTeardown();
 
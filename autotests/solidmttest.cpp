@@ -26,6 +26,7 @@
 #include <QtTest/QtTest>
 
 #include <solid/device.h>
+#include <solid/devicenotifier.h>
 #include <solid/predicate.h>
 #include <solid/storagevolume.h>
 #include <solid/storagedrive.h>
@@ -37,6 +38,9 @@ class SolidMtTest : public QObject
 private Q_SLOTS:
     void testWorkerThread();
     void testThreadedPredicate();
+    void testSharedRegistry();
+    void benchmarkConcurrentLookup_data();
+    void benchmarkConcurrentLookup();
 };
 
 class WorkerThread : public QThread
@@ -64,6 +68,25 @@ static void doPredicates()
     Solid::Predicate p7 = Solid::Predicate::fromString(QString("StorageVolume.usage == %1").arg((int)Solid::StorageVolume::Other));
 }
 
+static Solid::DeviceNotifier *notifierInstance()
+{
+    return Solid::DeviceNotifier::instance();
+}
+
+static void lookupDevices(const QStringList &udis, int rounds)
+{
+    for (int i = 0; i < rounds; ++i) {
+        Q_FOREACH (const QString &udi, udis) {
+            Solid::Device dev(udi);
+            // Getters read the backends from this thread
+            if (dev.isValid()) {
+                dev.product();
+                dev.vendor();
+            }
+        }
+    }
+}
+
 QTEST_MAIN(SolidMtTest)
 
 void SolidMtTest::testWorkerThread()
@@ -102,5 +125,68 @@ void SolidMtTest::testThreadedPredicate()
     QThreadPool::globalInstance()->setMaxThreadCount(1); // delete those threads
 }
 
+void SolidMtTest::testSharedRegistry()
+{
+    // All threads share a single registry and its backends
+    Solid::DeviceNotifier *mainNotifier = Solid::DeviceNotifier::instance();
+    QVERIFY(mainNotifier);
+    QVERIFY(mainNotifier->thread() != QThread::currentThread());
+
+    QThreadPool::globalInstance()->setMaxThreadCount(8);
+    QList<QFuture<Solid::DeviceNotifier *> > futures;
+    for (int i = 0; i < 8; ++i) {
+        futures << QtConcurrent::run(&notifierInstance);
+    }
+    Q_FOREACH (QFuture<Solid::DeviceNotifier *> f, futures) {
+        QCOMPARE(f.result(), mainNotifier);
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(1); // delete those threads
+}
+
+void SolidMtTest::benchmarkConcurrentLookup_data()
+{
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+    QTest::newRow("16 threads") << 16;
+    QTest::newRow("32 threads") << 32;
+}
+
+void SolidMtTest::benchmarkConcurrentLookup()
+{
+    QFETCH(int, threads);
+
+    // Held for the whole run, so the lookups find them in the registry
+    // instead of registering them again from the backend thread
+    const QList<Solid::Device> devices = Solid::Device::allDevices();
+    QStringList udis;
+    Q_FOREACH (const Solid::Device &dev, devices) {
+        udis << dev.udi();
+    }
+    if (udis.isEmpty()) {
+        QSKIP("No devices to look up on this system");
+    }
+
+    // Every thread does the same amount of lookups and reads. The lookups
+    // run concurrently, the reads take turns on the backend lock but skip
+    // the trip through the backend thread
+    const int rounds = qMax(1, 10000 / udis.count());
+
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    QBENCHMARK {
+        QList<QFuture<void> > futures;
+        for (int i = 0; i < threads; ++i) {
+            futures << QtConcurrent::run(&lookupDevices, udis, rounds);
+        }
+        Q_FOREACH (QFuture<void> f, futures) {
+            f.waitForFinished();
+        }
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(1); // delete those threads
+}
+
 #include "solidmttest.moc"
 
@@ -0,0 +1,718 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "qtest_dbus.h"
+#include "fakeUdisks2.h"
+
+#include <QDBusConnection>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QTest>
+#include <QThread>
+#include <QtEndian>
+
+#include <solid/device.h>
+#include <solid/opticaldisc.h>
+
+#include "udisksblock.h"
+#include "udisksdevice.h"
+#include "udisksmanager.h"
+#include "udisksopticaldiscprobe.h"
+#include "udiskscontenttypescache.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+class SolidUDisks2Test : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkColdEnumeration_data();
+    void benchmarkColdEnumeration();
+    void testSignalDispatch_data();
+    void testSignalDispatch();
+    void testHotplugWithoutCalls();
+    void testSharedPropertyAfterInterfaceRemoved();
+    void testPartialRemovalBeforeSnapshot();
+    void testDriveBlockDevice();
+    void testOpticalDiscProbe_data();
+    void testOpticalDiscProbe();
+    void testOpticalDiscProbeAsync();
+    void testOpticalDiscContentChanged();
+    void testContentTypesCache();
+    void testContentTypesCacheDeadWriter();
+    void benchmarkContentTypesCache_data();
+    void benchmarkContentTypesCache();
+
+private:
+    FakeUdisks2 *m_fakeUdisks2;
+    QThread m_fakeThread;
+};
+
+void SolidUDisks2Test::initTestCase()
+{
+    // The fake service answers from its own connection and thread, so every
+    // call made by the backend is a real round-trip through the bus daemon
+    QDBusConnection connection = QDBusConnection::connectToBus(QDBusConnection::SystemBus, QStringLiteral("fakeudisks2"));
+    QVERIFY(connection.isConnected());
+
+    m_fakeUdisks2 = new FakeUdisks2(QStringLiteral("fakeudisks2"));
+    m_fakeUdisks2->moveToThread(&m_fakeThread);
+    m_fakeThread.start();
+
+    QVERIFY(connection.registerVirtualObject(QStringLiteral(UD2_DBUS_PATH), m_fakeUdisks2, QDBusConnection::SubPath));
+    QVERIFY(connection.registerService(QStringLiteral(UD2_DBUS_SERVICE)));
+}
+
+void SolidUDisks2Test::cleanupTestCase()
+{
+    QDBusConnection::disconnectFromBus(QStringLiteral("fakeudisks2"));
+    m_fakeThread.quit();
+    m_fakeThread.wait();
+    delete m_fakeUdisks2;
+}
+
+void SolidUDisks2Test::benchmarkColdEnumeration_data()
+{
+    QTest::addColumn<int>("objects");
+
+    QTest::newRow("10 objects") << 10;
+    QTest::newRow("100 objects") << 100;
+    QTest::newRow("1000 objects") << 1000;
+}
+
+void SolidUDisks2Test::benchmarkColdEnumeration()
+{
+    QFETCH(int, objects);
+
+    m_fakeUdisks2->setBlockDevices(objects);
+    m_fakeUdisks2->resetCallCount();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList volumes;
+    QBENCHMARK_ONCE {
+        Solid::Backends::UDisks2::Manager manager(nullptr);
+        QCOMPARE(manager.allDevices().count(), objects);
+
+        volumes = manager.devicesFromQuery(QString(), Solid::DeviceInterface::StorageVolume);
+    }
+
+    const qint64 elapsed = timer.elapsed();
+    qDebug() << objects << "objects enumerated with" << m_fakeUdisks2->callCount()
+             << "round-trips in" << elapsed << "ms";
+
+    QCOMPARE(volumes.count(), objects);
+
+    // A single GetManagedObjects fills every cache, no per-object
+    // Introspect, GetAll or Get is needed anymore
+    QCOMPARE(m_fakeUdisks2->callCount(QStringLiteral("GetManagedObjects")), 1);
+    QCOMPARE(m_fakeUdisks2->callCount(), 1);
+}
+
+void SolidUDisks2Test::testSignalDispatch_data()
+{
+    QTest::addColumn<int>("objects");
+
+    QTest::newRow("10 objects") << 10;
+    QTest::newRow("100 objects") << 100;
+}
+
+void SolidUDisks2Test::testSignalDispatch()
+{
+    QFETCH(int, objects);
+
+    m_fakeUdisks2->setBlockDevices(objects);
+
+    Solid::Backends::UDisks2::Manager manager(nullptr);
+    const QStringList udis = manager.allDevices();
+    QCOMPARE(udis.count(), objects);
+
+    // The subscriptions don't grow with the number of devices
+    QCOMPARE(manager.property("matchRules").toInt(), 3);
+    QCOMPARE(manager.property("dispatchedSignals").toULongLong(), qulonglong(0));
+
+    const QString udi = udis.last();
+    Solid::Backends::UDisks2::Device device(udi);
+    QCOMPARE(device.prop(QStringLiteral("IdLabel")).toString(), udi.section(QLatin1Char('/'), -1));
+
+    m_fakeUdisks2->resetCallCount();
+    const qulonglong indexed = manager.property("indexedDevices").toULongLong();
+    m_fakeUdisks2->changeProperty(udi, QStringLiteral(UD2_DBUS_INTERFACE_BLOCK), QStringLiteral("IdLabel"), QStringLiteral("relabeled"));
+
+    // Routed to the single backend it is meant for, without asking the service again
+    QTRY_COMPARE(device.prop(QStringLiteral("IdLabel")).toString(), QStringLiteral("relabeled"));
+    QCOMPARE(manager.property("dispatchedSignals").toULongLong(), qulonglong(1));
+    QCOMPARE(m_fakeUdisks2->callCount(), 0);
+
+    // The label is no business of the catalog, the parent is
+    QCOMPARE(manager.property("indexedDevices").toULongLong(), indexed);
+    m_fakeUdisks2->changeProperty(udi, QStringLiteral(UD2_DBUS_INTERFACE_BLOCK), QStringLiteral("Drive"),
+                                  QVariant::fromValue(QDBusObjectPath(QStringLiteral("/"))));
+    QTRY_COMPARE(manager.property("dispatchedSignals").toULongLong(), qulonglong(2));
+    QCOMPARE(manager.property("indexedDevices").toULongLong(), indexed + 1);
+}
+
+void SolidUDisks2Test::testHotplugWithoutCalls()
+{
+    m_fakeUdisks2->setBlockDevices(10);
+
+    Solid::Backends::UDisks2::Manager manager(nullptr);
+    QCOMPARE(manager.devicesFromQuery(QString(), Solid::DeviceInterface::StorageVolume).count(), 10);
+
+    QSignalSpy added(&manager, SIGNAL(deviceAdded(QString)));
+    QSignalSpy removed(&manager, SIGNAL(deviceRemoved(QString)));
+    m_fakeUdisks2->resetCallCount();
+
+    const QString drivePath = QStringLiteral(UD2_DBUS_PATH_DRIVES) + QStringLiteral("hotplugged");
+    QVariantMap drive;
+    drive.insert(QStringLiteral("Vendor"), QStringLiteral("Fake"));
+    drive.insert(QStringLiteral("Model"), QStringLiteral("Stick"));
+    drive.insert(QStringLiteral("MediaRemovable"), true);
+    drive.insert(QStringLiteral("MediaAvailable"), true);
+    drive.insert(QStringLiteral("MediaCompatibility"), QStringList() << QStringLiteral("thumb"));
+    drive.insert(QStringLiteral("Optical"), false);
+    drive.insert(QStringLiteral("Size"), qulonglong(8) * 1024 * 1024 * 1024);
+    VariantMapMap driveInterfaces;
+    driveInterfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_DRIVE), drive);
+
+    const QString blockPath = QStringLiteral(UD2_DBUS_PATH_BLOCKDEVICES) + QStringLiteral("sdz");
+    QVariantMap block;
+    block.insert(QStringLiteral("Device"), QByteArray("/dev/sdz\0", 9));
+    block.insert(QStringLiteral("Drive"), QVariant::fromValue(QDBusObjectPath(drivePath)));
+    block.insert(QStringLiteral("CryptoBackingDevice"), QVariant::fromValue(QDBusObjectPath("/")));
+    block.insert(QStringLiteral("IdUsage"), QStringLiteral("filesystem"));
+    block.insert(QStringLiteral("IdType"), QStringLiteral("vfat"));
+    block.insert(QStringLiteral("IdLabel"), QStringLiteral("HOTPLUG"));
+    QVariantMap filesystem;
+    filesystem.insert(QStringLiteral("MountPoints"), QVariant::fromValue(QByteArrayList()));
+    VariantMapMap blockInterfaces;
+    blockInterfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_BLOCK), block);
+    blockInterfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_FILESYSTEM), filesystem);
+
+    m_fakeUdisks2->addObject(drivePath, driveInterfaces);
+    m_fakeUdisks2->addObject(blockPath, blockInterfaces);
+    QTRY_COMPARE(added.count(), 2);
+
+    // Everything needed came with the signals
+    QCOMPARE(manager.devicesFromQuery(drivePath, Solid::DeviceInterface::StorageVolume), QStringList() << blockPath);
+    QCOMPARE(manager.devicesFromQuery(QString(), Solid::DeviceInterface::StorageDrive), QStringList() << drivePath);
+    QCOMPARE(Solid::Backends::UDisks2::Device(blockPath).prop(QStringLiteral("IdLabel")).toString(), QStringLiteral("HOTPLUG"));
+    QCOMPARE(Solid::Backends::UDisks2::Device(drivePath).prop(QStringLiteral("Model")).toString(), QStringLiteral("Stick"));
+    QCOMPARE(m_fakeUdisks2->callCount(), 0);
+
+    // Only the media keys of the drive are fetched again, and only when read
+    QCOMPARE(Solid::Backends::UDisks2::Device(drivePath).prop(QStringLiteral("MediaAvailable")).toBool(), true);
+    QCOMPARE(m_fakeUdisks2->callCount(QStringLiteral("Get")), 1);
+    QCOMPARE(m_fakeUdisks2->callCount(), 1);
+
+    m_fakeUdisks2->resetCallCount();
+    m_fakeUdisks2->removeObject(blockPath);
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(removed.at(0).at(0).toString(), blockPath);
+    QVERIFY(manager.devicesFromQuery(drivePath, Solid::DeviceInterface::StorageVolume).isEmpty());
+    QCOMPARE(m_fakeUdisks2->callCount(), 0);
+
+    m_fakeUdisks2->removeObject(drivePath);
+    QTRY_COMPARE(removed.count(), 2);
+    QVERIFY(manager.devicesFromQuery(QString(), Solid::DeviceInterface::StorageDrive).isEmpty());
+    QCOMPARE(m_fakeUdisks2->callCount(), 0);
+}
+
+void SolidUDisks2Test::testSharedPropertyAfterInterfaceRemoved()
+{
+    m_fakeUdisks2->setBlockDevices(0);
+
+    Solid::Backends::UDisks2::Manager manager(nullptr);
+    manager.allDevices();
+    QSignalSpy added(&manager, SIGNAL(deviceAdded(QString)));
+
+    // Block and Partition both have a Size, of the device and of the
+    // partition table entry
+    const QString blockPath = QStringLiteral(UD2_DBUS_PATH_BLOCKDEVICES) + QStringLiteral("sdy1");
+    QVariantMap block;
+    block.insert(QStringLiteral("Device"), QByteArray("/dev/sdy1\0", 10));
+    block.insert(QStringLiteral("Size"), qulonglong(2048));
+    QVariantMap partition;
+    partition.insert(QStringLiteral("Number"), 1u);
+    partition.insert(QStringLiteral("Size"), qulonglong(1024));
+    VariantMapMap interfaces;
+    interfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_BLOCK), block);
+    interfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_PARTITION), partition);
+    m_fakeUdisks2->addObject(blockPath, interfaces);
+    QTRY_COMPARE(added.count(), 1);
+
+    Solid::Backends::UDisks2::Device device(blockPath);
+    QVERIFY(device.prop(QStringLiteral("Size")).isValid());
+
+    // The key stays, read again from the interface left
+    m_fakeUdisks2->resetCallCount();
+    m_fakeUdisks2->removeInterface(blockPath, QStringLiteral(UD2_DBUS_INTERFACE_PARTITION));
+    QTRY_VERIFY(!device.interfaces().contains(QStringLiteral(UD2_DBUS_INTERFACE_PARTITION)));
+    QCOMPARE(device.prop(QStringLiteral("Size")).toULongLong(), qulonglong(2048));
+    QCOMPARE(m_fakeUdisks2->callCount(QStringLiteral("Get")), 1);
+
+    // Keys only the removed interface had are gone without asking
+    QVERIFY(!device.propertyExists(QStringLiteral("Number")));
+    QCOMPARE(m_fakeUdisks2->callCount(), 1);
+
+    m_fakeUdisks2->removeObject(blockPath);
+}
+
+void SolidUDisks2Test::testPartialRemovalBeforeSnapshot()
+{
+    m_fakeUdisks2->setBlockDevices(0);
+
+    // Not enumerated yet, so no backend gets created for the new object
+    Solid::Backends::UDisks2::Manager manager(nullptr);
+    QSignalSpy added(&manager, SIGNAL(deviceAdded(QString)));
+    QSignalSpy removed(&manager, SIGNAL(deviceRemoved(QString)));
+
+    const QString blockPath = QStringLiteral(UD2_DBUS_PATH_BLOCKDEVICES) + QStringLiteral("sdx");
+    QVariantMap block;
+    block.insert(QStringLiteral("Device"), QByteArray("/dev/sdx\0", 9));
+    QVariantMap filesystem;
+    filesystem.insert(QStringLiteral("MountPoints"), QVariant::fromValue(QByteArrayList()));
+    VariantMapMap interfaces;
+    interfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_BLOCK), block);
+    interfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_FILESYSTEM), filesystem);
+    m_fakeUdisks2->addObject(blockPath, interfaces);
+    QTRY_COMPARE(added.count(), 1);
+
+    // Losing the filesystem, on reformatting, leaves the block device. The
+    // signals come in order, once the next object is added it got handled.
+    const QString otherPath = QStringLiteral(UD2_DBUS_PATH_BLOCKDEVICES) + QStringLiteral("sdw");
+    m_fakeUdisks2->removeInterface(blockPath, QStringLiteral(UD2_DBUS_INTERFACE_FILESYSTEM));
+    m_fakeUdisks2->addObject(otherPath, interfaces);
+    QTRY_COMPARE(added.count(), 2);
+    QCOMPARE(removed.count(), 0);
+
+    m_fakeUdisks2->removeInterface(blockPath, QStringLiteral(UD2_DBUS_INTERFACE_BLOCK));
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(removed.at(0).at(0).toString(), blockPath);
+
+    m_fakeUdisks2->removeObject(otherPath);
+    QTRY_COMPARE(removed.count(), 2);
+}
+
+static VariantMapMap blockInterfaces(const QString &drivePath, const QByteArray &deviceFile, qulonglong deviceNumber, bool partition)
+{
+    QVariantMap block;
+    block.insert(QStringLiteral("Device"), deviceFile + '\0');
+    block.insert(QStringLiteral("DeviceNumber"), deviceNumber);
+    block.insert(QStringLiteral("Drive"), QVariant::fromValue(QDBusObjectPath(drivePath)));
+
+    VariantMapMap interfaces;
+    interfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_BLOCK), block);
+    if (partition) {
+        QVariantMap partitionProps;
+        partitionProps.insert(QStringLiteral("Number"), 1u);
+        interfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_PARTITION), partitionProps);
+    }
+    return interfaces;
+}
+
+void SolidUDisks2Test::testDriveBlockDevice()
+{
+    m_fakeUdisks2->setBlockDevices(100);
+
+    Solid::Backends::UDisks2::Manager manager(nullptr);
+    QCOMPARE(manager.allDevices().count(), 100);
+
+    QSignalSpy added(&manager, SIGNAL(deviceAdded(QString)));
+    QSignalSpy removed(&manager, SIGNAL(deviceRemoved(QString)));
+
+    const QString drivePath = QStringLiteral(UD2_DBUS_PATH_DRIVES) + QStringLiteral("disk");
+    VariantMapMap driveInterfaces;
+    driveInterfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_DRIVE), QVariantMap());
+    const QString partitionPath = QStringLiteral(UD2_DBUS_PATH_BLOCKDEVICES) + QStringLiteral("sdy1");
+    const QString diskPath = QStringLiteral(UD2_DBUS_PATH_BLOCKDEVICES) + QStringLiteral("sdy");
+
+    m_fakeUdisks2->addObject(drivePath, driveInterfaces);
+    m_fakeUdisks2->addObject(partitionPath, blockInterfaces(drivePath, "/dev/sdy1", 8 * 256 + 129, true));
+    m_fakeUdisks2->addObject(diskPath, blockInterfaces(drivePath, "/dev/sdy", 8 * 256 + 128, false));
+    QTRY_COMPARE(added.count(), 3);
+
+    // Resolved from what the manager keeps, not by looking at every block device
+    m_fakeUdisks2->resetCallCount();
+    {
+        Solid::Backends::UDisks2::Device drive(drivePath);
+        Solid::Backends::UDisks2::Block block(&drive);
+        QCOMPARE(block.device(), QStringLiteral("/dev/sdy"));
+        QCOMPARE(block.deviceMajor(), 8);
+        QCOMPARE(block.deviceMinor(), 128);
+    }
+    QCOMPARE(m_fakeUdisks2->callCount(), 0);
+
+    // Falls back to what is left
+    m_fakeUdisks2->removeObject(diskPath);
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(Solid::Backends::UDisks2::Manager::primaryBlockDevice(drivePath), partitionPath);
+
+    m_fakeUdisks2->removeObject(partitionPath);
+    QTRY_COMPARE(removed.count(), 2);
+    QVERIFY(Solid::Backends::UDisks2::Manager::primaryBlockDevice(drivePath).isEmpty());
+}
+
+typedef QList<QPair<QByteArray, quint16> > PathTable;
+
+// An ISO 9660 image holding only what the probe reads: the primary volume
+// descriptor and a path table, the root directory first
+static QByteArray isoImage(const PathTable &directories, quint16 blockSize = 2048)
+{
+    const quint32 tableBlock = 20;
+
+    QByteArray table;
+    PathTable entries = PathTable() << qMakePair(QByteArray(1, '\0'), quint16(1));
+    entries += directories;
+    Q_FOREACH (const PathTable::value_type &entry, entries) {
+        QByteArray record(8, '\0');
+        record[0] = char(entry.first.size());
+        qToLittleEndian<quint16>(entry.second, reinterpret_cast<uchar *>(record.data()) + 6);
+        record += entry.first;
+        if (entry.first.size() % 2) {
+            record += '\0';
+        }
+        table += record;
+    }
+
+    QByteArray image(qMax<int>(tableBlock * blockSize + table.size(), 18 * 2048), '\0');
+    uchar *descriptor = reinterpret_cast<uchar *>(image.data()) + 16 * 2048;
+    descriptor[0] = 1;
+    memcpy(descriptor + 1, "CD001", 5);
+    descriptor[6] = 1;
+    qToLittleEndian<quint16>(blockSize, descriptor + 128);
+    qToBigEndian<quint16>(blockSize, descriptor + 130);
+    qToLittleEndian<quint32>(table.size(), descriptor + 132);
+    qToBigEndian<quint32>(table.size(), descriptor + 136);
+    qToLittleEndian<quint32>(tableBlock, descriptor + 140);
+
+    uchar *terminator = descriptor + 2048;
+    terminator[0] = 255;
+    memcpy(terminator + 1, "CD001", 5);
+    terminator[6] = 1;
+
+    image.replace(tableBlock * blockSize, table.size(), table);
+    return image;
+}
+
+void SolidUDisks2Test::testOpticalDiscProbe_data()
+{
+    QTest::addColumn<QByteArray>("image");
+    QTest::addColumn<int>("content");
+
+    const quint16 root = 1;
+    QTest::newRow("data disc") << isoImage(PathTable() << qMakePair(QByteArray("DOCS"), root))
+                               << int(Solid::OpticalDisc::NoContent);
+    QTest::newRow("video dvd") << isoImage(PathTable() << qMakePair(QByteArray("AUDIO_TS"), root) << qMakePair(QByteArray("VIDEO_TS"), root))
+                               << int(Solid::OpticalDisc::VideoDvd);
+    QTest::newRow("blu-ray, lower case") << isoImage(PathTable() << qMakePair(QByteArray("bdmv"), root))
+                                         << int(Solid::OpticalDisc::VideoBluRay);
+    QTest::newRow("video cd after odd name") << isoImage(PathTable() << qMakePair(QByteArray("EXT"), root) << qMakePair(QByteArray("VCD"), root))
+                                             << int(Solid::OpticalDisc::VideoCd);
+    QTest::newRow("super video cd") << isoImage(PathTable() << qMakePair(QByteArray("SVCD"), root))
+                                    << int(Solid::OpticalDisc::SuperVideoCd);
+    QTest::newRow("video_ts below the root") << isoImage(PathTable() << qMakePair(QByteArray("DATA"), root) << qMakePair(QByteArray("VIDEO_TS"), quint16(2)))
+                                             << int(Solid::OpticalDisc::NoContent);
+    QTest::newRow("512 byte blocks") << isoImage(PathTable() << qMakePair(QByteArray("VIDEO_TS"), root), 512)
+                                     << int(Solid::OpticalDisc::VideoDvd);
+    QTest::newRow("truncated path table") << isoImage(PathTable() << qMakePair(QByteArray("DATA"), root) << qMakePair(QByteArray("VIDEO_TS"), root)).left(20 * 2048 + 14)
+                                          << int(Solid::OpticalDisc::NoContent);
+    QTest::newRow("no volume descriptor") << QByteArray(4096, '\0') << int(Solid::OpticalDisc::NoContent);
+}
+
+void SolidUDisks2Test::testOpticalDiscProbe()
+{
+    QFETCH(QByteArray, image);
+    QFETCH(int, content);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write(image), qint64(image.size()));
+    file.close();
+
+    using Solid::Backends::UDisks2::OpticalDiscProbe;
+    QCOMPARE(int(OpticalDiscProbe::probe(QFile::encodeName(file.fileName()))), content);
+}
+
+void SolidUDisks2Test::testOpticalDiscProbeAsync()
+{
+    using Solid::Backends::UDisks2::OpticalDiscProbe;
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(isoImage(PathTable() << qMakePair(QByteArray("VIDEO_TS"), quint16(1))));
+    file.close();
+
+    QCOMPARE(int(OpticalDiscProbe::probe("/nonexistent/sr0")), int(Solid::OpticalDisc::NoContent));
+
+    QPointer<OpticalDiscProbe> probe = new OpticalDiscProbe(QFile::encodeName(file.fileName()));
+    QList<Solid::OpticalDisc::ContentTypes> results;
+    connect(probe.data(), &OpticalDiscProbe::finished, this, [&results](Solid::OpticalDisc::ContentTypes content) {
+        results << content;
+    });
+    probe->start();
+
+    // Delivered to this thread, then the probe goes away on its own
+    QTRY_COMPARE(results.count(), 1);
+    QCOMPARE(results.first(), Solid::OpticalDisc::ContentTypes(Solid::OpticalDisc::VideoDvd));
+    QTRY_VERIFY(probe.isNull());
+}
+
+void SolidUDisks2Test::testOpticalDiscContentChanged()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(isoImage(PathTable() << qMakePair(QByteArray("VIDEO_TS"), quint16(1))));
+    file.close();
+
+    // A detection time no earlier run can have left in the shared content cache
+    const QString drivePath = QStringLiteral(UD2_DBUS_PATH_DRIVES) + QStringLiteral("dvd");
+    QVariantMap drive;
+    drive.insert(QStringLiteral("Vendor"), QStringLiteral("Fake"));
+    drive.insert(QStringLiteral("Model"), QStringLiteral("DVD"));
+    drive.insert(QStringLiteral("MediaRemovable"), true);
+    drive.insert(QStringLiteral("MediaAvailable"), true);
+    drive.insert(QStringLiteral("MediaCompatibility"), QStringList() << QStringLiteral("optical_cd") << QStringLiteral("optical_dvd"));
+    drive.insert(QStringLiteral("Media"), QStringLiteral("optical_dvd"));
+    drive.insert(QStringLiteral("Optical"), true);
+    drive.insert(QStringLiteral("OpticalBlank"), false);
+    drive.insert(QStringLiteral("OpticalNumDataTracks"), uint(1));
+    drive.insert(QStringLiteral("OpticalNumAudioTracks"), uint(0));
+    drive.insert(QStringLiteral("TimeMediaDetected"), qulonglong(QDateTime::currentMSecsSinceEpoch()) * 1000);
+    VariantMapMap driveInterfaces;
+    driveInterfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_DRIVE), drive);
+
+    const QString discPath = QStringLiteral(UD2_DBUS_PATH_BLOCKDEVICES) + QStringLiteral("sr0");
+    QVariantMap block;
+    block.insert(QStringLiteral("Device"), QByteArray(QFile::encodeName(file.fileName()) + '\0'));
+    block.insert(QStringLiteral("Size"), qulonglong(file.size()));
+    block.insert(QStringLiteral("Drive"), QVariant::fromValue(QDBusObjectPath(drivePath)));
+    block.insert(QStringLiteral("CryptoBackingDevice"), QVariant::fromValue(QDBusObjectPath("/")));
+    block.insert(QStringLiteral("IdUsage"), QStringLiteral("filesystem"));
+    block.insert(QStringLiteral("IdType"), QStringLiteral("iso9660"));
+    block.insert(QStringLiteral("IdLabel"), QStringLiteral("MOVIE"));
+    VariantMapMap discInterfaces;
+    discInterfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_BLOCK), block);
+    discInterfaces.insert(QStringLiteral(UD2_DBUS_INTERFACE_FILESYSTEM), QVariantMap());
+
+    m_fakeUdisks2->setBlockDevices(0);
+    m_fakeUdisks2->addObject(drivePath, driveInterfaces);
+    m_fakeUdisks2->addObject(discPath, discInterfaces);
+
+    qRegisterMetaType<Solid::OpticalDisc::ContentTypes>();
+
+    Solid::Device device(discPath);
+    Solid::OpticalDisc *disc = device.as<Solid::OpticalDisc>();
+    QVERIFY(disc);
+    QSignalSpy changed(disc, SIGNAL(availableContentChanged(Solid::OpticalDisc::ContentTypes,QString)));
+
+    // Answered right away with what the drive tells, the video content
+    // types follow once the disc has been read
+    QVERIFY(disc->availableContent() & Solid::OpticalDisc::Data);
+    QTRY_COMPARE(changed.count(), 1);
+    QVERIFY(!disc->isContentProbePending());
+    QCOMPARE(changed.at(0).at(0).value<Solid::OpticalDisc::ContentTypes>(),
+             Solid::OpticalDisc::ContentTypes(Solid::OpticalDisc::Data | Solid::OpticalDisc::VideoDvd));
+    QCOMPARE(changed.at(0).at(1).toString(), discPath);
+    QCOMPARE(disc->availableContent(), Solid::OpticalDisc::ContentTypes(Solid::OpticalDisc::Data | Solid::OpticalDisc::VideoDvd));
+
+    // Known from then on, without reading the disc again
+    QCOMPARE(disc->availableContent(), Solid::OpticalDisc::ContentTypes(Solid::OpticalDisc::Data | Solid::OpticalDisc::VideoDvd));
+    QVERIFY(!disc->isContentProbePending());
+    QCOMPARE(changed.count(), 1);
+}
+
+using Solid::Backends::UDisks2::ContentTypesCache;
+using Solid::Backends::UDisks2::OpticalDisc;
+
+static OpticalDisc::Identity discIdentity(int disc)
+{
+    return OpticalDisc::Identity(1000000 + disc, qlonglong(disc) << 20, uint(disc) * 7919);
+}
+
+static Solid::OpticalDisc::ContentTypes discContent(int disc)
+{
+    return Solid::OpticalDisc::Data | Solid::OpticalDisc::ContentType(Solid::OpticalDisc::VideoCd << (disc % 4));
+}
+
+void SolidUDisks2Test::testContentTypesCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.path() + QStringLiteral("/content");
+
+    ContentTypesCache cache(fileName, 16);
+    QVERIFY(cache.isShared());
+    QCOMPARE(cache.capacity(), 16);
+
+    Solid::OpticalDisc::ContentTypes content;
+    QVERIFY(!cache.find(discIdentity(1), &content));
+    cache.add(discIdentity(1), Solid::OpticalDisc::VideoDvd);
+    QVERIFY(cache.find(discIdentity(1), &content));
+    QCOMPARE(content, Solid::OpticalDisc::ContentTypes(Solid::OpticalDisc::VideoDvd));
+
+    // Another mapping of the file, as another process has it, sees the same table
+    ContentTypesCache other(fileName, 16);
+    QVERIFY(other.find(discIdentity(1), &content));
+    QCOMPARE(content, Solid::OpticalDisc::ContentTypes(Solid::OpticalDisc::VideoDvd));
+    other.add(discIdentity(1), Solid::OpticalDisc::VideoBluRay);
+    QVERIFY(cache.find(discIdentity(1), &content));
+    QCOMPARE(content, Solid::OpticalDisc::ContentTypes(Solid::OpticalDisc::VideoBluRay));
+    QVERIFY(!cache.find(OpticalDisc::Identity(1000001, qlonglong(1) << 20, 0), &content));
+
+    // Full, the latest writes stay and nothing older than the capacity does
+    for (int disc = 0; disc < 1000; ++disc) {
+        cache.add(discIdentity(disc), discContent(disc));
+    }
+    QVERIFY(cache.find(discIdentity(999), &content));
+    QCOMPARE(content, discContent(999));
+    int found = 0;
+    for (int disc = 0; disc < 1000; ++disc) {
+        if (cache.find(discIdentity(disc), &content)) {
+            QCOMPARE(content, discContent(disc));
+            ++found;
+        }
+    }
+    QVERIFY(found > 0 && found <= cache.capacity());
+
+    // Without a file the table is private, rounded up all the same
+    ContentTypesCache unshared(QString(), 10);
+    QVERIFY(!unshared.isShared());
+    QCOMPARE(unshared.capacity(), 16);
+    unshared.add(discIdentity(2), discContent(2));
+    QVERIFY(unshared.find(discIdentity(2), &content));
+    QCOMPARE(content, discContent(2));
+}
+
+void SolidUDisks2Test::testContentTypesCacheDeadWriter()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.path() + QStringLiteral("/content");
+
+    // Eight slots, every disc probes all of them
+    ContentTypesCache cache(fileName, 8);
+    QCOMPARE(cache.capacity(), 8);
+
+    // Writers died on every slot, leaving their sequence odd: a 64 byte
+    // header, then slots of a sequence and seven fields
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    for (int slot = 0; slot < 8; ++slot) {
+        QVERIFY(file.seek(64 + slot * 32));
+        const quint32 sequence = 1;
+        QCOMPARE(file.write(reinterpret_cast<const char *>(&sequence), sizeof(sequence)), qint64(sizeof(sequence)));
+    }
+    file.close();
+
+    // The first add only notices, a writer may still be busy
+    Solid::OpticalDisc::ContentTypes content;
+    cache.add(discIdentity(3), discContent(3));
+    QVERIFY(!cache.find(discIdentity(3), &content));
+
+    // Still stuck later on, the slot gets taken over
+    QTest::qWait(50);
+    cache.add(discIdentity(3), discContent(3));
+    QVERIFY(cache.find(discIdentity(3), &content));
+    QCOMPARE(content, discContent(3));
+
+    // And is an ordinary slot again
+    cache.add(discIdentity(3), Solid::OpticalDisc::VideoDvd);
+    QVERIFY(cache.find(discIdentity(3), &content));
+    QCOMPARE(content, Solid::OpticalDisc::ContentTypes(Solid::OpticalDisc::VideoDvd));
+}
+
+static const int CacheCapacity = 1024;
+static const int CacheDiscs = 2 * CacheCapacity;
+
+// Runs in a forked child, which must not allocate: the parent has other threads
+static int hammerContentTypesCache(ContentTypesCache *cache, quint32 seed)
+{
+    quint32 state = seed * 2654435761u + 1;
+    for (int i = 0; i < 100000; ++i) {
+        state = state * 1664525u + 1013904223u;
+        const int disc = (state >> 8) % CacheDiscs;
+
+        Solid::OpticalDisc::ContentTypes content;
+        if (!cache->find(discIdentity(disc), &content)) {
+            cache->add(discIdentity(disc), discContent(disc));
+        } else if (content != discContent(disc)) {
+            // A torn read: the key of one disc with the content of another
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void SolidUDisks2Test::benchmarkContentTypesCache_data()
+{
+    QTest::addColumn<int>("processes");
+
+    QTest::newRow("1 process") << 1;
+    QTest::newRow("4 processes") << 4;
+    QTest::newRow("16 processes") << 16;
+}
+
+void SolidUDisks2Test::benchmarkContentTypesCache()
+{
+    QFETCH(int, processes);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ContentTypesCache cache(dir.path() + QStringLiteral("/content"), CacheCapacity);
+    QVERIFY(cache.isShared());
+    for (int disc = 0; disc < CacheCapacity; ++disc) {
+        cache.add(discIdentity(disc), discContent(disc));
+    }
+
+    // The children share the parent's mapping of the file; twice as many discs
+    // as slots keep evictions, and so writers, going the whole time
+    QBENCHMARK {
+        QList<pid_t> children;
+        for (int i = 0; i < processes; ++i) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                _exit(hammerContentTypesCache(&cache, i));
+            }
+            QVERIFY(pid > 0);
+            children << pid;
+        }
+
+        Q_FOREACH (pid_t pid, children) {
+            int status = 0;
+            QCOMPARE(waitpid(pid, &status, 0), pid);
+            QVERIFY(WIFEXITED(status));
+            QCOMPARE(WEXITSTATUS(status), 0);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN_SYSTEM_DBUS(SolidUDisks2Test)
+
+#include "solidudisks2test.moc"
@@ -0,0 +1,292 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "qtest_dbus.h"
+#include "fakeUpower.h"
+#include "fakeUpowerDevice.h"
+#include "fakelogind.h"
+
+#include <QDBusConnection>
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+
+#include <solid/genericinterface.h>
+
+#include "upower.h"
+#include "upowerbattery.h"
+#include "upowerdevice.h"
+#include "upowermanager.h"
+#include "upowersleepmonitor.h"
+
+using namespace Solid::Backends::UPower;
+
+class SolidUPowerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void testPropertyDeltas();
+    void testEnumerationCache();
+    void benchmarkLookups_data();
+    void benchmarkLookups();
+    void testResumeRefresh();
+
+private:
+    FakeUpower *m_fakeUpower;
+    FakeUpowerDevice *m_fakeDevices;
+    FakeLogind *m_fakeLogind;
+    QThread m_fakeThread;
+};
+
+static QVariantMap batteryProperties()
+{
+    QVariantMap properties;
+    properties.insert(QStringLiteral("Type"), 2u);
+    properties.insert(QStringLiteral("IsPresent"), true);
+    properties.insert(QStringLiteral("State"), 2u);
+    properties.insert(QStringLiteral("Percentage"), 80.0);
+    properties.insert(QStringLiteral("EnergyRate"), 10.0);
+    properties.insert(QStringLiteral("TimeToEmpty"), qlonglong(3600));
+    properties.insert(QStringLiteral("TimeToFull"), qlonglong(0));
+    return properties;
+}
+
+void SolidUPowerTest::initTestCase()
+{
+    qRegisterMetaType<QMap<QString, int> >();
+
+    // The fake service answers from its own connection and thread, so every
+    // call made by the backend is a real round-trip through the bus daemon
+    QDBusConnection connection = QDBusConnection::connectToBus(QDBusConnection::SystemBus, QStringLiteral("fakeupower"));
+    QVERIFY(connection.isConnected());
+
+    m_fakeUpower = new FakeUpower(nullptr);
+    m_fakeUpower->moveToThread(&m_fakeThread);
+    m_fakeDevices = new FakeUpowerDevice(QStringLiteral("fakeupower"));
+    m_fakeDevices->moveToThread(&m_fakeThread);
+    m_fakeThread.start();
+
+    QVERIFY(connection.registerObject(QStringLiteral(UP_DBUS_PATH), m_fakeUpower, QDBusConnection::ExportAllContents));
+    QVERIFY(connection.registerVirtualObject(QStringLiteral(UP_DBUS_PATH "/devices"), m_fakeDevices, QDBusConnection::SubPath));
+    QVERIFY(connection.registerService(QStringLiteral(UP_DBUS_SERVICE)));
+
+    m_fakeLogind = new FakeLogind(this);
+    QVERIFY(connection.registerObject(QStringLiteral("/org/freedesktop/login1"), m_fakeLogind, QDBusConnection::ExportAllContents));
+    QVERIFY(connection.registerService(QStringLiteral("org.freedesktop.login1")));
+}
+
+void SolidUPowerTest::cleanupTestCase()
+{
+    QDBusConnection::disconnectFromBus(QStringLiteral("fakeupower"));
+    m_fakeThread.quit();
+    m_fakeThread.wait();
+    delete m_fakeDevices;
+    delete m_fakeUpower;
+}
+
+void SolidUPowerTest::testPropertyDeltas()
+{
+    const QString path = m_fakeDevices->addDevice(QStringLiteral("battery_BAT0"), batteryProperties());
+
+    UPowerDevice device(path);
+    Battery battery(&device);
+    QCOMPARE(battery.chargePercent(), 80);
+    QCOMPARE(m_fakeDevices->callCount(QStringLiteral("GetAll")), 1);
+
+    QSignalSpy changes(&device, SIGNAL(propertyChanged(QMap<QString,int>)));
+    QSignalSpy percent(&battery, SIGNAL(chargePercentChanged(int,QString)));
+    m_fakeDevices->resetCallCount();
+
+    // Merged into the cache as delivered
+    m_fakeDevices->changeProperty(path, QStringLiteral("Percentage"), 79.0);
+    QTRY_COMPARE(percent.count(), 1);
+    QCOMPARE(percent.at(0).at(0).toInt(), 79);
+    QCOMPARE(changes.count(), 1);
+    QCOMPARE(changes.at(0).at(0).value<QMap<QString, int> >(),
+             (QMap<QString, int>{{QStringLiteral("Percentage"), int(Solid::GenericInterface::PropertyModified)}}));
+    QCOMPARE(m_fakeDevices->callCount(), 0);
+    QCOMPARE(device.getAllCallsAvoided(), qulonglong(1));
+
+    // Only what got invalidated is fetched again
+    QSignalSpy timeToEmpty(&battery, SIGNAL(timeToEmptyChanged(qlonglong,QString)));
+    m_fakeDevices->invalidateProperty(path, QStringLiteral("TimeToEmpty"), qlonglong(1800));
+    QTRY_COMPARE(timeToEmpty.count(), 1);
+    QCOMPARE(timeToEmpty.at(0).at(0).toLongLong(), qlonglong(1800));
+    QCOMPARE(m_fakeDevices->callCount(QStringLiteral("GetAll")), 0);
+    QCOMPARE(m_fakeDevices->callCount(QStringLiteral("Get")), 1);
+    QCOMPARE(device.getAllCallsAvoided(), qulonglong(2));
+
+    // A burst of signals merged before the next read saves a single GetAll
+    UPowerDevice other(path);
+    QCOMPARE(other.prop(QStringLiteral("Percentage")).toInt(), 79);
+    QSignalSpy otherChanges(&other, SIGNAL(propertyChanged(QMap<QString,int>)));
+    m_fakeDevices->changeProperty(path, QStringLiteral("Percentage"), 78.0);
+    m_fakeDevices->changeProperty(path, QStringLiteral("Percentage"), 77.0);
+    QTRY_COMPARE(otherChanges.count(), 2);
+    QCOMPARE(other.getAllCallsAvoided(), qulonglong(0));
+    QCOMPARE(other.prop(QStringLiteral("Percentage")).toInt(), 77);
+    QCOMPARE(other.prop(QStringLiteral("Percentage")).toInt(), 77);
+    QCOMPARE(other.getAllCallsAvoided(), qulonglong(1));
+
+    m_fakeDevices->removeDevice(path);
+}
+
+static QString addFakeDevice(FakeUpower *upower, FakeUpowerDevice *devices, const QString &name, uint type)
+{
+    QVariantMap properties = batteryProperties();
+    properties.insert(QStringLiteral("Type"), type);
+
+    const QString path = devices->addDevice(name, properties);
+    upower->addDevice(path);
+    return path;
+}
+
+static void removeFakeDevice(FakeUpower *upower, FakeUpowerDevice *devices, const QString &path)
+{
+    upower->removeDevice(path);
+    devices->removeDevice(path);
+}
+
+void SolidUPowerTest::testEnumerationCache()
+{
+    const QString battery = addFakeDevice(m_fakeUpower, m_fakeDevices, QStringLiteral("cache_battery"), 2);
+    const QString mouse = addFakeDevice(m_fakeUpower, m_fakeDevices, QStringLiteral("cache_mouse"), 5);
+    const QString ac = addFakeDevice(m_fakeUpower, m_fakeDevices, QStringLiteral("cache_line_power"), 1);
+
+    UPowerManager manager(nullptr);
+    const int enumerations = m_fakeUpower->enumerateCalls();
+    m_fakeDevices->resetCallCount();
+
+    QCOMPARE(manager.allDevices(), QStringList() << QStringLiteral(UP_UDI_PREFIX) << battery << mouse << ac);
+    QCOMPARE(manager.devicesFromQuery(QString(), Solid::DeviceInterface::Battery), QStringList() << battery << mouse);
+    QScopedPointer<QObject> device(manager.createDevice(mouse));
+    QVERIFY(device);
+    QVERIFY(qobject_cast<UPowerDevice *>(device.data())->queryDeviceInterface(Solid::DeviceInterface::Battery));
+    QVERIFY(!manager.createDevice(QStringLiteral(UP_DBUS_PATH "/devices/unknown")));
+
+    // One enumeration, and the type of each device asked for once
+    QCOMPARE(m_fakeUpower->enumerateCalls() - enumerations, 1);
+    QCOMPARE(m_fakeDevices->callCount(QStringLiteral("Get")), 3);
+    QCOMPARE(m_fakeDevices->callCount(), 3);
+
+    // Kept current from the signals
+    QSignalSpy added(&manager, SIGNAL(deviceAdded(QString)));
+    QSignalSpy removed(&manager, SIGNAL(deviceRemoved(QString)));
+    const QString ups = addFakeDevice(m_fakeUpower, m_fakeDevices, QStringLiteral("cache_ups"), 3);
+    QTRY_COMPARE(added.count(), 1);
+    QCOMPARE(manager.devicesFromQuery(QString(), Solid::DeviceInterface::Battery), QStringList() << battery << mouse << ups);
+
+    removeFakeDevice(m_fakeUpower, m_fakeDevices, mouse);
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(manager.devicesFromQuery(QString(), Solid::DeviceInterface::Battery), QStringList() << battery << ups);
+    QVERIFY(!manager.createDevice(mouse));
+    QCOMPARE(m_fakeUpower->enumerateCalls() - enumerations, 1);
+
+    removeFakeDevice(m_fakeUpower, m_fakeDevices, battery);
+    removeFakeDevice(m_fakeUpower, m_fakeDevices, ac);
+    removeFakeDevice(m_fakeUpower, m_fakeDevices, ups);
+    QTRY_COMPARE(removed.count(), 4);
+}
+
+void SolidUPowerTest::benchmarkLookups_data()
+{
+    QTest::addColumn<int>("lookups");
+
+    QTest::newRow("10 lookups") << 10;
+    QTest::newRow("100 lookups") << 100;
+    QTest::newRow("1000 lookups") << 1000;
+}
+
+void SolidUPowerTest::benchmarkLookups()
+{
+    QFETCH(int, lookups);
+
+    QStringList udis;
+    for (int i = 0; i < 10; ++i) {
+        udis << addFakeDevice(m_fakeUpower, m_fakeDevices, QStringLiteral("lookup_%1").arg(i), i % 2 ? 2 : 1);
+    }
+
+    UPowerManager manager(nullptr);
+    const int enumerations = m_fakeUpower->enumerateCalls();
+    m_fakeDevices->resetCallCount();
+
+    QBENCHMARK {
+        for (int i = 0; i < lookups; ++i) {
+            delete manager.createDevice(udis.at(i % udis.count()));
+            QCOMPARE(manager.devicesFromQuery(QString(), Solid::DeviceInterface::Battery).count(), 5);
+        }
+    }
+
+    // The same traffic however many lookups are made
+    QCOMPARE(m_fakeUpower->enumerateCalls() - enumerations, 1);
+    QCOMPARE(m_fakeDevices->callCount(), udis.count());
+
+    Q_FOREACH (const QString &udi, udis) {
+        removeFakeDevice(m_fakeUpower, m_fakeDevices, udi);
+        UPowerDevice::forgetCachedType(udi);
+    }
+}
+
+void SolidUPowerTest::testResumeRefresh()
+{
+    const QString bat0 = m_fakeDevices->addDevice(QStringLiteral("resume_BAT0"), batteryProperties());
+    const QString bat1 = m_fakeDevices->addDevice(QStringLiteral("resume_BAT1"), batteryProperties());
+
+    // Two wrappers for the same object, as Device(udi) and devicesFromQuery() leave around
+    UPowerDevice first(bat0);
+    UPowerDevice second(bat0);
+    UPowerDevice other(bat1);
+    QCOMPARE(first.prop(QStringLiteral("Percentage")).toInt(), 80);
+    QCOMPARE(second.prop(QStringLiteral("Percentage")).toInt(), 80);
+    QCOMPARE(other.prop(QStringLiteral("Percentage")).toInt(), 80);
+
+    UPowerSleepMonitor *monitor = UPowerSleepMonitor::instance();
+    const qulonglong refreshCalls = monitor->refreshCalls();
+    QSignalSpy refreshed(monitor, SIGNAL(refreshed()));
+    QSignalSpy firstChanged(&first, SIGNAL(changed()));
+    QSignalSpy secondChanged(&second, SIGNAL(changed()));
+    QSignalSpy otherChanged(&other, SIGNAL(changed()));
+    m_fakeDevices->resetCallCount();
+
+    // Going to sleep does not touch anything
+    emit m_fakeLogind->PrepareForSleep(true);
+    emit m_fakeLogind->PrepareForSleep(false);
+
+    // One Refresh per object, then every cache dropped in the same pass
+    QTRY_COMPARE(refreshed.count(), 1);
+    QCOMPARE(m_fakeDevices->callCount(QStringLiteral("Refresh")), 2);
+    QCOMPARE(m_fakeDevices->callCount(), 2);
+    QCOMPARE(monitor->refreshCalls() - refreshCalls, qulonglong(2));
+    QCOMPARE(firstChanged.count(), 1);
+    QCOMPARE(secondChanged.count(), 1);
+    QCOMPARE(otherChanged.count(), 1);
+
+    QCOMPARE(first.prop(QStringLiteral("Percentage")).toInt(), 80);
+    QCOMPARE(m_fakeDevices->callCount(QStringLiteral("GetAll")), 1);
+
+    m_fakeDevices->removeDevice(bat0);
+    m_fakeDevices->removeDevice(bat1);
+}
+
+QTEST_GUILESS_MAIN_SYSTEM_DBUS(SolidUPowerTest)
+
+#include "solidupowertest.moc"
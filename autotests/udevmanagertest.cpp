@@ -0,0 +1,203 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtTest/QtTest>
+
+#include "udevmanager.h"
+#include "../shared/udevqt.h"
+#include "../shared/udevqt_p.h"
+
+using namespace Solid::Backends::UDev;
+
+class UDevManagerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEnumerateBySubsystems();
+    void testAllDevices();
+    void testInterestCache();
+    void testEventBatch();
+    void benchmarkEnumeration_data();
+    void benchmarkEnumeration();
+};
+
+// What UDevManager watches
+static QStringList watchedSubsystems()
+{
+    return QStringList() << "processor" << "cpu" << "sound" << "tty" << "dvb" << "net" << "usb" << "input";
+}
+
+static QStringList sysfsPaths(const UdevQt::DeviceList &devices)
+{
+    QStringList paths;
+    Q_FOREACH (const UdevQt::Device &device, devices) {
+        paths << device.sysfsPath();
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+void UDevManagerTest::testEnumerateBySubsystems()
+{
+    UdevQt::Client client;
+    const UdevQt::DeviceList all = client.allDevices();
+    if (all.isEmpty()) {
+        QSKIP("No sysfs devices to enumerate");
+    }
+
+    const QStringList subsystems = watchedSubsystems();
+    UdevQt::DeviceList expected;
+    UdevQt::DeviceList expectedUsbDevices;
+    Q_FOREACH (const UdevQt::Device &device, all) {
+        if (subsystems.contains(device.subsystem())) {
+            expected << device;
+        }
+        if (device.subsystem() == QLatin1String("usb") && device.devType() == QLatin1String("usb_device")) {
+            expectedUsbDevices << device;
+        }
+    }
+
+    QCOMPARE(sysfsPaths(client.devicesBySubsystems(subsystems)), sysfsPaths(expected));
+    QCOMPARE(sysfsPaths(client.devicesBySubsystems(QStringList() << "usb/usb_device")), sysfsPaths(expectedUsbDevices));
+    QCOMPARE(sysfsPaths(client.devicesBySubsystems(QStringList())), sysfsPaths(all));
+}
+
+void UDevManagerTest::testAllDevices()
+{
+    UDevManager manager(nullptr);
+    QCOMPARE(manager.enumerationTime(), qint64(-1));
+
+    const QStringList devices = manager.allDevices();
+    QVERIFY(manager.enumerationTime() >= 0);
+    QVERIFY(manager.enumeratedDevices() >= devices.size());
+    QVERIFY(manager.enumeratedDevices() <= UdevQt::Client().allDevices().size());
+
+    const QStringList subsystems = watchedSubsystems();
+    UdevQt::Client client;
+    Q_FOREACH (const QString &udi, devices) {
+        const UdevQt::Device device = client.deviceBySysfsPath(udi.mid(manager.udiPrefix().size()));
+        QVERIFY2(subsystems.contains(device.subsystem()), qPrintable(udi));
+    }
+
+    // Served from the cache afterwards
+    const int enumerated = manager.enumeratedDevices();
+    QCOMPARE(manager.allDevices(), devices);
+    QCOMPARE(manager.devicesFromQuery(QString(), Solid::DeviceInterface::Unknown), devices);
+    QCOMPARE(manager.enumeratedDevices(), enumerated);
+}
+
+void UDevManagerTest::testInterestCache()
+{
+    UDevManager manager(nullptr);
+    const QStringList devices = manager.allDevices();
+    QCOMPARE(manager.sysfsStatsAvoided(), qulonglong(0));
+
+    int cpus = 0;
+    Q_FOREACH (const QString &udi, devices) {
+        QScopedPointer<QObject> device(manager.createDevice(udi));
+        QVERIFY2(device, qPrintable(udi));
+        if (udi.startsWith(manager.udiPrefix() + "/devices/system/cpu/")) {
+            ++cpus;
+        }
+    }
+
+    // Each processor costs at least one stat of its sysfs directory
+    // the first time, and none after that
+    QVERIFY(manager.sysfsStatsAvoided() >= qulonglong(cpus));
+}
+
+static QString batchToString(const UdevQt::EventBatch &batch, const UdevQt::Device &a)
+{
+    QStringList events;
+    Q_FOREACH (const UdevQt::EventBatch::Event &event, batch.events()) {
+        events << QString::fromLatin1(event.action) + (event.device.sysfsPath() == a.sysfsPath() ? ":a" : ":b");
+    }
+    return events.join(' ');
+}
+
+void UDevManagerTest::testEventBatch()
+{
+    UdevQt::Client client;
+    const UdevQt::DeviceList devices = client.allDevices();
+    if (devices.size() < 2) {
+        QSKIP("Not enough sysfs devices to replay events with");
+    }
+    const UdevQt::Device a = devices.at(0);
+    const UdevQt::Device b = devices.at(1);
+
+    {
+        UdevQt::EventBatch batch;
+        batch.append("add", a);
+        batch.append("change", a);
+        batch.append("add", b);
+        batch.append("change", a);
+        QCOMPARE(batchToString(batch, a), QString("add:a add:b"));
+        QCOMPARE(batch.received(), 4);
+    }
+    {
+        UdevQt::EventBatch batch;
+        batch.append("add", a);
+        batch.append("change", b);
+        batch.append("remove", a);
+        QCOMPARE(batchToString(batch, a), QString("change:b"));
+    }
+    {
+        UdevQt::EventBatch batch;
+        batch.append("change", a);
+        batch.append("change", b);
+        batch.append("change", a);
+        batch.append("remove", b);
+        QCOMPARE(batchToString(batch, a), QString("change:a remove:b"));
+    }
+    {
+        // A replug stays a removal followed by an addition
+        UdevQt::EventBatch batch;
+        batch.append("change", a);
+        batch.append("remove", a);
+        batch.append("add", a);
+        batch.append("change", a);
+        batch.append("online", b);
+        QCOMPARE(batchToString(batch, a), QString("remove:a add:a online:b"));
+    }
+}
+
+void UDevManagerTest::benchmarkEnumeration_data()
+{
+    QTest::addColumn<bool>("filtered");
+
+    QTest::newRow("all of sysfs") << false;
+    QTest::newRow("watched subsystems") << true;
+}
+
+void UDevManagerTest::benchmarkEnumeration()
+{
+    QFETCH(bool, filtered);
+
+    UdevQt::Client client;
+    const QStringList subsystems = watchedSubsystems();
+    QBENCHMARK {
+        const UdevQt::DeviceList devices = filtered ? client.devicesBySubsystems(subsystems) : client.allDevices();
+        Q_UNUSED(devices);
+    }
+}
+
+QTEST_GUILESS_MAIN(UDevManagerTest)
+
+#include "udevmanagertest.moc"
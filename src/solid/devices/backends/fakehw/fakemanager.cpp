@@ -20,6 +20,7 @@
 #include "fakemanager.h"
 
 #include "fakedevice.h"
+#include "../shared/devicecatalog.h"
 
 // Qt includes
 #include <QtXml/QDomDocument>
@@ -40,6 +41,7 @@ public:
     QMap<QString, QMap<QString, QVariant> > hiddenDevices;
     QString xmlFile;
     QSet<Solid::DeviceInterface::Type> supportedInterfaces;
+    Solid::Backends::Shared::DeviceCatalog catalog;
 };
 
 FakeManager::FakeManager(QObject *parent, const QString &xmlFile)
@@ -50,8 +52,6 @@ FakeManager::FakeManager(QObject *parent, const QString &xmlFile)
 
     QDBusConnection::sessionBus().registerObject("/org/kde/solid/fakehw", this, QDBusConnection::ExportNonScriptableSlots);
 
-    parseMachineFile();
-
     d->supportedInterfaces << Solid::DeviceInterface::GenericInterface
                            << Solid::DeviceInterface::Processor
                            << Solid::DeviceInterface::Block
@@ -64,6 +64,8 @@ FakeManager::FakeManager(QObject *parent, const QString &xmlFile)
                            << Solid::DeviceInterface::PortableMediaPlayer
                            << Solid::DeviceInterface::Battery
                            << Solid::DeviceInterface::NetworkShare;
+
+    parseMachineFile();
 }
 
 FakeManager::~FakeManager()
@@ -96,32 +98,7 @@ QStringList FakeManager::allDevices()
 
 QStringList FakeManager::devicesFromQuery(const QString &parentUdi, Solid::DeviceInterface::Type type)
 {
-    if (!parentUdi.isEmpty()) {
-        QStringList found = findDeviceStringMatch(QLatin1String("parent"), parentUdi);
-
-        if (type == Solid::DeviceInterface::Unknown) {
-            return found;
-        }
-
-        QStringList result;
-
-        QStringList::ConstIterator it = found.constBegin();
-        QStringList::ConstIterator end = found.constEnd();
-
-        for (; it != end; ++it) {
-            FakeDevice *device = d->loadedDevices[*it];
-
-            if (device->queryDeviceInterface(type)) {
-                result << *it;
-            }
-        }
-
-        return result;
-    } else if (type != Solid::DeviceInterface::Unknown) {
-        return findDeviceByDeviceInterface(type);
-    } else {
-        return allDevices();
-    }
+    return d->catalog.devices(parentUdi, type);
 }
 
 QObject *FakeManager::createDevice(const QString &udi)
@@ -138,37 +115,13 @@ FakeDevice *FakeManager::findDevice(const QString &udi)
     return d->loadedDevices.value(udi);
 }
 
-QStringList FakeManager::findDeviceStringMatch(const QString &key, const QString &value)
-{
-    QStringList result;
-    FakeDevice *device;
-    Q_FOREACH (device, d->loadedDevices) {
-        if (device->property(key).toString() == value) {
-            result.append(device->udi());
-        }
-    }
-
-    return result;
-}
-
-QStringList FakeManager::findDeviceByDeviceInterface(Solid::DeviceInterface::Type type)
-{
-    QStringList result;
-    FakeDevice *device;
-    Q_FOREACH (device, d->loadedDevices) {
-        if (device->queryDeviceInterface(type)) {
-            result.append(device->udi());
-        }
-    }
-
-    return result;
-}
-
 void FakeManager::plug(const QString &udi)
 {
     if (d->hiddenDevices.contains(udi)) {
         QMap<QString, QVariant> properties = d->hiddenDevices.take(udi);
-        d->loadedDevices[udi] = new FakeDevice(udi, properties);
+        FakeDevice *device = new FakeDevice(udi, properties);
+        d->loadedDevices[udi] = device;
+        d->catalog.insert(*device, d->supportedInterfaces);
         emit deviceAdded(udi);
     }
 }
@@ -178,6 +131,7 @@ void FakeManager::unplug(const QString &udi)
     if (d->loadedDevices.contains(udi)) {
         FakeDevice *dev = d->loadedDevices.take(udi);
         d->hiddenDevices[udi] = dev->allProperties();
+        d->catalog.remove(udi);
         emit deviceRemoved(udi);
         delete dev;
     }
@@ -209,6 +163,7 @@ void FakeManager::parseMachineFile()
             if (tempDevice) {
                 Q_ASSERT(!d->loadedDevices.contains(tempDevice->udi()));
                 d->loadedDevices.insert(tempDevice->udi(), tempDevice);
+                d->catalog.insert(*tempDevice, d->supportedInterfaces);
                 emit deviceAdded(tempDevice->udi());
             }
         }
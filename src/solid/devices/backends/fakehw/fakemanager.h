@@ -78,9 +78,6 @@ private Q_SLOTS:
     FakeDevice *parseDeviceElement(const QDomElement &element);
 
 private:
-    QStringList findDeviceStringMatch(const QString &key, const QString &value);
-    QStringList findDeviceByDeviceInterface(Solid::DeviceInterface::Type type);
-
     class Private;
     Private *d;
 };
@@ -120,3 +120,8 @@ qulonglong FakeOpticalDisc::capacity() const
     return fakeDevice()->property("capacity").toULongLong();
 }
 
+bool FakeOpticalDisc::isContentProbePending() const
+{
+    return false;
+}
+
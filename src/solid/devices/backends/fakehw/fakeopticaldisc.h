@@ -46,6 +46,10 @@ public Q_SLOTS:
     bool isBlank() const Q_DECL_OVERRIDE;
     bool isRewritable() const Q_DECL_OVERRIDE;
     qulonglong capacity() const Q_DECL_OVERRIDE;
+    bool isContentProbePending() const Q_DECL_OVERRIDE;
+
+Q_SIGNALS:
+    void availableContentChanged(Solid::OpticalDisc::ContentTypes content, const QString &udi) Q_DECL_OVERRIDE;
 };
 }
 }
@@ -71,6 +71,38 @@ Solid::Processor::InstructionSets FakeProcessor::instructionSets() const
             result |= Solid::Processor::Amd3DNow;
         } else if (extension_str == "altivec") {
             result |= Solid::Processor::AltiVec;
+        } else if (extension_str == "avx") {
+            result |= Solid::Processor::IntelAvx;
+        } else if (extension_str == "avx2") {
+            result |= Solid::Processor::IntelAvx2;
+        } else if (extension_str == "fma3") {
+            result |= Solid::Processor::IntelFma3;
+        } else if (extension_str == "avx512f") {
+            result |= Solid::Processor::IntelAvx512F;
+        } else if (extension_str == "avx512cd") {
+            result |= Solid::Processor::IntelAvx512Cd;
+        } else if (extension_str == "avx512bw") {
+            result |= Solid::Processor::IntelAvx512Bw;
+        } else if (extension_str == "avx512dq") {
+            result |= Solid::Processor::IntelAvx512Dq;
+        } else if (extension_str == "avx512vl") {
+            result |= Solid::Processor::IntelAvx512Vl;
+        } else if (extension_str == "bmi1") {
+            result |= Solid::Processor::IntelBmi1;
+        } else if (extension_str == "bmi2") {
+            result |= Solid::Processor::IntelBmi2;
+        } else if (extension_str == "aes") {
+            result |= Solid::Processor::IntelAes;
+        } else if (extension_str == "sha") {
+            result |= Solid::Processor::IntelSha;
+        } else if (extension_str == "vaes") {
+            result |= Solid::Processor::IntelVaes;
+        } else if (extension_str == "vpclmulqdq") {
+            result |= Solid::Processor::IntelVpclmulqdq;
+        } else if (extension_str == "neon") {
+            result |= Solid::Processor::ArmNeon;
+        } else if (extension_str == "sve") {
+            result |= Solid::Processor::ArmSve;
         }
     }
 
@@ -78,3 +110,136 @@ Solid::Processor::InstructionSets FakeProcessor::instructionSets() const
 
 }
 
+static int topologyId(const FakeDevice *device, const QString &key)
+{
+    bool ok = false;
+    const int id = device->property(key).toInt(&ok);
+    return ok ? id : -1;
+}
+
+int FakeProcessor::packageId() const
+{
+    return topologyId(fakeDevice(), "packageId");
+}
+
+int FakeProcessor::dieId() const
+{
+    return topologyId(fakeDevice(), "dieId");
+}
+
+int FakeProcessor::coreId() const
+{
+    return topologyId(fakeDevice(), "coreId");
+}
+
+int FakeProcessor::numaNode() const
+{
+    return topologyId(fakeDevice(), "numaNode");
+}
+
+QList<int> FakeProcessor::siblings() const
+{
+    QList<int> result;
+
+    const QString str = fakeDevice()->property("siblings").toString();
+
+    Q_FOREACH (const QString &sibling_str, str.split(',', QString::SkipEmptyParts)) {
+        result << sibling_str.toInt();
+    }
+
+    return result;
+}
+
+static QList<int> parseCpuList(const QString &str)
+{
+    QList<int> result;
+
+    Q_FOREACH (const QString &range, str.split(',', QString::SkipEmptyParts)) {
+        const QStringList bounds = range.split('-');
+        const int first = bounds.first().toInt();
+        const int last = bounds.last().toInt();
+        for (int cpu = first; cpu <= last; ++cpu) {
+            result << cpu;
+        }
+    }
+
+    return result;
+}
+
+QList<Solid::Processor::Cache> FakeProcessor::caches() const
+{
+    QList<Solid::Processor::Cache> result;
+
+    // "L1d 32K 64 8 0-1; L2 256K 64 4 0-1": level and type, size, line size,
+    // ways and the processors sharing it
+    const QString str = fakeDevice()->property("caches").toString();
+
+    Q_FOREACH (const QString &cache_str, str.split(';', QString::SkipEmptyParts)) {
+        const QStringList fields = cache_str.split(' ', QString::SkipEmptyParts);
+        if (fields.size() != 5 || !fields.at(0).startsWith('L')) {
+            continue;
+        }
+
+        Solid::Processor::Cache cache;
+        QString level_str = fields.at(0).mid(1);
+        if (level_str.endsWith('d')) {
+            cache.type = Solid::Processor::DataCache;
+            level_str.chop(1);
+        } else if (level_str.endsWith('i')) {
+            cache.type = Solid::Processor::InstructionCache;
+            level_str.chop(1);
+        } else {
+            cache.type = Solid::Processor::UnifiedCache;
+        }
+        cache.level = level_str.toInt();
+
+        QString size_str = fields.at(1);
+        qulonglong unit = 1;
+        if (size_str.endsWith('K')) {
+            unit = Q_UINT64_C(1) << 10;
+        } else if (size_str.endsWith('M')) {
+            unit = Q_UINT64_C(1) << 20;
+        }
+        if (unit != 1) {
+            size_str.chop(1);
+        }
+        cache.size = size_str.toULongLong() * unit;
+        cache.lineSize = fields.at(2).toInt();
+        cache.associativity = fields.at(3).toInt();
+        cache.sharedWith = parseCpuList(fields.at(4));
+
+        result << cache;
+    }
+
+    return result;
+}
+
+Solid::Processor::CoreClass FakeProcessor::coreClass() const
+{
+    const QString str = fakeDevice()->property("coreClass").toString();
+
+    if (str == "performance") {
+        return Solid::Processor::PerformanceCore;
+    } else if (str == "efficiency") {
+        return Solid::Processor::EfficiencyCore;
+    }
+    return Solid::Processor::UnknownCore;
+}
+
+int FakeProcessor::capacity() const
+{
+    return topologyId(fakeDevice(), "capacity");
+}
+
+bool FakeProcessor::isUsable() const
+{
+    const QVariant usable = fakeDevice()->property("usable");
+    return !usable.isValid() || usable.toBool();
+}
+
+qreal FakeProcessor::cpuQuota() const
+{
+    bool ok = false;
+    const qreal quota = fakeDevice()->property("cpuQuota").toDouble(&ok);
+    return ok ? quota : -1;
+}
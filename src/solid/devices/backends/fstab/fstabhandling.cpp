@@ -31,6 +31,7 @@
 
 #include "solid/config-solid.h"
 #include <stdlib.h>
+#include <string.h>
 
 #if HAVE_SYS_MNTTAB_H
 #include <sys/mnttab.h>
@@ -107,21 +108,182 @@ Q_GLOBAL_STATIC(Solid::Backends::Fstab::FstabHandling, globalFstabCache)
 
 Solid::Backends::Fstab::FstabHandling::FstabHandling()
     : m_fstabCacheValid(false),
-      m_mtabCacheValid(false)
+      m_mtabCacheValid(false),
+      m_mtabCacheRead(false)
 { }
 
+static const char *const networkFileSystems[] = { "nfs", "nfs4", "smbfs", "cifs" };
+
+static bool isNetworkFileSystemType(const char *type, int length)
+{
+    for (size_t i = 0; i < sizeof(networkFileSystems) / sizeof(*networkFileSystems); ++i) {
+        if (qstrlen(networkFileSystems[i]) == uint(length) && qstrncmp(type, networkFileSystems[i], length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool _k_isFstabNetworkFileSystem(const QString &fstype, const QString &devName)
 {
-    if (fstype == "nfs"
-            || fstype == "nfs4"
-            || fstype == "smbfs"
-            || fstype == "cifs"
+    const QByteArray type = fstype.toLatin1();
+    if (isNetworkFileSystemType(type.constData(), type.size())
             || devName.startsWith(QLatin1String("//"))) {
         return true;
     }
     return false;
 }
 
+bool Solid::Backends::Fstab::MountInfo::Mount::operator==(const Mount &other) const
+{
+    return device == other.device && mountPoint == other.mountPoint;
+}
+
+static const char *nextField(const char *field, const char *end)
+{
+    const char *space = static_cast<const char *>(memchr(field, ' ', end - field));
+    return space ? space + 1 : end;
+}
+
+static const char *fieldEnd(const char *field, const char *end)
+{
+    const char *space = static_cast<const char *>(memchr(field, ' ', end - field));
+    return space ? space : end;
+}
+
+// Space, tab, newline and backslash come as \ooo in mountinfo
+static QString decodeMountInfoField(const char *begin, const char *end)
+{
+    QByteArray field;
+    field.reserve(end - begin);
+    for (const char *c = begin; c < end; ++c) {
+        if (*c == '\\' && end - c >= 4
+                && c[1] >= '0' && c[1] <= '3' && c[2] >= '0' && c[2] <= '7' && c[3] >= '0' && c[3] <= '7') {
+            field += char((c[1] - '0') * 64 + (c[2] - '0') * 8 + (c[3] - '0'));
+            c += 3;
+        } else {
+            field += *c;
+        }
+    }
+    return QFile::decodeName(field);
+}
+
+// 36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - nfs server:/export rw,vers=4
+// Only network file systems get their fields decoded
+static bool parseMountInfoLine(const char *line, const char *end, int *id, Solid::Backends::Fstab::MountInfo::Mount *mount)
+{
+    *id = 0;
+    const char *c = line;
+    for (; c < end && *c >= '0' && *c <= '9'; ++c) {
+        *id = *id * 10 + (*c - '0');
+    }
+    if (c == line || c == end) {
+        return false;
+    }
+
+    // ID, parent ID, major:minor, root, then the mount point
+    const char *mountPoint = line;
+    for (int i = 0; i < 4; ++i) {
+        mountPoint = nextField(mountPoint, end);
+    }
+    if (mountPoint == end) {
+        return false;
+    }
+    const char *mountPointEnd = fieldEnd(mountPoint, end);
+
+    // Optional fields up to a lone dash, then the type and the source
+    const char *field = nextField(mountPoint, end);
+    while (field < end) {
+        const char *next = fieldEnd(field, end);
+        if (next - field == 1 && *field == '-') {
+            break;
+        }
+        field = nextField(field, end);
+    }
+    if (field == end) {
+        return false;
+    }
+
+    const char *type = nextField(field, end);
+    const char *typeEnd = fieldEnd(type, end);
+    if (!isNetworkFileSystemType(type, typeEnd - type)) {
+        return false;
+    }
+
+    const char *source = nextField(type, end);
+    mount->device = decodeMountInfoField(source, fieldEnd(source, end));
+    mount->mountPoint = decodeMountInfoField(mountPoint, mountPointEnd);
+    return true;
+}
+
+QSet<QString> Solid::Backends::Fstab::MountInfo::update(const QByteArray &contents)
+{
+    QHash<int, Mount> mounts;
+
+    const char *line = contents.constData();
+    const char *end = line + contents.size();
+    while (line < end) {
+        const char *newline = static_cast<const char *>(memchr(line, '\n', end - line));
+        const char *lineEnd = newline ? newline : end;
+
+        int id;
+        Mount mount;
+        if (parseMountInfoLine(line, lineEnd, &id, &mount)) {
+            mounts.insert(id, mount);
+        }
+        line = lineEnd + 1;
+    }
+
+    QSet<QString> changed;
+    for (QHash<int, Mount>::const_iterator it = mounts.constBegin(); it != mounts.constEnd(); ++it) {
+        QHash<int, Mount>::const_iterator previous = m_mounts.constFind(it.key());
+        if (previous == m_mounts.constEnd()) {
+            changed.insert(it->device);
+        } else if (!(*previous == *it)) {
+            changed.insert(previous->device);
+            changed.insert(it->device);
+        }
+    }
+    for (QHash<int, Mount>::const_iterator it = m_mounts.constBegin(); it != m_mounts.constEnd(); ++it) {
+        if (!mounts.contains(it.key())) {
+            changed.insert(it->device);
+        }
+    }
+
+    m_mounts = mounts;
+    return changed;
+}
+
+QHash<int, Solid::Backends::Fstab::MountInfo::Mount> Solid::Backends::Fstab::MountInfo::mounts() const
+{
+    return m_mounts;
+}
+
+QMultiHash<QString, QString> Solid::Backends::Fstab::MountInfo::mountPoints() const
+{
+    QMultiHash<QString, QString> mountPoints;
+    Q_FOREACH (const Mount &mount, m_mounts) {
+        mountPoints.insert(mount.device, mount.mountPoint);
+    }
+    return mountPoints;
+}
+
+static QSet<QString> changedDevices(const QMultiHash<QString, QString> &before, const QMultiHash<QString, QString> &after)
+{
+    QSet<QString> changed;
+    Q_FOREACH (const QString &device, before.uniqueKeys()) {
+        if (before.values(device).toSet() != after.values(device).toSet()) {
+            changed.insert(device);
+        }
+    }
+    Q_FOREACH (const QString &device, after.uniqueKeys()) {
+        if (!before.contains(device)) {
+            changed.insert(device);
+        }
+    }
+    return changed;
+}
+
 void Solid::Backends::Fstab::FstabHandling::_k_updateFstabMountPointsCache()
 {
     if (globalFstabCache->m_fstabCacheValid) {
@@ -249,6 +411,25 @@ void Solid::Backends::Fstab::FstabHandling::_k_updateMtabMountPointsCache()
         return;
     }
 
+    // Reading the table for the first time is not a change
+    const bool recordChanges = globalFstabCache->m_mtabCacheRead;
+    globalFstabCache->m_mtabCacheRead = true;
+
+#ifdef Q_OS_LINUX
+    // The kernel's own table tells a remount from a mount left alone, mtab does not
+    QFile mountInfo(QStringLiteral("/proc/self/mountinfo"));
+    if (mountInfo.open(QIODevice::ReadOnly)) {
+        const QSet<QString> changed = globalFstabCache->m_mountInfo.update(mountInfo.readAll());
+        if (recordChanges) {
+            globalFstabCache->m_mtabChanges += changed;
+        }
+        globalFstabCache->m_mtabCache = globalFstabCache->m_mountInfo.mountPoints();
+        globalFstabCache->m_mtabCacheValid = true;
+        return;
+    }
+#endif
+
+    const QStringMultiHash previous = globalFstabCache->m_mtabCache;
     globalFstabCache->m_mtabCache.clear();
 
 #if HAVE_GETMNTINFO
@@ -349,6 +530,9 @@ void Solid::Backends::Fstab::FstabHandling::_k_updateMtabMountPointsCache()
     ENDMNTENT(mnttab);
 #endif
 
+    if (recordChanges) {
+        globalFstabCache->m_mtabChanges += changedDevices(previous, globalFstabCache->m_mtabCache);
+    }
     globalFstabCache->m_mtabCacheValid = true;
 }
 
@@ -363,6 +547,16 @@ void Solid::Backends::Fstab::FstabHandling::flushMtabCache()
     globalFstabCache->m_mtabCacheValid = false;
 }
 
+QSet<QString> Solid::Backends::Fstab::FstabHandling::updateMtabCache()
+{
+    globalFstabCache->m_mtabCacheValid = false;
+    _k_updateMtabMountPointsCache();
+
+    QSet<QString> changed;
+    changed.swap(globalFstabCache->m_mtabChanges);
+    return changed;
+}
+
 void Solid::Backends::Fstab::FstabHandling::flushFstabCache()
 {
     globalFstabCache->m_fstabCacheValid = false;
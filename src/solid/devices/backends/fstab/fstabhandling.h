@@ -23,7 +23,9 @@
 #define SOLID_BACKENDS_FSTAB_FSTABHANDLING_H
 
 #include <QtCore/QString>
+#include <QtCore/QHash>
 #include <QtCore/QMultiHash>
+#include <QtCore/QSet>
 
 class QProcess;
 class QObject;
@@ -35,6 +37,35 @@ namespace Backends
 namespace Fstab
 {
 
+/**
+ * The network file systems listed in a /proc/self/mountinfo, kept from one
+ * read of the file to the next by mount ID.
+ */
+class MountInfo
+{
+public:
+    struct Mount {
+        QString device;
+        QString mountPoint;
+
+        bool operator==(const Mount &other) const;
+    };
+
+    /**
+     * Replaces the snapshot with the mounts listed in contents.
+     *
+     * @return the devices that got mounted, unmounted or moved since the
+     * previous snapshot, a device mounted again counting as changed
+     */
+    QSet<QString> update(const QByteArray &contents);
+
+    QHash<int, Mount> mounts() const;
+    QMultiHash<QString, QString> mountPoints() const;
+
+private:
+    QHash<int, Mount> m_mounts;
+};
+
 class FstabHandling
 {
 public:
@@ -52,6 +83,13 @@ public:
     static void flushMtabCache();
     static void flushFstabCache();
 
+    /**
+     * Reads the mount table again.
+     *
+     * @return the devices whose mount points changed since the last read
+     */
+    static QSet<QString> updateMtabCache();
+
 private:
     static void _k_updateMtabMountPointsCache();
     static void _k_updateFstabMountPointsCache();
@@ -60,8 +98,11 @@ private:
 
     QStringMultiHash m_mtabCache;
     QStringMultiHash m_fstabCache;
+    MountInfo m_mountInfo;
+    QSet<QString> m_mtabChanges;
     bool m_fstabCacheValid;
     bool m_mtabCacheValid;
+    bool m_mtabCacheRead;
 
 };
 
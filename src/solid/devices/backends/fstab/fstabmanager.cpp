@@ -117,6 +117,9 @@ void FstabManager::_k_updateDeviceList()
     QSet<QString> newlist = deviceList.toSet();
     QSet<QString> oldlist = m_deviceList.toSet();
 
+    // Updated first, receivers of deviceAdded() call createDevice() which looks it up
+    m_deviceList = deviceList;
+
     Q_FOREACH (const QString &device, newlist) {
         if (!oldlist.contains(device)) {
             emit deviceAdded(udiPrefix() + "/" + device);
@@ -128,25 +131,23 @@ void FstabManager::_k_updateDeviceList()
             emit deviceRemoved(udiPrefix() + "/" + device);
         }
     }
-
-    m_deviceList = deviceList;
-
-    Q_FOREACH (const QString &device, newlist) {
-        if (!oldlist.contains(device)) {
-            emit deviceAdded(udiPrefix() + "/" + device);
-        }
-    }
 }
 
 void FstabManager::onMtabChanged()
 {
-    FstabHandling::flushMtabCache();
+    // Bind mounts and the like change the table all the time, only network shares matter here
+    const QSet<QString> changed = FstabHandling::updateMtabCache();
+    if (changed.isEmpty()) {
+        return;
+    }
 
     _k_updateDeviceList(); // devicelist is union of mtab and fstab
 
-    Q_FOREACH (const QString &device, m_deviceList) {
+    Q_FOREACH (const QString &device, changed) {
         // notify storageaccess objects via device ...
-        emit mtabChanged(device);
+        if (m_deviceList.contains(device)) {
+            emit mtabChanged(device);
+        }
     }
 }
 
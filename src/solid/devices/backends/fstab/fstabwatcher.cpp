@@ -26,34 +26,56 @@
 #include <QtCore/QSocketNotifier>
 #include <QtCore/QFile>
 #include <QtCore/QStringList>
+#include <QtCore/QTimer>
 
 using namespace Solid::Backends::Fstab;
 
 Q_GLOBAL_STATIC(FstabWatcher, globalFstabWatcher)
 
 #define MTAB "/etc/mtab"
+#define MOUNTINFO "/proc/self/mountinfo"
 #ifdef Q_OS_SOLARIS
 #define FSTAB "/etc/vfstab"
 #else
 #define FSTAB "/etc/fstab"
 #endif
 
+/* Changes closer together than this are reported together */
+static const int MtabMergeWindow = 50;
+/* ... unless the burst goes on for longer than this */
+static const int MtabMaxDelay = 1000;
+
 FstabWatcher::FstabWatcher()
     : m_isRoutineInstalled(false)
     , m_fileSystemWatcher(new QFileSystemWatcher(this))
+    , m_mtabSocketNotifier(nullptr)
+    , m_mtabTimer(new QTimer(this))
+    , m_pendingMtabEvents(0)
+    , m_mergedMtabEvents(0)
 {
     if (qApp) {
         connect(qApp, SIGNAL(aboutToQuit()), this, SLOT(orphanFileSystemWatcher()));
     }
 
-    m_mtabFile = new QFile(MTAB, this);
-    if (m_mtabFile && m_mtabFile->symLinkTarget().startsWith("/proc/")
-            && m_mtabFile->open(QIODevice::ReadOnly)) {
+    m_mtabTimer->setSingleShot(true);
+    connect(m_mtabTimer, SIGNAL(timeout()), this, SLOT(emitMtabChanged()));
+
+    // The kernel flags the mount table files with POLLPRI when mounts change,
+    // which QSocketNotifier::Exception waits for. mountinfo is the file the
+    // mount table is read from, it needs no /etc/mtab symlink into /proc.
+    m_mtabFile = new QFile(MOUNTINFO, this);
+    if (!m_mtabFile->open(QIODevice::ReadOnly)) {
+        m_mtabFile->setFileName(MTAB);
+        if (!m_mtabFile->symLinkTarget().startsWith("/proc/") || !m_mtabFile->open(QIODevice::ReadOnly)) {
+            m_mtabFile->setFileName(QString());
+        }
+    }
 
+    if (m_mtabFile->isOpen()) {
         m_mtabSocketNotifier = new QSocketNotifier(m_mtabFile->handle(),
                 QSocketNotifier::Exception, this);
         connect(m_mtabSocketNotifier,
-                SIGNAL(activated(int)), this, SIGNAL(mtabChanged()));
+                SIGNAL(activated(int)), this, SLOT(onMtabEvent()));
     } else {
         m_fileSystemWatcher->addPath(MTAB);
     }
@@ -100,7 +122,7 @@ FstabWatcher *FstabWatcher::instance()
 void FstabWatcher::onFileChanged(const QString &path)
 {
     if (path == MTAB) {
-        emit mtabChanged();
+        onMtabEvent();
         if (!m_fileSystemWatcher->files().contains(MTAB)) {
             m_fileSystemWatcher->addPath(MTAB);
         }
@@ -113,3 +135,25 @@ void FstabWatcher::onFileChanged(const QString &path)
     }
 }
 
+qulonglong FstabWatcher::mergedMtabEvents() const
+{
+    return m_mergedMtabEvents;
+}
+
+void FstabWatcher::onMtabEvent()
+{
+    // Waits for the burst to settle, but not forever
+    if (m_pendingMtabEvents++ == 0) {
+        m_mtabBurst.start();
+    } else if (m_mtabBurst.elapsed() >= MtabMaxDelay) {
+        return;
+    }
+    m_mtabTimer->start(MtabMergeWindow);
+}
+
+void FstabWatcher::emitMtabChanged()
+{
+    m_mergedMtabEvents += m_pendingMtabEvents - 1;
+    m_pendingMtabEvents = 0;
+    emit mtabChanged();
+}
@@ -22,10 +22,12 @@
 #define SOLID_BACKENDS_FSTAB_WATCHER_H
 
 #include <QObject>
+#include <QElapsedTimer>
 
 class QFileSystemWatcher;
 class QFile;
 class QSocketNotifier;
+class QTimer;
 
 namespace Solid
 {
@@ -34,15 +36,26 @@ namespace Backends
 namespace Fstab
 {
 
+/**
+ * Notifies about changes to fstab and to the mount table.
+ *
+ * Mount table changes coming in a burst, like a container runtime setting
+ * up its overlays, are merged: mtabChanged() is emitted once no change
+ * came for a short while.
+ */
 class FstabWatcher : public QObject
 {
     Q_OBJECT
+    /* Mount table changes folded into an mtabChanged() emitted for an earlier one */
+    Q_PROPERTY(qulonglong mergedMtabEvents READ mergedMtabEvents)
 public:
     FstabWatcher();
     virtual ~FstabWatcher();
 
     static FstabWatcher *instance();
 
+    qulonglong mergedMtabEvents() const;
+
 Q_SIGNALS:
     void mtabChanged();
     void fstabChanged();
@@ -50,12 +63,18 @@ Q_SIGNALS:
 private Q_SLOTS:
     void onFileChanged(const QString &path);
     void orphanFileSystemWatcher();
+    void onMtabEvent();
+    void emitMtabChanged();
 
 private:
     bool m_isRoutineInstalled;
     QFileSystemWatcher *m_fileSystemWatcher;
     QSocketNotifier *m_mtabSocketNotifier;
     QFile *m_mtabFile;
+    QTimer *m_mtabTimer;
+    QElapsedTimer m_mtabBurst;
+    int m_pendingMtabEvents;
+    qulonglong m_mergedMtabEvents;
 };
 }
 }
@@ -117,3 +117,9 @@ qulonglong OpticalDisc::capacity() const
     return m_device->prop("volume.disc.capacity").toULongLong();
 }
 
+bool OpticalDisc::isContentProbePending() const
+{
+    // HAL reports the content types as a whole
+    return false;
+}
+
@@ -45,6 +45,10 @@ public:
     virtual bool isBlank() const;
     virtual bool isRewritable() const;
     virtual qulonglong capacity() const;
+    virtual bool isContentProbePending() const;
+
+Q_SIGNALS:
+    void availableContentChanged(Solid::OpticalDisc::ContentTypes content, const QString &udi);
 };
 }
 }
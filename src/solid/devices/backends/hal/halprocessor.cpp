@@ -59,3 +59,62 @@ Solid::Processor::InstructionSets Processor::instructionSets() const
     return cpuextensions;
 }
 
+int Processor::packageId() const
+{
+    // Not reported by this platform
+    return -1;
+}
+
+int Processor::dieId() const
+{
+    // Not reported by this platform
+    return -1;
+}
+
+int Processor::coreId() const
+{
+    // Not reported by this platform
+    return -1;
+}
+
+int Processor::numaNode() const
+{
+    // Not reported by this platform
+    return -1;
+}
+
+QList<int> Processor::siblings() const
+{
+    // Not reported by this platform
+    return QList<int>();
+}
+
+QList<Solid::Processor::Cache> Processor::caches() const
+{
+    // Not reported by this platform
+    return QList<Solid::Processor::Cache>();
+}
+
+Solid::Processor::CoreClass Processor::coreClass() const
+{
+    // Not reported by this platform
+    return Solid::Processor::UnknownCore;
+}
+
+int Processor::capacity() const
+{
+    // Not reported by this platform
+    return -1;
+}
+
+bool Processor::isUsable() const
+{
+    // Not reported by this platform
+    return true;
+}
+
+qreal Processor::cpuQuota() const
+{
+    // Not reported by this platform
+    return -1;
+}
@@ -45,6 +45,16 @@ public:
     virtual int maxSpeed() const;
     virtual bool canChangeFrequency() const;
     virtual Solid::Processor::InstructionSets instructionSets() const;
+    virtual int packageId() const;
+    virtual int dieId() const;
+    virtual int coreId() const;
+    virtual int numaNode() const;
+    virtual QList<int> siblings() const;
+    virtual QList<Solid::Processor::Cache> caches() const;
+    virtual Solid::Processor::CoreClass coreClass() const;
+    virtual int capacity() const;
+    virtual bool isUsable() const;
+    virtual qreal cpuQuota() const;
 };
 }
 }
@@ -23,6 +23,7 @@
 #include "halfstabhandling.h"
 #include "halgenericinterface.h"
 
+#include <QtCore/QCoreApplication>
 #include <QtCore/QLocale>
 #include <QtCore/QDebug>
 #include <QtCore/QProcess>
@@ -31,8 +32,8 @@
 #include <QtDBus/QDBusInterface>
 #include <QtDBus/QDBusReply>
 #include <QtDBus/QDBusVariant>
-#include <QApplication>
-#include <QWidget>
+
+#include <soliddefs_p.h>
 
 #include <unistd.h>
 #include <stdlib.h>
@@ -326,11 +327,8 @@ bool StorageAccess::requestPassphrase()
     QDBusConnection::sessionBus().registerObject(m_lastReturnObject, this,
             QDBusConnection::ExportScriptableSlots);
 
-    QWidget *activeWindow = QApplication::activeWindow();
-    uint wId = 0;
-    if (activeWindow != 0) {
-        wId = (uint)activeWindow->winId();
-    }
+    // Looked up by the frontend, this isn't the GUI thread
+    const uint wId = Solid::passphraseWindowId();
 
     QString appId = QCoreApplication::applicationName();
 
@@ -56,3 +56,52 @@ Solid::Processor::InstructionSets Processor::instructionSets() const
     return 0; // TODO
 }
 
+int Processor::packageId() const
+{
+    return -1; // not reported by this platform
+}
+
+int Processor::dieId() const
+{
+    return -1; // not reported by this platform
+}
+
+int Processor::coreId() const
+{
+    return -1; // not reported by this platform
+}
+
+int Processor::numaNode() const
+{
+    return -1; // not reported by this platform
+}
+
+QList<int> Processor::siblings() const
+{
+    return QList<int>(); // not reported by this platform
+}
+
+QList<Solid::Processor::Cache> Processor::caches() const
+{
+    return QList<Solid::Processor::Cache>(); // not reported by this platform
+}
+
+Solid::Processor::CoreClass Processor::coreClass() const
+{
+    return Solid::Processor::UnknownCore; // not reported by this platform
+}
+
+int Processor::capacity() const
+{
+    return -1; // not reported by this platform
+}
+
+bool Processor::isUsable() const
+{
+    return true; // no affinity masks on this platform
+}
+
+qreal Processor::cpuQuota() const
+{
+    return -1; // not reported by this platform
+}
@@ -21,17 +21,23 @@
 
 #include "cpufeatures.h"
 
-#ifndef _MSC_VER
-//for cpuFeatures
-#include <csignal>
-#include <csetjmp>
-#else
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
 #include <intrin.h>
+#define SOLID_X86_CPUID_MSVC
+#elif (defined(__GNUC__) || defined(__INTEL_COMPILER)) && (defined(__i386__) || defined(__x86_64__))
+#include <cpuid.h>
+#define SOLID_X86_CPUID_GNU
 #endif
-#include <config-processor.h>
 
-#if defined(__GNUC__) || defined(__INTEL_COMPILER)
-#  define HAVE_GNU_INLINE_ASM
+#if defined(__linux__)
+#include <sys/auxv.h>
+#define SOLID_HAVE_HWCAP
+#elif defined(__FreeBSD__)
+#include <sys/param.h>
+#if __FreeBSD_version >= 1200000
+#include <sys/auxv.h>
+#define SOLID_HAVE_HWCAP
+#endif
 #endif
 
 namespace Solid
@@ -41,197 +47,427 @@ namespace Backends
 namespace Shared
 {
 
-#ifndef _MSC_VER
-typedef void (*kde_sighandler_t)(int);
+// CPUID.1:EDX
+static const quint32 cpuidMmx = 1u << 23;
+static const quint32 cpuidSse = 1u << 25;
+static const quint32 cpuidSse2 = 1u << 26;
+// CPUID.1:ECX
+static const quint32 cpuidSse3 = 1u << 0;
+static const quint32 cpuidSsse3 = 1u << 9;
+static const quint32 cpuidFma = 1u << 12;
+static const quint32 cpuidSse41 = 1u << 19;
+static const quint32 cpuidSse42 = 1u << 20;
+static const quint32 cpuidAes = 1u << 25;
+static const quint32 cpuidOsxsave = 1u << 27;
+static const quint32 cpuidAvx = 1u << 28;
+// CPUID.(EAX=7,ECX=0):EBX
+static const quint32 cpuidBmi1 = 1u << 3;
+static const quint32 cpuidAvx2 = 1u << 5;
+static const quint32 cpuidBmi2 = 1u << 8;
+static const quint32 cpuidAvx512F = 1u << 16;
+static const quint32 cpuidAvx512Dq = 1u << 17;
+static const quint32 cpuidAvx512Cd = 1u << 28;
+static const quint32 cpuidSha = 1u << 29;
+static const quint32 cpuidAvx512Bw = 1u << 30;
+static const quint32 cpuidAvx512Vl = 1u << 31;
+// CPUID.(EAX=7,ECX=0):EDX
+static const quint32 cpuidHybrid = 1u << 15;
+// CPUID.(EAX=7,ECX=0):ECX
+static const quint32 cpuidVaes = 1u << 9;
+static const quint32 cpuidVpclmulqdq = 1u << 10;
+// CPUID.80000001h:EDX
+static const quint32 cpuid3DNow = 1u << 31;
+// CPUID.80000001h:ECX
+static const quint32 cpuidTopologyExtensions = 1u << 22;
+
+// XCR0 state components
+static const quint64 xcr0Sse = 1u << 1;
+static const quint64 xcr0Avx = 1u << 2;
+static const quint64 xcr0Avx512 = (1u << 5) | (1u << 6) | (1u << 7); // opmask, ZMM_Hi256, Hi16_ZMM
+
+// AT_HWCAP bits, see the kernel's asm/hwcap.h of each architecture
+static const quint64 hwcapArmNeon = 1u << 12;
+static const quint64 hwcapAArch64Asimd = 1u << 1;
+static const quint64 hwcapAArch64Sve = 1u << 22;
+static const quint64 hwcapPowerPCAltivec = 0x10000000;
+
+Solid::Processor::InstructionSets x86Features(const CpuIdRegisters &registers)
+{
+    Solid::Processor::InstructionSets featureflags;
+
+    const quint32 ecx1 = registers.leaf1Ecx;
+    const quint32 edx1 = registers.leaf1Edx;
+    const quint32 ebx7 = registers.leaf7Ebx;
+    const quint32 ecx7 = registers.leaf7Ecx;
+
+    // Without OSXSAVE there is no way to ask which register state the OS
+    // saves; every OS still in use saves the SSE state, but none of the
+    // AVX-class state can be relied upon.
+    bool osSse = true;
+    bool osAvx = false;
+    bool osAvx512 = false;
+    if (ecx1 & cpuidOsxsave) {
+        osSse = registers.xcr0 & xcr0Sse;
+        osAvx = osSse && (registers.xcr0 & xcr0Avx);
+        osAvx512 = osAvx && (registers.xcr0 & xcr0Avx512) == xcr0Avx512;
+    }
+
+    if (edx1 & cpuidMmx) {
+        featureflags |= Solid::Processor::IntelMmx;
+    }
+    if (registers.extLeaf1Edx & cpuid3DNow) {
+        featureflags |= Solid::Processor::Amd3DNow;
+    }
+    if (ebx7 & cpuidBmi1) {
+        featureflags |= Solid::Processor::IntelBmi1;
+    }
+    if (ebx7 & cpuidBmi2) {
+        featureflags |= Solid::Processor::IntelBmi2;
+    }
+
+    if (osSse) {
+        if (edx1 & cpuidSse) {
+            featureflags |= Solid::Processor::IntelSse;
+        }
+        if (edx1 & cpuidSse2) {
+            featureflags |= Solid::Processor::IntelSse2;
+        }
+        if (ecx1 & cpuidSse3) {
+            featureflags |= Solid::Processor::IntelSse3;
+        }
+        if (ecx1 & cpuidSsse3) {
+            featureflags |= Solid::Processor::IntelSsse3;
+        }
+        if (ecx1 & cpuidSse41) {
+            featureflags |= Solid::Processor::IntelSse41;
+        }
+        if (ecx1 & cpuidSse42) {
+            featureflags |= Solid::Processor::IntelSse42;
+        }
+        if (ecx1 & cpuidAes) {
+            featureflags |= Solid::Processor::IntelAes;
+        }
+        if (ebx7 & cpuidSha) {
+            featureflags |= Solid::Processor::IntelSha;
+        }
+    }
+
+    if (osAvx && (ecx1 & cpuidAvx)) {
+        featureflags |= Solid::Processor::IntelAvx;
+        if (ebx7 & cpuidAvx2) {
+            featureflags |= Solid::Processor::IntelAvx2;
+        }
+        if (ecx1 & cpuidFma) {
+            featureflags |= Solid::Processor::IntelFma3;
+        }
+        if (ecx7 & cpuidVaes) {
+            featureflags |= Solid::Processor::IntelVaes;
+        }
+        if (ecx7 & cpuidVpclmulqdq) {
+            featureflags |= Solid::Processor::IntelVpclmulqdq;
+        }
+    }
+
+    if (osAvx512 && (ebx7 & cpuidAvx512F)) {
+        featureflags |= Solid::Processor::IntelAvx512F;
+        if (ebx7 & cpuidAvx512Cd) {
+            featureflags |= Solid::Processor::IntelAvx512Cd;
+        }
+        if (ebx7 & cpuidAvx512Bw) {
+            featureflags |= Solid::Processor::IntelAvx512Bw;
+        }
+        if (ebx7 & cpuidAvx512Dq) {
+            featureflags |= Solid::Processor::IntelAvx512Dq;
+        }
+        if (ebx7 & cpuidAvx512Vl) {
+            featureflags |= Solid::Processor::IntelAvx512Vl;
+        }
+    }
+
+    return featureflags;
+}
+
+Solid::Processor::InstructionSets hwcapFeatures(HwcapArchitecture architecture, quint64 hwcap)
+{
+    Solid::Processor::InstructionSets featureflags;
+
+    switch (architecture) {
+    case HwcapArm:
+        if (hwcap & hwcapArmNeon) {
+            featureflags |= Solid::Processor::ArmNeon;
+        }
+        break;
+    case HwcapAArch64:
+        if (hwcap & hwcapAArch64Asimd) {
+            featureflags |= Solid::Processor::ArmNeon;
+        }
+        if (hwcap & hwcapAArch64Sve) {
+            featureflags |= Solid::Processor::ArmSve;
+        }
+        break;
+    case HwcapPowerPC:
+        if (hwcap & hwcapPowerPCAltivec) {
+            featureflags |= Solid::Processor::AltiVec;
+        }
+        break;
+    }
 
-#if defined( __i386__ ) || defined( __x86_64__ )
-static jmp_buf env;
+    return featureflags;
+}
 
-#ifdef HAVE_X86_SSE
-// Sighandler for the SSE OS support check
-static void sighandler(int)
+bool decodeCacheLeaf(quint32 eax, quint32 ebx, quint32 ecx, CpuIdCache *cache)
 {
-    std::longjmp(env, 1);
+    switch (eax & 0x1f) {
+    case 1:
+        cache->type = Solid::Processor::DataCache;
+        break;
+    case 2:
+        cache->type = Solid::Processor::InstructionCache;
+        break;
+    case 3:
+        cache->type = Solid::Processor::UnifiedCache;
+        break;
+    case 0:
+        return false;
+    default:
+        cache->type = Solid::Processor::UnknownCache;
+        break;
+    }
+
+    const quint32 ways = (ebx >> 22) + 1;
+    const quint32 partitions = ((ebx >> 12) & 0x3ff) + 1;
+    const quint32 lineSize = (ebx & 0xfff) + 1;
+    const quint32 sets = ecx + 1;
+
+    cache->level = (eax >> 5) & 0x7;
+    cache->lineSize = lineSize;
+    cache->associativity = ways;
+    cache->size = qulonglong(ways) * partitions * lineSize * sets;
+    cache->threadsSharing = ((eax >> 14) & 0xfff) + 1;
+    return true;
 }
-#endif
-#endif
 
-#ifdef __i386__
-#define ASM_REG(reg)              "%e" reg
-#define ASM_POP(reg)              "popl   %%e" reg "             \n\t"
-#define ASM_PUSH(reg)             "pushl  %%e" reg "             \n\t"
-#define ASM_XOR_REG(reg1, reg2)   "xorl   %%e" reg1 ", %%e" reg2 " \n\t"
-#define ASM_XOR_VAR(var, reg)     "xorl   " var ",     %%e" reg "  \n\t"
-#define ASM_CMP_REG(reg1, reg2)   "cmpl   %%e" reg1 ", %%e" reg2 " \n\t"
-#define ASM_MOV_REG(reg1, reg2)   "movl   %%e" reg1 ", %%e" reg2 " \n\t"
-#define ASM_MOV_VAR(var, reg)     "movl   " var ",     %%e" reg "  \n\t"
-#elif defined(__x86_64__)
-#define ASM_REG(reg)              "%r" reg
-#define ASM_POP(reg)              "popq   %%r" reg "             \n\t"
-#define ASM_PUSH(reg)             "pushq  %%r" reg "             \n\t"
-#define ASM_XOR_REG(reg1, reg2)   "xorq   %%r" reg1 ", %%r" reg2 " \n\t"
-#define ASM_XOR_VAR(var, reg)     "xorq   " var ",     %%r" reg "  \n\t"
-#define ASM_CMP_REG(reg1, reg2)   "cmpq   %%r" reg1 ", %%r" reg2 " \n\t"
-#define ASM_MOV_REG(reg1, reg2)   "movq   %%r" reg1 ", %%r" reg2 " \n\t"
-#define ASM_MOV_VAR(var, reg)     "movq   " var ",     %%r" reg "  \n\t"
+#if defined(SOLID_X86_CPUID_GNU) || defined(SOLID_X86_CPUID_MSVC)
+static void cpuidCount(quint32 leaf, quint32 subleaf, quint32 *registers)
+{
+#if defined(SOLID_X86_CPUID_GNU)
+    unsigned int eax, ebx, ecx, edx;
+    __cpuid_count(leaf, subleaf, eax, ebx, ecx, edx);
+    registers[0] = eax;
+    registers[1] = ebx;
+    registers[2] = ecx;
+    registers[3] = edx;
+#else
+    int array[4];
+    __cpuidex(array, leaf, subleaf);
+    for (int i = 0; i < 4; ++i) {
+        registers[i] = array[i];
+    }
 #endif
+}
+
+QList<CpuIdCache> cpuIdCaches()
+{
+    QList<CpuIdCache> caches;
+    quint32 registers[4];
+
+    cpuidCount(0, 0, registers);
+    const quint32 maxLeaf = registers[0];
+    cpuidCount(0x80000000, 0, registers);
+    const quint32 maxExtLeaf = registers[0];
+
+    // AMD describes its caches in 0x8000001D and leaves leaf 4 reserved
+    quint32 leaf = 0;
+    if (maxExtLeaf >= 0x8000001d) {
+        cpuidCount(0x80000001, 0, registers);
+        if (registers[2] & cpuidTopologyExtensions) {
+            leaf = 0x8000001d;
+        }
+    }
+    if (!leaf && maxLeaf >= 4) {
+        leaf = 4;
+    }
+    if (!leaf) {
+        return caches;
+    }
+
+    // Real processors stop well before; the bound guards against broken hypervisors
+    for (quint32 subleaf = 0; subleaf < 16; ++subleaf) {
+        cpuidCount(leaf, subleaf, registers);
+        CpuIdCache cache;
+        if (!decodeCacheLeaf(registers[0], registers[1], registers[2], &cache)) {
+            break;
+        }
+        caches.append(cache);
+    }
+
+    return caches;
+}
+#else
+QList<CpuIdCache> cpuIdCaches()
+{
+    return QList<CpuIdCache>();
+}
 #endif
 
-#ifdef __PPC__
-static sigjmp_buf jmpbuf;
-static sig_atomic_t canjump = 0;
+Solid::Processor::CoreClass decodeCoreTypeLeaf(quint32 eax)
+{
+    switch (eax >> 24) {
+    case 0x20: // Intel Atom
+        return Solid::Processor::EfficiencyCore;
+    case 0x40: // Intel Core
+        return Solid::Processor::PerformanceCore;
+    default:
+        return Solid::Processor::UnknownCore;
+    }
+}
 
-static void sigill_handler(int sig)
+#if defined(SOLID_X86_CPUID_GNU) || defined(SOLID_X86_CPUID_MSVC)
+static HybridSupport detectHybrid()
 {
-    if (!canjump) {
-        signal(sig, SIG_DFL);
-        raise(sig);
+    quint32 registers[4];
+
+    cpuidCount(0, 0, registers);
+    if (registers[0] < 7) {
+        return NotHybrid;
     }
-    canjump = 0;
-    siglongjmp(jmpbuf, 1);
+    cpuidCount(7, 0, registers);
+    return (registers[3] & cpuidHybrid) ? Hybrid : NotHybrid;
 }
-#endif
 
-Solid::Processor::InstructionSets cpuFeatures()
+Solid::Processor::CoreClass cpuIdCoreClass()
 {
-    volatile unsigned int features = 0;
-
-#if defined( HAVE_GNU_INLINE_ASM )
-#if defined( __i386__ ) || defined( __x86_64__ )
-    bool haveCPUID = false;
-    unsigned int result = 0, result2 = 0;
-
-    // First check if the CPU supports the CPUID instruction
-    __asm__ __volatile__(
-        // Try to toggle the CPUID bit in the EFLAGS register
-        "pushf                      \n\t"   // Push the EFLAGS register onto the stack
-        ASM_POP("cx")                       // Pop the value into ECX
-        ASM_MOV_REG("cx", "dx")             // Copy ECX to EDX
-        ASM_XOR_VAR("$0x00200000", "cx")    // Toggle bit 21 (CPUID) in ECX
-        ASM_PUSH("cx")                      // Push the modified value onto the stack
-        "popf                       \n\t"   // Pop it back into EFLAGS
-
-        // Check if the CPUID bit was successfully toggled
-        "pushf                      \n\t"   // Push EFLAGS back onto the stack
-        ASM_POP("cx")                       // Pop the value into ECX
-        ASM_XOR_REG("ax", "ax")             // Zero out the EAX register
-        ASM_CMP_REG("cx", "dx")             // Compare ECX with EDX
-        "je    .Lno_cpuid_support%= \n\t"   // Jump if they're identical
-        ASM_MOV_VAR("$1", "ax")             // Set EAX to true
-        ".Lno_cpuid_support%=:      \n\t"
-        : "=a"(haveCPUID) : : ASM_REG("cx"), ASM_REG("dx"));
-
-    // If we don't have CPUID we won't have the other extensions either
-    if (haveCPUID) {
-        // Execute CPUID with the feature request bit set
-        __asm__ __volatile__(
-            ASM_PUSH("bx")                      // Save EBX
-            ASM_MOV_VAR("$1", "ax")             // Set EAX to 1 (features request)
-            "cpuid                      \n\t"   // Call CPUID
-            ASM_POP("bx")                       // Restore EBX
-            : "=d"(result), "=c"(result2) : : ASM_REG("ax"));
-
-        features = result & 0x06800000; //copy the mmx and sse & sse2 bits to features
-        features |= result2 & 0x00180101; //copy the ssse3, sse3 and sse4.1, sse4.2 bits to features
-
-        __asm__ __volatile__(
-            ASM_PUSH("bx")
-            ASM_PUSH("dx")
-            ASM_MOV_VAR("$0x80000000", "ax")
-            ASM_MOV_VAR("$0x80000000", "dx")
-            "cpuid                   \n\t"
-            ASM_CMP_REG("dx", "ax")
-            "jbe .Lno_extended%=     \n\t"
-            ASM_MOV_VAR("$0x80000001", "ax")
-            "cpuid                   \n\t"
-            ".Lno_extended%=:        \n\t"
-            ASM_POP("dx")
-            ASM_POP("bx")                      // Restore EBX
-            : "=d"(result) : : ASM_REG("ax"), ASM_REG("cx"));
-
-        if (result & 0x80000000) {
-            features |= 0x80000000;
-        }
-
-#ifdef HAVE_X86_SSE
-        // Test bit 25 (SSE support)
-        if (features & 0x02000000) {
-            // OS support test for SSE.
-            // Install our own sighandler for SIGILL.
-            kde_sighandler_t oldhandler = std::signal(SIGILL, sighandler);
-
-            // Try executing an SSE insn to see if we get a SIGILL
-            if (setjmp(env)) {
-                features &= ~0x06080001;    // The OS support test failed
-            } else {
-                __asm__ __volatile__("xorps %xmm0, %xmm0");
-            }
-
-            // Restore the default sighandler
-            std::signal(SIGILL, oldhandler);
-
-            // Note: The OS requirements for SSE2 are the same as for SSE
-            //       so we don't have to do any additional tests for that.
-        }
-#endif // HAVE_X86_SSE
-    }
-#elif defined __PPC__ && defined HAVE_PPC_ALTIVEC
-    signal(SIGILL, sigill_handler);
-    if (sigsetjmp(jmpbuf, 1)) {
-        signal(SIGILL, SIG_DFL);
-    } else {
-        canjump = 1;
-        __asm__ __volatile__("mtspr 256, %0\n\t"
-                             "vand %%v0, %%v0, %%v0"
-                             : /* none */
-                             : "r"(-1));
-        signal(SIGILL, SIG_DFL);
-        features = 0x2;
-    }
-#endif // __i386__ || __x86_64__
-#elif defined(_MSC_VER)
-    int array[4], ft = 1;
-    __cpuid(array, ft);
-
-    features = array[3] & 0x06800000; //copy the mmx and sse & sse2 bits to features
-    features |= array[2] & 0x00180101; //copy the ssse3, sse3 and sse4.1, sse4.2 bits to features
-
-    if (array[3] & 0x80000000) {
-        features |= 0x80000000;
-    }
-#endif //HAVE_GNU_INLINE_ASM
-    Solid::Processor::InstructionSets featureflags;
+    quint32 registers[4];
 
-    if (features & 0x80000000) {
-        featureflags |= Solid::Processor::Amd3DNow;
+    cpuidCount(0, 0, registers);
+    if (registers[0] < 0x1a) {
+        return Solid::Processor::UnknownCore;
     }
-    if (features & 0x00800000) {
-        featureflags |= Solid::Processor::IntelMmx;
+    cpuidCount(0x1a, 0, registers);
+    return decodeCoreTypeLeaf(registers[0]);
+}
+#else
+static HybridSupport detectHybrid()
+{
+    return HybridUnknown;
+}
+
+Solid::Processor::CoreClass cpuIdCoreClass()
+{
+    return Solid::Processor::UnknownCore;
+}
+#endif
+
+HybridSupport cpuIdHybrid()
+{
+    static const HybridSupport hybrid = detectHybrid();
+    return hybrid;
+}
+
+#if defined(SOLID_X86_CPUID_GNU) || defined(SOLID_X86_CPUID_MSVC)
+static CpuIdRegisters readCpuIdRegisters()
+{
+    CpuIdRegisters registers;
+
+#if defined(SOLID_X86_CPUID_GNU)
+    unsigned int eax, ebx, ecx, edx;
+
+    // __get_cpuid_max() also checks that CPUID exists at all on i386
+    const unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+    if (maxLeaf < 1) {
+        return registers;
     }
-    if (features & 0x02000000) {
-        featureflags |= Solid::Processor::IntelSse;
+    __cpuid(1, eax, ebx, ecx, edx);
+    registers.leaf1Ecx = ecx;
+    registers.leaf1Edx = edx;
+
+    if (maxLeaf >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        registers.leaf7Ebx = ebx;
+        registers.leaf7Ecx = ecx;
     }
-    if (features & 0x04000000) {
-        featureflags |= Solid::Processor::IntelSse2;
+
+    if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000001) {
+        __cpuid(0x80000001, eax, ebx, ecx, edx);
+        registers.extLeaf1Edx = edx;
     }
-    if (features & 0x00000001) {
-        featureflags |= Solid::Processor::IntelSse3;
+
+    if (registers.leaf1Ecx & cpuidOsxsave) {
+        // XGETBV, spelled out for assemblers that predate it
+        __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+        registers.xcr0 = (quint64(edx) << 32) | eax;
     }
-    if (features & 0x00000100) {
-        featureflags |= Solid::Processor::IntelSsse3;
+#else
+    int array[4];
+
+    __cpuid(array, 0);
+    const int maxLeaf = array[0];
+    if (maxLeaf < 1) {
+        return registers;
     }
-    if (features & 0x00080000) {
-        featureflags |= Solid::Processor::IntelSse41;
+    __cpuid(array, 1);
+    registers.leaf1Ecx = array[2];
+    registers.leaf1Edx = array[3];
+
+    if (maxLeaf >= 7) {
+        __cpuidex(array, 7, 0);
+        registers.leaf7Ebx = array[1];
+        registers.leaf7Ecx = array[2];
     }
-    if (features & 0x00100000) {
-        featureflags |= Solid::Processor::IntelSse42;
+
+    __cpuid(array, 0x80000000);
+    if (quint32(array[0]) >= 0x80000001) {
+        __cpuid(array, 0x80000001);
+        registers.extLeaf1Edx = array[3];
     }
 
-    if (features & 0x2) {
-        featureflags |= Solid::Processor::AltiVec;
+    if (registers.leaf1Ecx & cpuidOsxsave) {
+        registers.xcr0 = _xgetbv(0);
     }
+#endif
+
+    return registers;
+}
+#endif
 
+static Solid::Processor::InstructionSets detectFeatures()
+{
+#if defined(SOLID_X86_CPUID_GNU) || defined(SOLID_X86_CPUID_MSVC)
+    return x86Features(readCpuIdRegisters());
+#else
+    Solid::Processor::InstructionSets featureflags;
+#if defined(__aarch64__) || defined(_M_ARM64)
+    // Advanced SIMD is a mandatory part of ARMv8-A
+    featureflags |= Solid::Processor::ArmNeon;
+#endif
+#if defined(SOLID_HAVE_HWCAP)
+    unsigned long hwcap = 0;
+#if defined(__linux__)
+    hwcap = getauxval(AT_HWCAP);
+#else
+    if (elf_aux_info(AT_HWCAP, &hwcap, sizeof(hwcap)) != 0) {
+        hwcap = 0;
+    }
+#endif
+#if defined(__aarch64__)
+    featureflags |= hwcapFeatures(HwcapAArch64, hwcap);
+#elif defined(__arm__)
+    featureflags |= hwcapFeatures(HwcapArm, hwcap);
+#elif defined(__powerpc__) || defined(__PPC__)
+    featureflags |= hwcapFeatures(HwcapPowerPC, hwcap);
+#else
+    Q_UNUSED(hwcap);
+#endif
+#endif
     return featureflags;
+#endif
+}
+
+Solid::Processor::InstructionSets cpuFeatures()
+{
+    // Thread-safe static initialization, the processor is only queried once
+    static const Solid::Processor::InstructionSets features = detectFeatures();
+    return features;
 }
 
 }
@@ -23,6 +23,8 @@
 
 #include <solid/processor.h>
 
+#include <QtCore/QList>
+
 namespace Solid
 {
 namespace Backends
@@ -30,6 +32,101 @@ namespace Backends
 namespace Shared
 {
 
+/**
+ * Raw x86 feature registers, as returned by CPUID and XGETBV.
+ *
+ * Leaves the processor does not implement are left zeroed, as is
+ * @c xcr0 when the OS has not enabled XSAVE.
+ */
+struct CpuIdRegisters {
+    CpuIdRegisters()
+        : leaf1Ecx(0), leaf1Edx(0), leaf7Ebx(0), leaf7Ecx(0), extLeaf1Edx(0), xcr0(0)
+    {
+    }
+
+    quint32 leaf1Ecx;
+    quint32 leaf1Edx;
+    quint32 leaf7Ebx;
+    quint32 leaf7Ecx;
+    quint32 extLeaf1Edx;
+    quint64 xcr0;
+};
+
+enum HwcapArchitecture {
+    HwcapArm,
+    HwcapAArch64,
+    HwcapPowerPC
+};
+
+/**
+ * Decodes the x86 registers into instruction sets, dropping the
+ * extensions whose register state the OS does not save.
+ */
+Solid::Processor::InstructionSets x86Features(const CpuIdRegisters &registers);
+
+/**
+ * Decodes the AT_HWCAP auxiliary vector entry of @p architecture.
+ */
+Solid::Processor::InstructionSets hwcapFeatures(HwcapArchitecture architecture, quint64 hwcap);
+
+/**
+ * One cache as described by CPUID leaf 4 (Intel) or 0x8000001D (AMD).
+ */
+struct CpuIdCache {
+    CpuIdCache()
+        : level(0), type(Solid::Processor::UnknownCache), size(0), lineSize(0), associativity(0), threadsSharing(0)
+    {
+    }
+
+    int level;
+    Solid::Processor::CacheType type;
+    qulonglong size;
+    int lineSize;
+    int associativity;
+    int threadsSharing; // the maximum number of logical processors using it
+};
+
+/**
+ * Decodes one subleaf of the cache leaves.
+ *
+ * @return false for the null subleaf ending the list
+ */
+bool decodeCacheLeaf(quint32 eax, quint32 ebx, quint32 ecx, CpuIdCache *cache);
+
+/**
+ * The caches CPUID reports for the processor running the calling thread,
+ * empty when not on x86. They are read on every call, as the cores of
+ * hybrids differ: pin the thread to the core of interest first.
+ */
+QList<CpuIdCache> cpuIdCaches();
+
+enum HybridSupport {
+    HybridUnknown, // not x86
+    NotHybrid,
+    Hybrid
+};
+
+/**
+ * Whether CPUID flags the processor as hybrid, mixing core types.
+ * Detected on the first call only.
+ */
+HybridSupport cpuIdHybrid();
+
+/**
+ * Decodes EAX of CPUID leaf 0x1A into the core class it names.
+ */
+Solid::Processor::CoreClass decodeCoreTypeLeaf(quint32 eax);
+
+/**
+ * The core class CPUID leaf 0x1A reports for the processor running the
+ * calling thread, UnknownCore when not available.
+ */
+Solid::Processor::CoreClass cpuIdCoreClass();
+
+/**
+ * The instruction sets of the running processor. They are detected on
+ * the first call only.
+ */
 Solid::Processor::InstructionSets cpuFeatures();
 
 }
@@ -0,0 +1,141 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "devicecatalog.h"
+
+#include <solid/devices/ifaces/device.h>
+
+#include <algorithm>
+
+using namespace Solid::Backends::Shared;
+
+DeviceCatalog::DeviceCatalog()
+    : m_populated(false)
+{
+}
+
+void DeviceCatalog::insert(const QString &udi, const QString &parentUdi,
+                           const QVector<Solid::DeviceInterface::Type> &types)
+{
+    remove(udi);
+
+    Entry &entry = m_entries[udi];
+    entry.parentUdi = parentUdi;
+    entry.types = types;
+
+    Q_FOREACH (Solid::DeviceInterface::Type type, types) {
+        m_byType[type].insert(udi);
+    }
+    if (!parentUdi.isEmpty()) {
+        m_children[parentUdi].insert(udi);
+    }
+}
+
+void DeviceCatalog::insert(const Solid::Ifaces::Device &device,
+                           const QSet<Solid::DeviceInterface::Type> &supported)
+{
+    QVector<Solid::DeviceInterface::Type> types;
+    Q_FOREACH (Solid::DeviceInterface::Type type, supported) {
+        if (device.queryDeviceInterface(type)) {
+            types.append(type);
+        }
+    }
+
+    insert(device.udi(), device.parentUdi(), types);
+}
+
+void DeviceCatalog::remove(const QString &udi)
+{
+    QHash<QString, Entry>::iterator it = m_entries.find(udi);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    Q_FOREACH (Solid::DeviceInterface::Type type, it->types) {
+        QHash<int, QSet<QString> >::iterator typeIt = m_byType.find(type);
+        typeIt->remove(udi);
+        if (typeIt->isEmpty()) {
+            m_byType.erase(typeIt);
+        }
+    }
+
+    if (!it->parentUdi.isEmpty()) {
+        QHash<QString, QSet<QString> >::iterator parentIt = m_children.find(it->parentUdi);
+        parentIt->remove(udi);
+        if (parentIt->isEmpty()) {
+            m_children.erase(parentIt);
+        }
+    }
+
+    m_entries.erase(it);
+}
+
+void DeviceCatalog::clear()
+{
+    m_entries.clear();
+    m_byType.clear();
+    m_children.clear();
+    m_populated = false;
+}
+
+bool DeviceCatalog::contains(const QString &udi) const
+{
+    return m_entries.contains(udi);
+}
+
+int DeviceCatalog::count() const
+{
+    return m_entries.count();
+}
+
+bool DeviceCatalog::isPopulated() const
+{
+    return m_populated;
+}
+
+void DeviceCatalog::setPopulated(bool populated)
+{
+    m_populated = populated;
+}
+
+QStringList DeviceCatalog::devices(const QString &parentUdi, Solid::DeviceInterface::Type type) const
+{
+    QStringList result;
+
+    if (!parentUdi.isEmpty()) {
+        const QSet<QString> children = m_children.value(parentUdi);
+        Q_FOREACH (const QString &udi, children) {
+            if (type == Solid::DeviceInterface::Unknown || m_entries.value(udi).types.contains(type)) {
+                result << udi;
+            }
+        }
+    } else if (type != Solid::DeviceInterface::Unknown) {
+        const QSet<QString> udis = m_byType.value(type);
+        result.reserve(udis.size());
+        Q_FOREACH (const QString &udi, udis) {
+            result << udi;
+        }
+    } else {
+        result = m_entries.keys();
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
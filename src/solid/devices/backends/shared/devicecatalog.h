@@ -0,0 +1,104 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOLID_BACKENDS_SHARED_DEVICECATALOG_H
+#define SOLID_BACKENDS_SHARED_DEVICECATALOG_H
+
+#include <solid/deviceinterface.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+namespace Solid
+{
+namespace Ifaces
+{
+class Device;
+}
+
+namespace Backends
+{
+namespace Shared
+{
+
+/**
+ * Index of the devices of a backend by interface type and by parent,
+ * so that DeviceManager::devicesFromQuery() can be answered without
+ * instantiating every device.
+ *
+ * The owning manager keeps it current: devices are inserted again when
+ * something that might change their interfaces or parent happens, and
+ * removed when they go away.
+ */
+class DeviceCatalog
+{
+public:
+    DeviceCatalog();
+
+    /**
+     * Indexes @p udi, replacing any previous entry for it.
+     */
+    void insert(const QString &udi, const QString &parentUdi,
+                const QVector<Solid::DeviceInterface::Type> &types);
+
+    /**
+     * Indexes @p device under those of @p supported it implements.
+     */
+    void insert(const Solid::Ifaces::Device &device,
+                const QSet<Solid::DeviceInterface::Type> &supported);
+
+    void remove(const QString &udi);
+    void clear();
+
+    bool contains(const QString &udi) const;
+    int count() const;
+
+    /**
+     * Whether the owner filled the catalog from a full enumeration yet.
+     */
+    bool isPopulated() const;
+    void setPopulated(bool populated);
+
+    /**
+     * Same semantics as DeviceManager::devicesFromQuery(): devices having
+     * the given parent (if not empty) and interface (unless Unknown).
+     * The list is sorted, to keep results stable across runs.
+     */
+    QStringList devices(const QString &parentUdi, Solid::DeviceInterface::Type type) const;
+
+private:
+    struct Entry {
+        QString parentUdi;
+        QVector<Solid::DeviceInterface::Type> types;
+    };
+
+    QHash<QString, Entry> m_entries;
+    QHash<int, QSet<QString> > m_byType;
+    QHash<QString, QSet<QString> > m_children;
+    bool m_populated;
+};
+
+}
+}
+}
+
+#endif
@@ -27,7 +27,10 @@ extern "C"
 #include <libudev.h>
 }
 
-class QByteArray;
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
 class QSocketNotifier;
 
 namespace UdevQt
@@ -56,6 +59,7 @@ public:
 
     void init(const QStringList &subsystemList, ListenToWhat what);
     void setWatchedSubsystems(const QStringList &subsystemList);
+    void setReceiveBufferSize(int size);
     void _uq_monitorReadyRead(int fd);
     DeviceList deviceListFromEnumerate(struct udev_enumerate *en);
 
@@ -64,6 +68,37 @@ public:
     Client *q;
     QSocketNotifier *monitorNotifier;
     QStringList watchedSubsystems;
+    int receiveBufferSize;
+};
+
+/*
+ * Events drained from the monitor in one go. Successive events for the
+ * same syspath are folded: add then change is still an add, change then
+ * change a single change, and a device added and removed again within
+ * the batch is not reported at all. Otherwise events keep the order the
+ * kernel sent them in, which already reports children gone before their
+ * parent and keeps a replug a removal followed by an addition.
+ */
+class EventBatch
+{
+public:
+    enum { MaxSize = 256 };
+
+    struct Event {
+        QByteArray action;
+        Device device;
+    };
+
+    EventBatch();
+
+    void append(const QByteArray &action, const Device &device);
+    QVector<Event> events() const;
+    int received() const;
+
+private:
+    QVector<Event> m_events; // folded away entries have an empty action
+    QHash<QString, int> m_lastEvent;
+    int m_received;
 };
 
 inline QStringList listFromListEntry(struct udev_list_entry *list)
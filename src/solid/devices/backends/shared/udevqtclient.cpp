@@ -21,6 +21,7 @@
 #include "udevqtclient.h"
 #include "udevqt_p.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QSocketNotifier>
 #include <qplatformdefs.h>
 
@@ -28,7 +29,7 @@ namespace UdevQt
 {
 
 ClientPrivate::ClientPrivate(Client *q_)
-    : udev(nullptr), monitor(nullptr), q(q_), monitorNotifier(nullptr)
+    : udev(nullptr), monitor(nullptr), q(q_), monitorNotifier(nullptr), receiveBufferSize(0)
 {
 }
 
@@ -74,6 +75,10 @@ void ClientPrivate::setWatchedSubsystems(const QStringList &subsystemList)
         }
     }
 
+    if (receiveBufferSize > 0) {
+        udev_monitor_set_receive_buffer_size(newM, receiveBufferSize);
+    }
+
     // start the new monitor receiving
     udev_monitor_enable_receiving(newM);
     QSocketNotifier *sn = new QSocketNotifier(udev_monitor_get_fd(newM), QSocketNotifier::Read);
@@ -91,35 +96,110 @@ void ClientPrivate::setWatchedSubsystems(const QStringList &subsystemList)
     watchedSubsystems = subsystemList;
 }
 
+void ClientPrivate::setReceiveBufferSize(int size)
+{
+    receiveBufferSize = size;
+    if (monitor && size > 0) {
+        udev_monitor_set_receive_buffer_size(monitor, size);
+    }
+}
+
 void ClientPrivate::_uq_monitorReadyRead(int fd)
 {
     Q_UNUSED(fd);
+
+    // Drain what is pending rather than returning to the event loop for
+    // every device; the notifier fires again if more than a batch is queued
+    EventBatch batch;
     monitorNotifier->setEnabled(false);
-    struct udev_device *dev = udev_monitor_receive_device(monitor);
+    while (batch.received() < EventBatch::MaxSize) {
+        struct udev_device *dev = udev_monitor_receive_device(monitor);
+        if (!dev) {
+            break;
+        }
+        batch.append(QByteArray(udev_device_get_action(dev)), Device(new DevicePrivate(dev, false)));
+    }
     monitorNotifier->setEnabled(true);
 
-    if (!dev) {
-        return;
+    DeviceList added, removed, changed;
+    Q_FOREACH (const EventBatch::Event &event, batch.events()) {
+        if (event.action == "add") {
+            added << event.device;
+            emit q->deviceAdded(event.device);
+        } else if (event.action == "remove") {
+            removed << event.device;
+            emit q->deviceRemoved(event.device);
+        } else if (event.action == "change") {
+            changed << event.device;
+            emit q->deviceChanged(event.device);
+        } else if (event.action == "online") {
+            emit q->deviceOnlined(event.device);
+        } else  if (event.action == "offline") {
+            emit q->deviceOfflined(event.device);
+        } else {
+            qWarning("UdevQt: unhandled device action \"%s\"", event.action.constData());
+        }
     }
 
-    Device device(new DevicePrivate(dev, false));
-
-    QByteArray action(udev_device_get_action(dev));
-    if (action == "add") {
-        emit q->deviceAdded(device);
-    } else if (action == "remove") {
-        emit q->deviceRemoved(device);
-    } else if (action == "change") {
-        emit q->deviceChanged(device);
-    } else if (action == "online") {
-        emit q->deviceOnlined(device);
-    } else  if (action == "offline") {
-        emit q->deviceOfflined(device);
-    } else {
-        qWarning("UdevQt: unhandled device action \"%s\"", action.constData());
+    if (!added.isEmpty() || !removed.isEmpty() || !changed.isEmpty()) {
+        emit q->devicesChanged(added, removed, changed);
     }
 }
 
+EventBatch::EventBatch()
+    : m_received(0)
+{
+}
+
+void EventBatch::append(const QByteArray &action, const Device &device)
+{
+    ++m_received;
+
+    const QString path = device.sysfsPath();
+    QHash<QString, int>::iterator last = m_lastEvent.find(path);
+    if (last != m_lastEvent.end()) {
+        Event &previous = m_events[*last];
+        if (previous.action == "add" || previous.action == "change") {
+            if (action == "change" || action == previous.action) {
+                // keep the position of the add, with the latest properties
+                previous.device = device;
+                return;
+            }
+            if (action == "remove") {
+                const bool wasAdded = previous.action == "add";
+                previous.action.clear();
+                m_lastEvent.erase(last);
+                if (wasAdded) {
+                    return;
+                }
+            }
+        }
+    }
+
+    Event event;
+    event.action = action;
+    event.device = device;
+    m_events << event;
+    m_lastEvent.insert(path, m_events.size() - 1);
+}
+
+QVector<EventBatch::Event> EventBatch::events() const
+{
+    QVector<Event> ret;
+    ret.reserve(m_events.size());
+    Q_FOREACH (const Event &event, m_events) {
+        if (!event.action.isEmpty()) {
+            ret << event;
+        }
+    }
+    return ret;
+}
+
+int EventBatch::received() const
+{
+    return m_received;
+}
+
 DeviceList ClientPrivate::deviceListFromEnumerate(struct udev_enumerate *en)
 {
     DeviceList ret;
@@ -188,6 +268,16 @@ void Client::setWatchedSubsystems(const QStringList &subsystemList)
     d->setWatchedSubsystems(subsystemList);
 }
 
+int Client::receiveBufferSize() const
+{
+    return d->receiveBufferSize;
+}
+
+void Client::setReceiveBufferSize(int size)
+{
+    d->setReceiveBufferSize(size);
+}
+
 DeviceList Client::devicesByProperty(const QString &property, const QVariant &value)
 {
     struct udev_enumerate *en = udev_enumerate_new(d->udev);
@@ -215,6 +305,44 @@ DeviceList Client::devicesBySubsystem(const QString &subsystem)
     return d->deviceListFromEnumerate(en);
 }
 
+DeviceList Client::devicesBySubsystems(const QStringList &subsystemList)
+{
+    struct udev_enumerate *en = udev_enumerate_new(d->udev);
+
+    // libudev ors subsystem matches but cannot match on devtype, so the
+    // "subsystem/devtype" entries are filtered once enumerated
+    QHash<QString, QStringList> devTypes;
+    Q_FOREACH (const QString &subsysDevtype, subsystemList) {
+        int ix = subsysDevtype.indexOf("/");
+        const QString subsystem = ix > 0 ? subsysDevtype.left(ix) : subsysDevtype;
+
+        if (!devTypes.contains(subsystem)) {
+            udev_enumerate_add_match_subsystem(en, subsystem.toLatin1().constData());
+        }
+
+        QStringList &types = devTypes[subsystem];
+        if (ix <= 0) {
+            types << QString(); // any devtype
+        } else {
+            types << subsysDevtype.mid(ix + 1);
+        }
+    }
+
+    const DeviceList all = d->deviceListFromEnumerate(en);
+    if (subsystemList.isEmpty()) {
+        return all;
+    }
+
+    DeviceList ret;
+    Q_FOREACH (const Device &device, all) {
+        const QStringList types = devTypes.value(device.subsystem());
+        if (types.contains(QString()) || types.contains(device.devType())) {
+            ret << device;
+        }
+    }
+    return ret;
+}
+
 Device Client::deviceByDeviceFile(const QString &deviceFile)
 {
     QT_STATBUF sb;
@@ -38,6 +38,8 @@ class Client : public QObject
     Q_OBJECT
 
     Q_PROPERTY(QStringList watchedSubsystems READ watchedSubsystems WRITE setWatchedSubsystems)
+    /* Bytes of kernel buffer for pending events, 0 for the libudev default */
+    Q_PROPERTY(int receiveBufferSize READ receiveBufferSize WRITE setReceiveBufferSize)
 
 public:
     Client(QObject *parent = nullptr);
@@ -47,9 +49,17 @@ public:
     QStringList watchedSubsystems() const;
     void setWatchedSubsystems(const QStringList &subsystemList);
 
+    int receiveBufferSize() const;
+    void setReceiveBufferSize(int size);
+
     DeviceList allDevices();
     DeviceList devicesByProperty(const QString &property, const QVariant &value);
     DeviceList devicesBySubsystem(const QString &subsystem);
+    /**
+     * Devices of any of the given subsystems, in one enumeration. Entries
+     * use the "subsystem" or "subsystem/devtype" form of watchedSubsystems.
+     */
+    DeviceList devicesBySubsystems(const QStringList &subsystemList);
     Device deviceByDeviceFile(const QString &deviceFile);
     Device deviceBySysfsPath(const QString &sysfsPath);
     Device deviceBySubsystemAndName(const QString &subsystem, const QString &name);
@@ -60,6 +70,12 @@ Q_SIGNALS:
     void deviceChanged(const UdevQt::Device &dev);
     void deviceOnlined(const UdevQt::Device &dev);
     void deviceOfflined(const UdevQt::Device &dev);
+    /**
+     * Emitted once per batch of monitor events, after the per-device
+     * signals and with the same folding applied.
+     */
+    void devicesChanged(const UdevQt::DeviceList &added, const UdevQt::DeviceList &removed,
+                        const UdevQt::DeviceList &changed);
 
 private:
     friend class ClientPrivate;
@@ -0,0 +1,222 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cpuaffinity.h"
+#include "cputopology.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace Solid
+{
+namespace Backends
+{
+namespace UDev
+{
+
+/* The cgroup files only change from outside, through systemd or container
+ * tools; they are read again at most this often */
+static const qint64 CgroupMaxAgeMsecs = 1000;
+
+class SystemCpuAffinity
+{
+public:
+    SystemCpuAffinity() : valid(false) { }
+
+    CpuAffinity cgroup;
+    QElapsedTimer cgroupAge;
+    CpuAffinity affinity;
+    bool valid;
+};
+
+Q_GLOBAL_STATIC(SystemCpuAffinity, systemCpuAffinity)
+
+// The affinity mask of the main thread, which new threads inherit
+static QList<int> readAffinity()
+{
+    QList<int> cpus;
+
+    // Grow the set until the kernel's mask fits, for machines beyond CPU_SETSIZE
+    for (int count = CPU_SETSIZE; count <= 64 * CPU_SETSIZE; count *= 2) {
+        cpu_set_t *set = CPU_ALLOC(count);
+        const size_t size = CPU_ALLOC_SIZE(count);
+        CPU_ZERO_S(size, set);
+
+        if (sched_getaffinity(getpid(), size, set) == 0) {
+            for (int cpu = 0; cpu < count; ++cpu) {
+                if (CPU_ISSET_S(cpu, size, set)) {
+                    cpus << cpu;
+                }
+            }
+            CPU_FREE(set);
+            break;
+        }
+
+        CPU_FREE(set);
+        if (errno != EINVAL) {
+            break;
+        }
+    }
+
+    return cpus;
+}
+
+CpuAffinity::CpuAffinity()
+    : m_known(false), m_quota(-1)
+{
+}
+
+CpuAffinity::CpuAffinity(const QList<int> &affinity, const QString &cgroupRoot, const QByteArray &cgroupPath)
+    : m_known(!affinity.isEmpty()), m_quota(-1)
+{
+    m_usable = QSet<int>::fromList(affinity);
+
+    if (cgroupPath.isEmpty()) {
+        return;
+    }
+
+    QString group = cgroupRoot + QString::fromUtf8(cgroupPath);
+    while (group.endsWith(QLatin1Char('/'))) {
+        group.chop(1);
+    }
+
+    // The cpuset controller already folds in the limits of the ancestors
+    const QByteArray cpuset = CpuTopology::readAttribute(group + QLatin1String("/cpuset.cpus.effective"));
+    if (!cpuset.isEmpty()) {
+        const QSet<int> allowed = QSet<int>::fromList(CpuTopology::parseCpuList(cpuset));
+        if (m_known) {
+            m_usable.intersect(allowed);
+        } else {
+            m_usable = allowed;
+            m_known = true;
+        }
+    }
+
+    // cpu.max doesn't: every level caps its whole subtree
+    while (group.length() >= cgroupRoot.length()) {
+        const qreal quota = parseCpuMax(CpuTopology::readAttribute(group + QLatin1String("/cpu.max")));
+        if (quota > 0 && (m_quota < 0 || quota < m_quota)) {
+            m_quota = quota;
+        }
+        if (group.length() == cgroupRoot.length()) {
+            break;
+        }
+        group.truncate(qMax(group.lastIndexOf(QLatin1Char('/')), cgroupRoot.length()));
+    }
+}
+
+bool CpuAffinity::isKnown() const
+{
+    return m_known;
+}
+
+bool CpuAffinity::isUsable(int processorNumber) const
+{
+    return !m_known || m_usable.contains(processorNumber);
+}
+
+QList<int> CpuAffinity::usable() const
+{
+    QList<int> cpus = m_usable.toList();
+    std::sort(cpus.begin(), cpus.end());
+    return cpus;
+}
+
+qreal CpuAffinity::quota() const
+{
+    return m_quota;
+}
+
+QByteArray CpuAffinity::cgroupPath(const QByteArray &procSelfCgroup)
+{
+    // cgroup v2 is the "0::/path" line; v1 hierarchies have controller names
+    Q_FOREACH (const QByteArray &line, procSelfCgroup.split('\n')) {
+        if (line.startsWith("0::")) {
+            return line.mid(3).trimmed();
+        }
+    }
+    return QByteArray();
+}
+
+qreal CpuAffinity::parseCpuMax(const QByteArray &cpuMax)
+{
+    const QList<QByteArray> fields = cpuMax.simplified().split(' ');
+    if (fields.size() != 2 || fields.at(0) == "max") {
+        return -1;
+    }
+
+    bool maxOk = false;
+    bool periodOk = false;
+    const qlonglong max = fields.at(0).toLongLong(&maxOk);
+    const qlonglong period = fields.at(1).toLongLong(&periodOk);
+    if (!maxOk || !periodOk || max <= 0 || period <= 0) {
+        return -1;
+    }
+    return qreal(max) / period;
+}
+
+CpuAffinity CpuAffinity::narrowed(const QList<int> &affinity) const
+{
+    CpuAffinity result = *this;
+    if (affinity.isEmpty()) {
+        return result;
+    }
+
+    const QSet<int> mask = QSet<int>::fromList(affinity);
+    if (result.m_known) {
+        result.m_usable.intersect(mask);
+    } else {
+        result.m_usable = mask;
+        result.m_known = true;
+    }
+    return result;
+}
+
+const CpuAffinity &CpuAffinity::system()
+{
+    SystemCpuAffinity *cache = systemCpuAffinity;
+    if (!cache->valid || cache->cgroupAge.hasExpired(CgroupMaxAgeMsecs)) {
+        QFile cgroupFile(QStringLiteral("/proc/self/cgroup"));
+        const QByteArray path = cgroupFile.open(QIODevice::ReadOnly) ? cgroupPath(cgroupFile.readAll()) : QByteArray();
+        cache->cgroup = CpuAffinity(QList<int>(), QStringLiteral("/sys/fs/cgroup"), path);
+        cache->cgroupAge.start();
+        cache->valid = true;
+    }
+
+    // The process may have called sched_setaffinity() since, and reading
+    // the mask is a single system call
+    cache->affinity = cache->cgroup.narrowed(readAffinity());
+    return cache->affinity;
+}
+
+void CpuAffinity::invalidateSystem()
+{
+    systemCpuAffinity->valid = false;
+}
+
+}
+}
+}
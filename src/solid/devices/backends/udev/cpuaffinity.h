@@ -0,0 +1,99 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOLID_BACKENDS_UDEV_CPUAFFINITY_H
+#define SOLID_BACKENDS_UDEV_CPUAFFINITY_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+namespace Solid
+{
+namespace Backends
+{
+namespace UDev
+{
+
+/**
+ * The CPUs this process may run on, and how much of them it may use:
+ * the scheduler affinity mask narrowed by the cgroup v2 cpuset, and the
+ * cpu.max bandwidth limit.
+ */
+class CpuAffinity
+{
+public:
+    CpuAffinity();
+    /**
+     * Narrows @p affinity by the cgroup @p cgroupPath of the hierarchy
+     * mounted at @p cgroupRoot. An empty @p affinity means it is unknown.
+     */
+    CpuAffinity(const QList<int> &affinity, const QString &cgroupRoot, const QByteArray &cgroupPath);
+
+    /**
+     * Whether anything restricting the CPUs could be read; if not,
+     * every CPU is considered usable.
+     */
+    bool isKnown() const;
+    bool isUsable(int processorNumber) const;
+    QList<int> usable() const;
+    /**
+     * The CPU time the process may use, in CPUs: the tightest cpu.max of
+     * its cgroup and the ancestors. -1 when unlimited.
+     */
+    qreal quota() const;
+
+    /**
+     * This narrowed by the scheduler @p affinity, unchanged if it is empty.
+     */
+    CpuAffinity narrowed(const QList<int> &affinity) const;
+
+    /**
+     * The state of this process. The affinity mask is read on every call,
+     * the cgroup files at most once a second.
+     */
+    static const CpuAffinity &system();
+    /**
+     * Makes system() read the cgroup again on the next call.
+     */
+    static void invalidateSystem();
+
+    /**
+     * The cgroup v2 path of /proc/self/cgroup contents, "/" included,
+     * or an empty array for cgroup v1 only systems.
+     */
+    static QByteArray cgroupPath(const QByteArray &procSelfCgroup);
+    /**
+     * Parses cpu.max, "$MAX $PERIOD", into CPUs; -1 for "max".
+     */
+    static qreal parseCpuMax(const QByteArray &cpuMax);
+
+private:
+    QSet<int> m_usable;
+    bool m_known;
+    qreal m_quota;
+};
+
+}
+}
+}
+
+#endif // SOLID_BACKENDS_UDEV_CPUAFFINITY_H
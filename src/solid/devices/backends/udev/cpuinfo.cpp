@@ -20,10 +20,9 @@
 
 #include "cpuinfo.h"
 
-#include <QtCore/QDebug>
 #include <QtCore/QFile>
-#include <QtCore/QRegExp>
-#include <QtCore/QStringList>
+
+#include <string.h>
 
 namespace Solid
 {
@@ -32,91 +31,149 @@ namespace Backends
 namespace UDev
 {
 
-class CpuInfo
+class SystemCpuInfo
 {
 public:
-    CpuInfo();
-    QString extractCpuInfoLine(int processorNumber, const QString &regExpStr);
-    QString extractInfoLine(const QString &regExpStr);
+    SystemCpuInfo() : valid(false), reads(0) { }
 
-private:
-    QStringList cpuInfo;
+    CpuInfo info;
+    bool valid;
+    int reads;
 };
 
+Q_GLOBAL_STATIC(SystemCpuInfo, systemCpuInfo)
+
 QString extractCpuVendor(int processorNumber) {
-    CpuInfo info;
-    QString vendor = info.extractCpuInfoLine(processorNumber, "vendor_id\\s+:\\s+(\\S.+)");
+    const CpuInfo &info = CpuInfo::system();
+    QString vendor = info.processor(processorNumber).vendor;
 
     if (vendor.isEmpty()) {
-        vendor = info.extractInfoLine("Hardware\\s+:\\s+(\\S.+)");
+        vendor = info.hardware();
     }
 
     return vendor;
 }
 
 QString extractCpuModel(int processorNumber) {
-    CpuInfo info;
-    QString model = info.extractCpuInfoLine(processorNumber, "model name\\s+:\\s+(\\S.+)");
+    const CpuInfo &info = CpuInfo::system();
+    QString model = info.processor(processorNumber).model;
 
     if (model.isEmpty()) {
-        model = info.extractInfoLine("Processor\\s+:\\s+(\\S.+)");
+        model = info.processorModel();
     }
 
     return model;
 }
 
 int extractCurrentCpuSpeed(int processorNumber) {
-    CpuInfo info;
-    int speed = info.extractCpuInfoLine(processorNumber, "cpu MHz\\s+:\\s+(\\d+).*").toInt();
-    return speed;
+    return CpuInfo::system().processor(processorNumber).speed;
 }
 
 
-CpuInfo::CpuInfo() {
-    QFile cpuInfoFile("/proc/cpuinfo");
-    if (!cpuInfoFile.open(QIODevice::ReadOnly)) {
-        return;
+CpuInfo::Processor::Processor()
+    : speed(0)
+{
+}
+
+CpuInfo::CpuInfo()
+{
+}
+
+static QByteArray trimmed(const char *begin, const char *end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+        ++begin;
     }
-    cpuInfo = QString(cpuInfoFile.readAll()).split('\n', QString::SkipEmptyParts);
-}
-
-QString CpuInfo::extractCpuInfoLine(int processorNumber, const QString &regExpStr)
-{
-    const QRegExp processorRegExp("processor\\s+:\\s+(\\d+)");
-    const QRegExp regExp(regExpStr);
-
-    int line = 0;
-    while (line < cpuInfo.size()) {
-        if (processorRegExp.exactMatch(cpuInfo.at(line))) {
-            int recordProcNum = processorRegExp.capturedTexts()[1].toInt();
-            if (recordProcNum == processorNumber) {
-                ++line;
-                while (line < cpuInfo.size()) {
-                    if (regExp.exactMatch(cpuInfo.at(line))) {
-                        return regExp.capturedTexts()[1];
-                    }
-                    ++line;
-                }
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        --end;
+    }
+    return QByteArray(begin, end - begin);
+}
+
+CpuInfo::CpuInfo(const QByteArray &contents)
+{
+    Processor *current = nullptr;
+
+    const char *line = contents.constData();
+    const char *end = line + contents.size();
+    while (line < end) {
+        const char *newline = static_cast<const char *>(memchr(line, '\n', end - line));
+        const char *lineEnd = newline ? newline : end;
+        const char *colon = static_cast<const char *>(memchr(line, ':', lineEnd - line));
+
+        if (colon) {
+            const QByteArray key = trimmed(line, colon);
+            const QByteArray value = trimmed(colon + 1, lineEnd);
+
+            if (key == "processor") {
+                // Starts the record of a CPU
+                bool ok = false;
+                const int number = value.toInt(&ok);
+                current = ok ? &m_processors[number] : nullptr;
+            } else if (current && key == "vendor_id") {
+                current->vendor = QString::fromUtf8(value);
+            } else if (current && key == "model name") {
+                current->model = QString::fromUtf8(value);
+            } else if (current && key == "cpu MHz") {
+                const int dot = value.indexOf('.');
+                current->speed = (dot < 0 ? value : value.left(dot)).toInt();
+            } else if (key == "Hardware" && m_hardware.isEmpty()) {
+                m_hardware = QString::fromUtf8(value);
+            } else if (key == "Processor" && m_processorModel.isEmpty()) {
+                m_processorModel = QString::fromUtf8(value);
             }
         }
-        ++line;
+
+        line = lineEnd + 1;
     }
+}
 
-    return QString();
+int CpuInfo::count() const
+{
+    return m_processors.count();
 }
 
-QString CpuInfo::extractInfoLine(const QString &regExpStr)
+bool CpuInfo::contains(int processorNumber) const
 {
-    const QRegExp regExp(regExpStr);
+    return m_processors.contains(processorNumber);
+}
 
-    foreach (const QString &line, cpuInfo) {
-        if (regExp.exactMatch(line)) {
-            return regExp.capturedTexts()[1];
-        }
+CpuInfo::Processor CpuInfo::processor(int processorNumber) const
+{
+    return m_processors.value(processorNumber);
+}
+
+QString CpuInfo::hardware() const
+{
+    return m_hardware;
+}
+
+QString CpuInfo::processorModel() const
+{
+    return m_processorModel;
+}
+
+const CpuInfo &CpuInfo::system()
+{
+    SystemCpuInfo *cache = systemCpuInfo;
+    if (!cache->valid) {
+        QFile cpuInfoFile("/proc/cpuinfo");
+        cache->info = cpuInfoFile.open(QIODevice::ReadOnly) ? CpuInfo(cpuInfoFile.readAll()) : CpuInfo();
+        cache->valid = true;
+        ++cache->reads;
     }
-    return QString();
+    return cache->info;
 }
 
+void CpuInfo::invalidateSystem()
+{
+    systemCpuInfo->valid = false;
+}
+
+int CpuInfo::systemReads()
+{
+    return systemCpuInfo->reads;
+}
 
 }
 }
@@ -21,6 +21,8 @@
 #ifndef SOLID_BACKENDS_UDEV_CPUINFO_H
 #define SOLID_BACKENDS_UDEV_CPUINFO_H
 
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
 #include <QtCore/QString>
 
 namespace Solid
@@ -30,6 +32,55 @@ namespace Backends
 namespace UDev
 {
 
+/**
+ * The processor records of /proc/cpuinfo, parsed in one pass.
+ */
+class CpuInfo
+{
+public:
+    struct Processor {
+        Processor();
+
+        QString vendor;
+        QString model;
+        int speed; // MHz
+    };
+
+    CpuInfo();
+    explicit CpuInfo(const QByteArray &contents);
+
+    int count() const;
+    bool contains(int processorNumber) const;
+    Processor processor(int processorNumber) const;
+
+    /**
+     * The "Hardware" line ARM kernels add for the whole SoC
+     */
+    QString hardware() const;
+    /**
+     * The "Processor" line older ARM kernels have instead of model names
+     */
+    QString processorModel() const;
+
+    /**
+     * The table of this system, read once and shared until invalidated.
+     */
+    static const CpuInfo &system();
+    /**
+     * Makes system() read /proc/cpuinfo again, for when CPUs got plugged.
+     */
+    static void invalidateSystem();
+    /**
+     * How many times system() read /proc/cpuinfo
+     */
+    static int systemReads();
+
+private:
+    QHash<int, Processor> m_processors;
+    QString m_hardware;
+    QString m_processorModel;
+};
+
 /**
  * Extracts vendor from /proc/cpuinfo for a given processor
  */
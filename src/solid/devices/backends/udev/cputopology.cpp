@@ -0,0 +1,525 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cputopology.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QThread>
+
+#include <algorithm>
+
+#include <sched.h>
+
+namespace Solid
+{
+namespace Backends
+{
+namespace UDev
+{
+
+class SystemCpuTopology
+{
+public:
+    SystemCpuTopology() : valid(false), reads(0) { }
+
+    CpuTopology topology;
+    bool valid;
+    int reads;
+};
+
+Q_GLOBAL_STATIC(SystemCpuTopology, systemCpuTopology)
+
+/*
+ * CPUID leaves 0x1A and 4 describe the CPU running the caller, so every
+ * CPU has to be visited; a thread of our own does it instead of moving the
+ * caller around. The caches are read once per core class, on its first CPU.
+ */
+class CpuIdProbe : public QThread
+{
+public:
+    CpuIdProbe(const QList<int> &cpus, bool readCaches) : m_cpus(cpus), m_readCaches(readCaches) { }
+
+    QHash<int, Solid::Processor::CoreClass> classes;
+    QHash<int, QList<Solid::Backends::Shared::CpuIdCache> > caches;
+
+protected:
+    void run() Q_DECL_OVERRIDE
+    {
+        if (m_cpus.isEmpty()) {
+            return;
+        }
+        const int count = m_cpus.last() + 1;
+        cpu_set_t *set = CPU_ALLOC(count);
+        const size_t size = CPU_ALLOC_SIZE(count);
+        QMap<Solid::Processor::CoreClass, QList<Solid::Backends::Shared::CpuIdCache> > classCaches;
+
+        Q_FOREACH (int cpu, m_cpus) {
+            CPU_ZERO_S(size, set);
+            CPU_SET_S(cpu, size, set);
+            // Pins this thread only, with pid 0 meaning the calling thread
+            if (sched_setaffinity(0, size, set) != 0) {
+                continue;
+            }
+            const Solid::Processor::CoreClass coreClass = Solid::Backends::Shared::cpuIdCoreClass();
+            classes.insert(cpu, coreClass);
+            if (m_readCaches) {
+                if (!classCaches.contains(coreClass)) {
+                    classCaches.insert(coreClass, Solid::Backends::Shared::cpuIdCaches());
+                }
+                caches.insert(cpu, classCaches.value(coreClass));
+            }
+        }
+
+        CPU_FREE(set);
+    }
+
+private:
+    QList<int> m_cpus;
+    bool m_readCaches;
+};
+
+// Fills in the caches and core classes sysfs didn't tell
+static void applyCpuId(CpuTopology *topology)
+{
+    const bool needCaches = topology->cacheInstances() == 0;
+    const bool needClasses = !topology->hasCoreClasses();
+    if (!needCaches && !needClasses) {
+        return;
+    }
+
+    switch (Solid::Backends::Shared::cpuIdHybrid()) {
+    case Solid::Backends::Shared::NotHybrid:
+        // All cores are alike, whichever runs this tells the caches of all
+        if (needCaches) {
+            topology->applyCpuIdCaches(Solid::Backends::Shared::cpuIdCaches());
+        }
+        if (needClasses) {
+            QHash<int, Solid::Processor::CoreClass> classes;
+            Q_FOREACH (int cpu, topology->processors()) {
+                classes.insert(cpu, Solid::Processor::PerformanceCore);
+            }
+            topology->applyCoreClasses(classes);
+        }
+        break;
+    case Solid::Backends::Shared::Hybrid: {
+        CpuIdProbe probe(topology->processors(), needCaches);
+        probe.start();
+        probe.wait();
+        if (needCaches) {
+            topology->applyCpuIdCaches(probe.caches);
+        }
+        if (needClasses) {
+            topology->applyCoreClasses(probe.classes);
+        }
+        break;
+    }
+    case Solid::Backends::Shared::HybridUnknown:
+        break;
+    }
+}
+
+CpuTopology::Processor::Processor()
+    : packageId(-1), dieId(-1), coreId(-1), numaNode(-1),
+      coreClass(Solid::Processor::UnknownCore), capacity(-1)
+{
+}
+
+CpuTopology::CpuTopology()
+{
+}
+
+static int readId(const QString &path)
+{
+    bool ok = false;
+    const int id = CpuTopology::readAttribute(path).toInt(&ok);
+    return ok ? id : -1;
+}
+
+// The number of "cpu12" or "node3" directory names, -1 for "cpufreq" and the like
+static int entryNumber(const QString &name, int prefixLength)
+{
+    if (name.length() <= prefixLength) {
+        return -1;
+    }
+    bool ok = false;
+    const int number = name.midRef(prefixLength).toInt(&ok);
+    return ok && name.at(prefixLength).isDigit() ? number : -1;
+}
+
+static qulonglong parseCacheSize(const QByteArray &value)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+
+    qulonglong unit = 1;
+    QByteArray digits = value;
+    switch (value.at(value.size() - 1)) {
+    case 'K':
+        unit = Q_UINT64_C(1) << 10;
+        break;
+    case 'M':
+        unit = Q_UINT64_C(1) << 20;
+        break;
+    case 'G':
+        unit = Q_UINT64_C(1) << 30;
+        break;
+    }
+    if (unit != 1) {
+        digits.chop(1);
+    }
+    return digits.toULongLong() * unit;
+}
+
+static Solid::Processor::CacheType parseCacheType(const QByteArray &value)
+{
+    if (value == "Data") {
+        return Solid::Processor::DataCache;
+    } else if (value == "Instruction") {
+        return Solid::Processor::InstructionCache;
+    } else if (value == "Unified") {
+        return Solid::Processor::UnifiedCache;
+    }
+    return Solid::Processor::UnknownCache;
+}
+
+int CpuTopology::addCache(const Solid::Processor::Cache &cache, QHash<QByteArray, int> *instances)
+{
+    // Without the list of its users a cache can't be told apart from the
+    // same level of another core, so it isn't shared with anything
+    QByteArray key;
+    if (!cache.sharedWith.isEmpty()) {
+        key = QByteArray::number(cache.level) + ' ' + QByteArray::number(int(cache.type));
+        Q_FOREACH (int cpu, cache.sharedWith) {
+            key += ' ' + QByteArray::number(cpu);
+        }
+        const QHash<QByteArray, int>::const_iterator it = instances->constFind(key);
+        if (it != instances->constEnd()) {
+            return it.value();
+        }
+    }
+
+    m_caches.append(cache);
+    if (!key.isEmpty()) {
+        instances->insert(key, m_caches.count() - 1);
+    }
+    return m_caches.count() - 1;
+}
+
+void CpuTopology::sortCaches(Processor *processor) const
+{
+    const QList<Solid::Processor::Cache> &caches = m_caches;
+    std::stable_sort(processor->caches.begin(), processor->caches.end(), [&caches](int a, int b) {
+        return caches.at(a).level < caches.at(b).level;
+    });
+}
+
+CpuTopology::CpuTopology(const QString &sysfsRoot)
+{
+    QHash<QByteArray, int> cacheInstances;
+
+    const QString cpuPath = sysfsRoot + QLatin1String("/devices/system/cpu/");
+    const QStringList cpus = QDir(cpuPath).entryList(QStringList(QStringLiteral("cpu*")), QDir::Dirs);
+    m_processors.reserve(cpus.count());
+
+    Q_FOREACH (const QString &cpu, cpus) {
+        const int number = entryNumber(cpu, 3);
+        if (number < 0) {
+            continue;
+        }
+
+        const QString topology = cpuPath + cpu + QLatin1String("/topology/");
+        Processor &processor = m_processors[number];
+        processor.packageId = readId(topology + QLatin1String("physical_package_id"));
+        processor.dieId = readId(topology + QLatin1String("die_id")); // since Linux 5.2
+        processor.coreId = readId(topology + QLatin1String("core_id"));
+        processor.siblings = parseCpuList(readAttribute(topology + QLatin1String("thread_siblings_list")));
+        // Only there on asymmetric systems, ARM big.LITTLE and recent x86 hybrids
+        processor.capacity = readId(cpuPath + cpu + QLatin1String("/cpu_capacity"));
+
+        const QString cachePath = cpuPath + cpu + QLatin1String("/cache/");
+        const QStringList indexes = QDir(cachePath).entryList(QStringList(QStringLiteral("index*")), QDir::Dirs);
+        Q_FOREACH (const QString &index, indexes) {
+            const QString attributes = cachePath + index + QLatin1Char('/');
+
+            Solid::Processor::Cache cache;
+            cache.level = readId(attributes + QLatin1String("level"));
+            if (cache.level <= 0) {
+                continue;
+            }
+            cache.type = parseCacheType(readAttribute(attributes + QLatin1String("type")));
+            cache.sharedWith = parseCpuList(readAttribute(attributes + QLatin1String("shared_cpu_list")));
+
+            // Every CPU sharing a cache lists it, only read its geometry once
+            const int instanceCount = m_caches.count();
+            const int instance = addCache(cache, &cacheInstances);
+            if (instance == instanceCount) {
+                Solid::Processor::Cache &added = m_caches[instance];
+                added.size = parseCacheSize(readAttribute(attributes + QLatin1String("size")));
+                added.lineSize = qMax(0, readId(attributes + QLatin1String("coherency_line_size")));
+                added.associativity = qMax(0, readId(attributes + QLatin1String("ways_of_associativity")));
+            }
+            processor.caches << instance;
+        }
+        sortCaches(&processor);
+    }
+
+    // One cpulist per node is far fewer reads than looking for the
+    // nodeN link in every CPU directory
+    const QString nodePath = sysfsRoot + QLatin1String("/devices/system/node/");
+    const QStringList nodes = QDir(nodePath).entryList(QStringList(QStringLiteral("node*")), QDir::Dirs);
+    Q_FOREACH (const QString &node, nodes) {
+        const int number = entryNumber(node, 4);
+        if (number < 0) {
+            continue;
+        }
+
+        const QList<int> members = parseCpuList(readAttribute(nodePath + node + QLatin1String("/cpulist")));
+        Q_FOREACH (int member, members) {
+            QHash<int, Processor>::iterator it = m_processors.find(member);
+            if (it != m_processors.end()) {
+                it->numaNode = number;
+            }
+        }
+    }
+
+    classifyCores(cpuPath);
+}
+
+void CpuTopology::classifyCores(const QString &cpuPath)
+{
+    // Intel hybrids list the CPUs of each core type, as in types/intel_atom_0
+    const QString typesPath = cpuPath + QLatin1String("types/");
+    const QStringList types = QDir(typesPath).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    Q_FOREACH (const QString &type, types) {
+        Solid::Processor::CoreClass coreClass;
+        if (type.startsWith(QLatin1String("intel_core"))) {
+            coreClass = Solid::Processor::PerformanceCore;
+        } else if (type.startsWith(QLatin1String("intel_atom"))) {
+            coreClass = Solid::Processor::EfficiencyCore;
+        } else {
+            continue;
+        }
+
+        Q_FOREACH (int member, parseCpuList(readAttribute(typesPath + type + QLatin1String("/cpulist")))) {
+            QHash<int, Processor>::iterator it = m_processors.find(member);
+            if (it != m_processors.end()) {
+                it->coreClass = coreClass;
+            }
+        }
+    }
+
+    int minCapacity = -1;
+    int maxCapacity = -1;
+    Q_FOREACH (const Processor &processor, m_processors) {
+        if (processor.capacity > 0) {
+            minCapacity = minCapacity < 0 ? processor.capacity : qMin(minCapacity, processor.capacity);
+        }
+        maxCapacity = qMax(maxCapacity, processor.capacity);
+    }
+
+    if (maxCapacity > 0) {
+        // Otherwise little cores are the ones of the lowest capacity, and
+        // the mid cores of three-tier phones count as big; a symmetric
+        // system is all big
+        if (!hasCoreClasses()) {
+            for (QHash<int, Processor>::iterator it = m_processors.begin(); it != m_processors.end(); ++it) {
+                if (it->capacity > 0) {
+                    it->coreClass = it->capacity == minCapacity && minCapacity < maxCapacity
+                                    ? Solid::Processor::EfficiencyCore
+                                    : Solid::Processor::PerformanceCore;
+                }
+            }
+        }
+        return;
+    }
+
+    // Without cpu_capacity, scale the maximum frequencies to the same range.
+    // They don't classify cores: favored cores of non-hybrid parts boost higher.
+    QHash<int, qlonglong> frequencies;
+    qlonglong maxFrequency = 0;
+    for (QHash<int, Processor>::const_iterator it = m_processors.constBegin(); it != m_processors.constEnd(); ++it) {
+        const QString path = cpuPath + QStringLiteral("cpu%1/cpufreq/cpuinfo_max_freq").arg(it.key());
+        const qlonglong frequency = readAttribute(path).toLongLong();
+        if (frequency > 0) {
+            frequencies.insert(it.key(), frequency);
+            maxFrequency = qMax(maxFrequency, frequency);
+        }
+    }
+    for (QHash<int, qlonglong>::const_iterator it = frequencies.constBegin(); it != frequencies.constEnd(); ++it) {
+        m_processors[it.key()].capacity = int(it.value() * 1024 / maxFrequency);
+    }
+}
+
+bool CpuTopology::hasCoreClasses() const
+{
+    Q_FOREACH (const Processor &processor, m_processors) {
+        if (processor.coreClass != Solid::Processor::UnknownCore) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CpuTopology::applyCoreClasses(const QHash<int, Solid::Processor::CoreClass> &classes)
+{
+    for (QHash<int, Solid::Processor::CoreClass>::const_iterator it = classes.constBegin(); it != classes.constEnd(); ++it) {
+        QHash<int, Processor>::iterator processor = m_processors.find(it.key());
+        if (processor != m_processors.end()) {
+            processor->coreClass = it.value();
+        }
+    }
+}
+
+QList<int> CpuTopology::parseCpuList(const QByteArray &list)
+{
+    QList<int> cpus;
+
+    Q_FOREACH (const QByteArray &range, list.trimmed().split(',')) {
+        const int dash = range.indexOf('-');
+        bool firstOk = false;
+        bool lastOk = false;
+        const int first = (dash < 0 ? range : range.left(dash)).toInt(&firstOk);
+        const int last = dash < 0 ? first : range.mid(dash + 1).toInt(&lastOk);
+        if (!firstOk || (dash >= 0 && !lastOk) || first < 0 || last < first) {
+            continue;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus << cpu;
+        }
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+QByteArray CpuTopology::readAttribute(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    // Attributes are a single short line
+    return file.read(4096).trimmed();
+}
+
+int CpuTopology::count() const
+{
+    return m_processors.count();
+}
+
+bool CpuTopology::contains(int processorNumber) const
+{
+    return m_processors.contains(processorNumber);
+}
+
+CpuTopology::Processor CpuTopology::processor(int processorNumber) const
+{
+    return m_processors.value(processorNumber);
+}
+
+QList<int> CpuTopology::processors() const
+{
+    QList<int> numbers = m_processors.keys();
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+QList<Solid::Processor::Cache> CpuTopology::caches(int processorNumber) const
+{
+    QList<Solid::Processor::Cache> result;
+    Q_FOREACH (int instance, m_processors.value(processorNumber).caches) {
+        result << m_caches.at(instance);
+    }
+    return result;
+}
+
+int CpuTopology::cacheInstances() const
+{
+    return m_caches.count();
+}
+
+void CpuTopology::applyCpuIdCaches(const QList<Solid::Backends::Shared::CpuIdCache> &caches)
+{
+    QHash<int, QList<Solid::Backends::Shared::CpuIdCache> > processorCaches;
+    Q_FOREACH (int number, processors()) {
+        processorCaches.insert(number, caches);
+    }
+    applyCpuIdCaches(processorCaches);
+}
+
+void CpuTopology::applyCpuIdCaches(const QHash<int, QList<Solid::Backends::Shared::CpuIdCache> > &caches)
+{
+    QHash<QByteArray, int> cacheInstances;
+    m_caches.clear();
+
+    Q_FOREACH (int number, processors()) {
+        Processor &processor = m_processors[number];
+        processor.caches.clear();
+
+        Q_FOREACH (const Solid::Backends::Shared::CpuIdCache &cpuIdCache, caches.value(number)) {
+            Solid::Processor::Cache cache;
+            cache.level = cpuIdCache.level;
+            cache.type = cpuIdCache.type;
+            cache.size = cpuIdCache.size;
+            cache.lineSize = cpuIdCache.lineSize;
+            cache.associativity = cpuIdCache.associativity;
+            if (cpuIdCache.threadsSharing == 1) {
+                cache.sharedWith << number;
+            } else if (cpuIdCache.threadsSharing == processor.siblings.count()) {
+                cache.sharedWith = processor.siblings;
+            }
+            processor.caches << addCache(cache, &cacheInstances);
+        }
+        sortCaches(&processor);
+    }
+}
+
+const CpuTopology &CpuTopology::system()
+{
+    SystemCpuTopology *cache = systemCpuTopology;
+    if (!cache->valid) {
+        cache->topology = CpuTopology(QStringLiteral("/sys"));
+        // Containers and old kernels may hide the cache directories; non-hybrid
+        // x86 has neither types/ nor cpu_capacity, and older kernels lack them
+        // on hybrids too
+        applyCpuId(&cache->topology);
+        cache->valid = true;
+        ++cache->reads;
+    }
+    return cache->topology;
+}
+
+void CpuTopology::invalidateSystem()
+{
+    systemCpuTopology->valid = false;
+}
+
+int CpuTopology::systemReads()
+{
+    return systemCpuTopology->reads;
+}
+
+}
+}
+}
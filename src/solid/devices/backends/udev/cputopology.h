@@ -0,0 +1,138 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOLID_BACKENDS_UDEV_CPUTOPOLOGY_H
+#define SOLID_BACKENDS_UDEV_CPUTOPOLOGY_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+#include <solid/processor.h>
+
+#include "../shared/cpufeatures.h"
+
+namespace Solid
+{
+namespace Backends
+{
+namespace UDev
+{
+
+/**
+ * Package, die, core, NUMA node and caches of every CPU, read from sysfs
+ * in one pass.
+ */
+class CpuTopology
+{
+public:
+    struct Processor {
+        Processor();
+
+        int packageId;
+        int dieId;
+        int coreId;
+        int numaNode;
+        QList<int> siblings;
+        QList<int> caches; // indexes of the shared cache instances
+        Solid::Processor::CoreClass coreClass;
+        int capacity;
+    };
+
+    CpuTopology();
+    /**
+     * Reads the devices/system/cpu and devices/system/node directories
+     * below @p sysfsRoot, which is "/sys" on a running system.
+     */
+    explicit CpuTopology(const QString &sysfsRoot);
+
+    int count() const;
+    bool contains(int processorNumber) const;
+    Processor processor(int processorNumber) const;
+    QList<int> processors() const;
+
+    /**
+     * The caches of a CPU, innermost level first.
+     */
+    QList<Solid::Processor::Cache> caches(int processorNumber) const;
+    /**
+     * How many distinct caches there are; a cache shared by several
+     * CPUs counts once.
+     */
+    int cacheInstances() const;
+    /**
+     * Replaces the caches of every CPU with what CPUID reports on one, for
+     * when sysfs has no cache directories and the cores are alike. CPUID only tells how many CPUs share a cache,
+     * so sharing is only resolved when that matches the SMT siblings.
+     */
+    void applyCpuIdCaches(const QList<Solid::Backends::Shared::CpuIdCache> &caches);
+    /**
+     * Same, with the caches CPUID reported on each processor, as they differ
+     * between the core classes of hybrids. Processors left out get none.
+     */
+    void applyCpuIdCaches(const QHash<int, QList<Solid::Backends::Shared::CpuIdCache> > &caches);
+
+    /**
+     * Whether sysfs told the class of any core
+     */
+    bool hasCoreClasses() const;
+    /**
+     * Sets the core classes found by other means, CPUID on x86.
+     */
+    void applyCoreClasses(const QHash<int, Solid::Processor::CoreClass> &classes);
+
+    /**
+     * The table of this system, read once and shared until invalidated.
+     */
+    static const CpuTopology &system();
+    /**
+     * Makes system() read sysfs again, for when CPUs got plugged.
+     */
+    static void invalidateSystem();
+    /**
+     * How many times system() read sysfs
+     */
+    static int systemReads();
+
+    /**
+     * Parses the "0-3,8,10-11" lists of sysfs into sorted CPU numbers.
+     */
+    static QList<int> parseCpuList(const QByteArray &list);
+    /**
+     * The trimmed contents of a one-line sysfs or cgroupfs attribute,
+     * empty if it can't be read.
+     */
+    static QByteArray readAttribute(const QString &path);
+
+private:
+    int addCache(const Solid::Processor::Cache &cache, QHash<QByteArray, int> *instances);
+    void sortCaches(Processor *processor) const;
+    void classifyCores(const QString &cpuPath);
+
+    QHash<int, Processor> m_processors;
+    QList<Solid::Processor::Cache> m_caches;
+};
+
+}
+}
+}
+
+#endif // SOLID_BACKENDS_UDEV_CPUTOPOLOGY_H
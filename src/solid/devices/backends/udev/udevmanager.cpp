@@ -22,11 +22,17 @@
 
 #include "udev.h"
 #include "udevdevice.h"
+#include "cpuaffinity.h"
+#include "cpuinfo.h"
+#include "cputopology.h"
 #include "../shared/rootdevice.h"
+#include "../shared/devicecatalog.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QSet>
 #include <QtCore/QFile>
 #include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
 
 using namespace Solid::Backends::UDev;
 using namespace Solid::Backends::Shared;
@@ -38,25 +44,42 @@ public:
     ~Private();
 
     bool isOfInterest(const QString &udi, const UdevQt::Device &device);
-    bool checkOfInterest(const UdevQt::Device &device);
+    bool checkOfInterest(const UdevQt::Device &device, int *sysfsStats);
+    void checkCpuHotplug(const UdevQt::Device &device);
+    void populate();
+
+    struct Interest {
+        bool isOfInterest;
+        int sysfsStats; // what checkOfInterest() cost
+    };
 
     UdevQt::Client *m_client;
-    QStringList m_devicesOfInterest;
+    QStringList m_subsystems;
+    // Answers of checkOfInterest() by udi, dropped on udev events
+    QHash<QString, Interest> m_interest;
+    qulonglong m_sysfsStatsAvoided;
     QSet<Solid::DeviceInterface::Type> m_supportedInterfaces;
+    Solid::Backends::Shared::DeviceCatalog m_catalog;
+    qint64 m_enumerationTime;
+    int m_enumeratedDevices;
 };
 
 UDevManager::Private::Private()
+    : m_sysfsStatsAvoided(0),
+      m_enumerationTime(-1),
+      m_enumeratedDevices(0)
 {
-    QStringList subsystems;
-    subsystems << "processor";
-    subsystems << "cpu";
-    subsystems << "sound";
-    subsystems << "tty";
-    subsystems << "dvb";
-    subsystems << "net";
-    subsystems << "usb";
-    subsystems << "input";
-    m_client = new UdevQt::Client(subsystems);
+    m_subsystems << "processor";
+    m_subsystems << "cpu";
+    m_subsystems << "sound";
+    m_subsystems << "tty";
+    m_subsystems << "dvb";
+    m_subsystems << "net";
+    m_subsystems << "usb";
+    m_subsystems << "input";
+    m_client = new UdevQt::Client(m_subsystems);
+    // Room for a replug storm while the event loop is busy elsewhere
+    m_client->setReceiveBufferSize(4 * 1024 * 1024);
 }
 
 UDevManager::Private::~Private()
@@ -66,19 +89,61 @@ UDevManager::Private::~Private()
 
 bool UDevManager::Private::isOfInterest(const QString &udi, const UdevQt::Device &device)
 {
-    if (m_devicesOfInterest.contains(udi)) {
-        return true;
+    QHash<QString, Interest>::const_iterator it = m_interest.constFind(udi);
+    if (it != m_interest.constEnd()) {
+        m_sysfsStatsAvoided += it->sysfsStats;
+        return it->isOfInterest;
     }
 
-    bool isOfInterest = checkOfInterest(device);
-    if (isOfInterest) {
-        m_devicesOfInterest.append(udi);
+    // Nothing to remember about a device udev does not know (yet)
+    if (!device.isValid()) {
+        return false;
+    }
+
+    Interest interest;
+    interest.sysfsStats = 0;
+    interest.isOfInterest = checkOfInterest(device, &interest.sysfsStats);
+    m_interest.insert(udi, interest);
+
+    return interest.isOfInterest;
+}
+
+void UDevManager::Private::checkCpuHotplug(const UdevQt::Device &device)
+{
+    // The shared /proc/cpuinfo and topology tables, and the cgroup cpuset,
+    // only list the CPUs online when they got read
+    if (device.subsystem() == QLatin1String("cpu") || device.subsystem() == QLatin1String("processor")) {
+        CpuInfo::invalidateSystem();
+        CpuTopology::invalidateSystem();
+        CpuAffinity::invalidateSystem();
+    }
+}
+
+void UDevManager::Private::populate()
+{
+    if (m_catalog.isPopulated()) {
+        return;
+    }
+
+    // Only the subsystems the monitor listens to can ever be reported as
+    // added or removed, so there is no point in walking the rest of sysfs
+    QElapsedTimer timer;
+    timer.start();
+
+    const UdevQt::DeviceList deviceList = m_client->devicesBySubsystems(m_subsystems);
+    Q_FOREACH (const UdevQt::Device &device, deviceList) {
+        const QString udi = QString::fromLatin1(UDEV_UDI_PREFIX) + device.sysfsPath();
+        if (isOfInterest(udi, device)) {
+            m_catalog.insert(UDevDevice(device), m_supportedInterfaces);
+        }
     }
+    m_catalog.setPopulated(true);
 
-    return isOfInterest;
+    m_enumeratedDevices = deviceList.size();
+    m_enumerationTime = timer.elapsed();
 }
 
-bool UDevManager::Private::checkOfInterest(const UdevQt::Device &device)
+bool UDevManager::Private::checkOfInterest(const UdevQt::Device &device, int *sysfsStats)
 {
 #ifdef UDEV_DETAILED_OUTPUT
     qDebug() << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<";
@@ -94,7 +159,14 @@ bool UDevManager::Private::checkOfInterest(const UdevQt::Device &device)
     if (device.subsystem() == QLatin1String("cpu")) {
         // Linux ACPI reports processor slots, rather than processors.
         // Empty slots will not have a system device associated with them.
-        return QFile::exists(device.sysfsPath() + "/sysdev") || QFile::exists(device.sysfsPath() + "/cpufreq") || QFile::exists(device.sysfsPath() + "/topology/core_id");
+        static const char *const markers[] = { "/sysdev", "/cpufreq", "/topology/core_id" };
+        for (const char *marker : markers) {
+            ++*sysfsStats;
+            if (QFile::exists(device.sysfsPath() + marker)) {
+                return true;
+            }
+        }
+        return false;
     }
     if (device.subsystem() == QLatin1String("sound") &&
             device.deviceProperty("SOUND_FORM_FACTOR").toString() != "internal") {
@@ -122,10 +194,28 @@ bool UDevManager::Private::checkOfInterest(const UdevQt::Device &device)
 
     }
 
-    return device.subsystem() == QLatin1String("dvb") ||
-           device.subsystem() == QLatin1String("net") ||
-           (!device.deviceProperty("ID_MEDIA_PLAYER").toString().isEmpty() && device.parent().deviceProperty("ID_MEDIA_PLAYER").toString().isEmpty()) || // media-player-info recognized devices
-           (device.deviceProperty("ID_GPHOTO2").toInt() == 1 && device.parent().deviceProperty("ID_GPHOTO2").toInt() != 1); // GPhoto2 cameras
+    if (device.subsystem() == QLatin1String("dvb") ||
+            device.subsystem() == QLatin1String("net")) {
+        return true;
+    }
+
+    // media-player-info recognized devices
+    if (!device.deviceProperty("ID_MEDIA_PLAYER").toString().isEmpty()) {
+        ++*sysfsStats;
+        if (device.parent().deviceProperty("ID_MEDIA_PLAYER").toString().isEmpty()) {
+            return true;
+        }
+    }
+
+    // GPhoto2 cameras
+    if (device.deviceProperty("ID_GPHOTO2").toInt() == 1) {
+        ++*sysfsStats;
+        if (device.parent().deviceProperty("ID_GPHOTO2").toInt() != 1) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 UDevManager::UDevManager(QObject *parent)
@@ -134,6 +224,9 @@ UDevManager::UDevManager(QObject *parent)
 {
     connect(d->m_client, SIGNAL(deviceAdded(UdevQt::Device)), this, SLOT(slotDeviceAdded(UdevQt::Device)));
     connect(d->m_client, SIGNAL(deviceRemoved(UdevQt::Device)), this, SLOT(slotDeviceRemoved(UdevQt::Device)));
+    connect(d->m_client, SIGNAL(deviceChanged(UdevQt::Device)), this, SLOT(slotDeviceChanged(UdevQt::Device)));
+    connect(d->m_client, SIGNAL(deviceOnlined(UdevQt::Device)), this, SLOT(slotDeviceOnlineChanged(UdevQt::Device)));
+    connect(d->m_client, SIGNAL(deviceOfflined(UdevQt::Device)), this, SLOT(slotDeviceOnlineChanged(UdevQt::Device)));
 
     d->m_supportedInterfaces << Solid::DeviceInterface::GenericInterface
                              << Solid::DeviceInterface::Processor
@@ -160,43 +253,26 @@ QSet<Solid::DeviceInterface::Type> UDevManager::supportedInterfaces() const
 
 QStringList UDevManager::allDevices()
 {
-    QStringList res;
-    const UdevQt::DeviceList deviceList = d->m_client->allDevices();
-    Q_FOREACH (const UdevQt::Device &device, deviceList) {
-        if (d->isOfInterest(udiPrefix() + device.sysfsPath(), device)) {
-            res << udiPrefix() + device.sysfsPath();
-        }
-    }
-    return res;
+    // Enumerated once, then kept current from the udev monitor
+    d->populate();
+    return d->m_catalog.devices(QString(), Solid::DeviceInterface::Unknown);
 }
 
 QStringList UDevManager::devicesFromQuery(const QString &parentUdi,
         Solid::DeviceInterface::Type type)
 {
-    QStringList allDev = allDevices();
-    QStringList result;
-
-    if (!parentUdi.isEmpty()) {
-        Q_FOREACH (const QString &udi, allDev) {
-            UDevDevice device(d->m_client->deviceBySysfsPath(udi.right(udi.size() - udiPrefix().size())));
-            if (device.queryDeviceInterface(type) && device.parentUdi() == parentUdi) {
-                result << udi;
-            }
-        }
+    d->populate();
+    return d->m_catalog.devices(parentUdi, type);
+}
 
-        return result;
-    } else if (type != Solid::DeviceInterface::Unknown) {
-        Q_FOREACH (const QString &udi, allDev) {
-            UDevDevice device(d->m_client->deviceBySysfsPath(udi.right(udi.size() - udiPrefix().size())));
-            if (device.queryDeviceInterface(type)) {
-                result << udi;
-            }
-        }
+qint64 UDevManager::enumerationTime() const
+{
+    return d->m_enumerationTime;
+}
 
-        return result;
-    } else {
-        return allDev;
-    }
+int UDevManager::enumeratedDevices() const
+{
+    return d->m_enumeratedDevices;
 }
 
 QObject *UDevManager::createDevice(const QString &udi_)
@@ -222,15 +298,73 @@ QObject *UDevManager::createDevice(const QString &udi_)
 
 void UDevManager::slotDeviceAdded(const UdevQt::Device &device)
 {
-    if (d->isOfInterest(udiPrefix() + device.sysfsPath(), device)) {
-        emit deviceAdded(udiPrefix() + device.sysfsPath());
+    const QString udi = udiPrefix() + device.sysfsPath();
+    d->m_interest.remove(udi);
+    d->checkCpuHotplug(device);
+
+    if (d->isOfInterest(udi, device)) {
+        if (d->m_catalog.isPopulated()) {
+            d->m_catalog.insert(UDevDevice(device), d->m_supportedInterfaces);
+        }
+        emit deviceAdded(udi);
     }
 }
 
 void UDevManager::slotDeviceRemoved(const UdevQt::Device &device)
 {
-    if (d->isOfInterest(udiPrefix() + device.sysfsPath(), device)) {
-        emit deviceRemoved(udiPrefix() + device.sysfsPath());
-        d->m_devicesOfInterest.removeAll(udiPrefix() + device.sysfsPath());
+    const QString udi = udiPrefix() + device.sysfsPath();
+    if (d->isOfInterest(udi, device)) {
+        emit deviceRemoved(udi);
+        d->m_catalog.remove(udi);
+    }
+    d->m_interest.remove(udi);
+    d->checkCpuHotplug(device);
+}
+
+void UDevManager::slotDeviceChanged(const UdevQt::Device &device)
+{
+    const QString udi = udiPrefix() + device.sysfsPath();
+
+    // What we told about the device so far: the catalog has it all once
+    // populated, otherwise only the remembered answer tells
+    bool known = true;
+    bool wasOfInterest = false;
+    if (d->m_catalog.isPopulated()) {
+        wasOfInterest = d->m_catalog.contains(udi);
+    } else if (d->m_interest.contains(udi)) {
+        wasOfInterest = d->m_interest.value(udi).isOfInterest;
+    } else {
+        known = false;
+    }
+
+    // Properties deciding whether we care and about the interfaces
+    // of the device may have changed
+    d->m_interest.remove(udi);
+    const bool ofInterest = d->isOfInterest(udi, device);
+
+    if (ofInterest && d->m_catalog.isPopulated()) {
+        d->m_catalog.insert(UDevDevice(device), d->m_supportedInterfaces);
+    }
+
+    if (known && ofInterest != wasOfInterest) {
+        if (ofInterest) {
+            emit deviceAdded(udi);
+        } else {
+            emit deviceRemoved(udi);
+        }
     }
+
+    if (!ofInterest) {
+        d->m_catalog.remove(udi);
+    }
+}
+
+void UDevManager::slotDeviceOnlineChanged(const UdevQt::Device &device)
+{
+    d->checkCpuHotplug(device);
+}
+
+qulonglong UDevManager::sysfsStatsAvoided() const
+{
+    return d->m_sysfsStatsAvoided;
 }
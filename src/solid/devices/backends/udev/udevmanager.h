@@ -34,6 +34,12 @@ namespace UDev
 class UDevManager : public Solid::Ifaces::DeviceManager
 {
     Q_OBJECT
+    /* Milliseconds the initial sysfs enumeration took, -1 until it happened */
+    Q_PROPERTY(qint64 enumerationTime READ enumerationTime)
+    /* Devices the initial enumeration instantiated, of interest or not */
+    Q_PROPERTY(int enumeratedDevices READ enumeratedDevices)
+    /* Sysfs lookups spared by remembering which devices are of interest */
+    Q_PROPERTY(qulonglong sysfsStatsAvoided READ sysfsStatsAvoided)
 
 public:
     UDevManager(QObject *parent);
@@ -49,9 +55,15 @@ public:
 
     QObject *createDevice(const QString &udi) Q_DECL_OVERRIDE;
 
+    qint64 enumerationTime() const;
+    int enumeratedDevices() const;
+    qulonglong sysfsStatsAvoided() const;
+
 private Q_SLOTS:
     void slotDeviceAdded(const UdevQt::Device &device);
     void slotDeviceRemoved(const UdevQt::Device &device);
+    void slotDeviceChanged(const UdevQt::Device &device);
+    void slotDeviceOnlineChanged(const UdevQt::Device &device);
 
 private:
     class Private;
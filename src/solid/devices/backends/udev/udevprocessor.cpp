@@ -21,7 +21,9 @@
 #include "udevprocessor.h"
 
 #include "udevdevice.h"
+#include "cpuaffinity.h"
 #include "cpuinfo.h"
+#include "cputopology.h"
 #include "../shared/cpufeatures.h"
 
 #include <QtCore/QFile>
@@ -96,6 +98,56 @@ Solid::Processor::InstructionSets Processor::instructionSets() const
     return cpuextensions;
 }
 
+int Processor::packageId() const
+{
+    return CpuTopology::system().processor(number()).packageId;
+}
+
+int Processor::dieId() const
+{
+    return CpuTopology::system().processor(number()).dieId;
+}
+
+int Processor::coreId() const
+{
+    return CpuTopology::system().processor(number()).coreId;
+}
+
+int Processor::numaNode() const
+{
+    return CpuTopology::system().processor(number()).numaNode;
+}
+
+QList<int> Processor::siblings() const
+{
+    return CpuTopology::system().processor(number()).siblings;
+}
+
+QList<Solid::Processor::Cache> Processor::caches() const
+{
+    return CpuTopology::system().caches(number());
+}
+
+Solid::Processor::CoreClass Processor::coreClass() const
+{
+    return CpuTopology::system().processor(number()).coreClass;
+}
+
+int Processor::capacity() const
+{
+    return CpuTopology::system().processor(number()).capacity;
+}
+
+bool Processor::isUsable() const
+{
+    return CpuAffinity::system().isUsable(number());
+}
+
+qreal Processor::cpuQuota() const
+{
+    return CpuAffinity::system().quota();
+}
+
 QString Processor::prefix() const
 {
     QLatin1String sysPrefix("/sysdev");
@@ -45,6 +45,16 @@ public:
     int maxSpeed() const Q_DECL_OVERRIDE;
     bool canChangeFrequency() const Q_DECL_OVERRIDE;
     Solid::Processor::InstructionSets instructionSets() const Q_DECL_OVERRIDE;
+    int packageId() const Q_DECL_OVERRIDE;
+    int dieId() const Q_DECL_OVERRIDE;
+    int coreId() const Q_DECL_OVERRIDE;
+    int numaNode() const Q_DECL_OVERRIDE;
+    QList<int> siblings() const Q_DECL_OVERRIDE;
+    QList<Solid::Processor::Cache> caches() const Q_DECL_OVERRIDE;
+    Solid::Processor::CoreClass coreClass() const Q_DECL_OVERRIDE;
+    int capacity() const Q_DECL_OVERRIDE;
+    bool isUsable() const Q_DECL_OVERRIDE;
+    qreal cpuQuota() const Q_DECL_OVERRIDE;
 
 private:
     enum CanChangeFrequencyEnum {
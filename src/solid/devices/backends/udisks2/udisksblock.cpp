@@ -29,11 +29,9 @@
 #endif
 
 #include <QFile>
-#include <QtDBus/QDBusConnection>
-#include <QtDBus/QDBusPendingReply>
-#include <QtXml/QDomDocument>
 
 #include "udisksblock.h"
+#include "udisksmanager.h"
 
 using namespace Solid::Backends::UDisks2;
 
@@ -45,31 +43,11 @@ Block::Block(Device *dev)
 
     // we have a drive (non-block device for udisks), so let's find the corresponding (real) block device
     if (m_devNum == 0 || m_devFile.isEmpty()) {
-        const QString path = "/org/freedesktop/UDisks2/block_devices";
-        QDBusMessage call = QDBusMessage::createMethodCall(UD2_DBUS_SERVICE, path,
-                            DBUS_INTERFACE_INTROSPECT, "Introspect");
-        QDBusPendingReply<QString> reply = QDBusConnection::systemBus().asyncCall(call);
-        reply.waitForFinished();
-
-        if (reply.isValid()) {
-            QDomDocument dom;
-            dom.setContent(reply.value());
-            QDomNodeList nodeList = dom.documentElement().elementsByTagName("node");
-            for (int i = 0; i < nodeList.count(); i++) {
-                QDomElement nodeElem = nodeList.item(i).toElement();
-                if (!nodeElem.isNull() && nodeElem.hasAttribute("name")) {
-                    const QString udi = path + "/" + nodeElem.attribute("name");
-
-                    Device device(udi);
-                    if (device.drivePath() == dev->udi()) {
-                        m_devNum = device.prop("DeviceNumber").toULongLong();
-                        m_devFile = QFile::decodeName(device.prop("Device").toByteArray());
-                        break;
-                    }
-                }
-            }
-        } else {
-            qWarning() << "Failed enumerating UDisks2 objects:" << reply.error().name() << "\n" << reply.error().message();
+        const QString blockUdi = Manager::primaryBlockDevice(dev->udi());
+        if (!blockUdi.isEmpty()) {
+            Device device(blockUdi);
+            m_devNum = device.prop("DeviceNumber").toULongLong();
+            m_devFile = QFile::decodeName(device.prop("Device").toByteArray());
         }
     }
 
@@ -0,0 +1,389 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "udiskscontenttypescache.h"
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QStandardPaths>
+
+using namespace Solid::Backends::UDisks2;
+
+/* Bump whenever Header or Slot change, processes using another layout get another file */
+static const int LayoutVersion = 2;
+static const int DefaultCapacity = 1024;
+/* Slots looked at for a disc, starting from the one it hashes to */
+static const quint32 MaxProbes = 8;
+/* A reader gives up on a slot, reporting a miss, rather than wait on a writer */
+static const int MaxReadAttempts = 4;
+/* Writers hold a slot for a handful of stores, one seen holding it this long
+ * apart died on it and the slot is taken over */
+static const qint64 StuckWriterMsecs = 10;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "the table is shared between processes, its atomics must not use locks");
+
+struct ContentTypesCache::Header {
+    std::atomic<quint32> clock;
+    quint32 reserved[15];
+};
+
+/* Version is the clock when the slot was written, 0 while it never was */
+enum SlotField { Version, Content, LabelHash, DetectTimeHigh, DetectTimeLow, SizeHigh, SizeLow, FieldCount };
+
+struct ContentTypesCache::Slot {
+    /* odd while a writer owns the slot */
+    std::atomic<quint32> sequence;
+    std::atomic<quint32> fields[FieldCount];
+};
+
+namespace
+{
+struct Entry {
+    quint32 version;
+    quint32 content;
+    quint32 labelHash;
+    quint64 detectTime;
+    quint64 size;
+};
+}
+
+static quint64 mix(quint64 value)
+{
+    value ^= value >> 33;
+    value *= Q_UINT64_C(0xff51afd7ed558ccd);
+    value ^= value >> 33;
+    return value;
+}
+
+static bool readSlot(const std::atomic<quint32> &sequence, const std::atomic<quint32> *fields, Entry *entry)
+{
+    for (int attempt = 0; attempt < MaxReadAttempts; ++attempt) {
+        const quint32 before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+
+        entry->version = fields[Version].load(std::memory_order_relaxed);
+        entry->content = fields[Content].load(std::memory_order_relaxed);
+        entry->labelHash = fields[LabelHash].load(std::memory_order_relaxed);
+        entry->detectTime = quint64(fields[DetectTimeHigh].load(std::memory_order_relaxed)) << 32
+                            | fields[DetectTimeLow].load(std::memory_order_relaxed);
+        entry->size = quint64(fields[SizeHigh].load(std::memory_order_relaxed)) << 32
+                      | fields[SizeLow].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void storeFields(std::atomic<quint32> *fields, const Entry &entry)
+{
+    fields[Version].store(entry.version, std::memory_order_relaxed);
+    fields[Content].store(entry.content, std::memory_order_relaxed);
+    fields[LabelHash].store(entry.labelHash, std::memory_order_relaxed);
+    fields[DetectTimeHigh].store(quint32(entry.detectTime >> 32), std::memory_order_relaxed);
+    fields[DetectTimeLow].store(quint32(entry.detectTime), std::memory_order_relaxed);
+    fields[SizeHigh].store(quint32(entry.size >> 32), std::memory_order_relaxed);
+    fields[SizeLow].store(quint32(entry.size), std::memory_order_relaxed);
+}
+
+static bool writeSlot(std::atomic<quint32> &sequence, std::atomic<quint32> *fields, const Entry &entry)
+{
+    quint32 before = sequence.load(std::memory_order_relaxed);
+    if ((before & 1) || !sequence.compare_exchange_strong(before, before + 1, std::memory_order_acquire)) {
+        // Somebody else is writing it, the cache is best effort
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    storeFields(fields, entry);
+
+    // Fails if the slot got taken over, we were too slow
+    quint32 owned = before + 1;
+    return sequence.compare_exchange_strong(owned, before + 2, std::memory_order_release);
+}
+
+/*
+ * Takes over a slot left odd by a writer that died, which would otherwise
+ * stay unusable for as long as the file exists. The slot moves on to the
+ * next odd value, so readers keep off it until the entry is rewritten.
+ */
+static bool reclaimSlot(std::atomic<quint32> &sequence, quint32 stuck, std::atomic<quint32> *fields, const Entry &entry)
+{
+    if (!sequence.compare_exchange_strong(stuck, stuck + 2, std::memory_order_acquire)) {
+        // Written since, or another process got there first
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    storeFields(fields, entry);
+
+    quint32 owned = stuck + 2;
+    return sequence.compare_exchange_strong(owned, stuck + 3, std::memory_order_release);
+}
+
+ContentTypesCache::ContentTypesCache(const QString &fileName, int capacity)
+    : m_header(nullptr)
+    , m_slots(nullptr)
+    , m_mask(0)
+    , m_mappedSize(0)
+    , m_shared(false)
+    , m_nextStuckSlot(0)
+{
+    memset(m_stuckSlots, 0, sizeof(m_stuckSlots));
+    map(fileName, capacity);
+}
+
+ContentTypesCache::ContentTypesCache()
+    : m_header(nullptr)
+    , m_slots(nullptr)
+    , m_mask(0)
+    , m_mappedSize(0)
+    , m_shared(false)
+    , m_nextStuckSlot(0)
+{
+    memset(m_stuckSlots, 0, sizeof(m_stuckSlots));
+    const int capacity = defaultCapacity();
+    map(defaultFileName(capacity), capacity);
+}
+
+ContentTypesCache::~ContentTypesCache()
+{
+    if (m_header) {
+        munmap(m_header, m_mappedSize);
+    }
+}
+
+void ContentTypesCache::map(const QString &fileName, int capacity)
+{
+    quint32 slots = MaxProbes;
+    while (slots < quint32(capacity)) {
+        slots <<= 1;
+    }
+    m_mask = slots - 1;
+    m_mappedSize = sizeof(Header) + slots * sizeof(Slot);
+
+    void *memory = MAP_FAILED;
+    const int fd = fileName.isEmpty() ? -1 : open(QFile::encodeName(fileName).constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd >= 0) {
+        // A new file is sized by whoever gets there first, zeroes being an empty table.
+        // The layout and the capacity are in the name, so any other size is not ours to touch.
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size == 0) {
+            if (ftruncate(fd, m_mappedSize) != 0) {
+                qWarning("Could not size the optical disc cache %s", qPrintable(fileName));
+            }
+        }
+        if (fstat(fd, &st) == 0 && size_t(st.st_size) == m_mappedSize) {
+            memory = mmap(nullptr, m_mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+    }
+
+    m_shared = memory != MAP_FAILED;
+    if (!m_shared) {
+        memory = mmap(nullptr, m_mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (memory == MAP_FAILED) {
+        m_mask = 0;
+        m_mappedSize = 0;
+        return;
+    }
+
+    m_header = static_cast<Header *>(memory);
+    m_slots = reinterpret_cast<Slot *>(m_header + 1);
+}
+
+static Entry entryFor(quint64 detectTime, quint64 size, uint labelHash)
+{
+    Entry entry;
+    entry.version = 0;
+    entry.content = 0;
+    entry.labelHash = labelHash;
+    entry.detectTime = detectTime;
+    entry.size = size;
+    return entry;
+}
+
+static bool sameDisc(const Entry &a, const Entry &b)
+{
+    return a.detectTime == b.detectTime && a.size == b.size && a.labelHash == b.labelHash;
+}
+
+static qint64 monotonicMsecs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return qint64(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
+ContentTypesCache::StuckSlot *ContentTypesCache::findStuckSlot(quint32 index)
+{
+    for (int i = 0; i < MaxStuckSlots; ++i) {
+        // Sequence 0 is even, so never that of a stuck slot
+        if (m_stuckSlots[i].sequence != 0 && m_stuckSlots[i].index == index) {
+            return &m_stuckSlots[i];
+        }
+    }
+    return nullptr;
+}
+
+bool ContentTypesCache::find(const OpticalDisc::Identity &identity, Solid::OpticalDisc::ContentTypes *content) const
+{
+    if (!m_slots) {
+        return false;
+    }
+
+    const Entry key = entryFor(identity.m_detectTime, identity.m_size, identity.m_labelHash);
+    const quint32 start = quint32(mix(key.detectTime ^ mix(key.size ^ key.labelHash)));
+
+    for (quint32 i = 0; i < MaxProbes; ++i) {
+        const Slot &slot = m_slots[(start + i) & m_mask];
+        Entry entry;
+        if (!readSlot(slot.sequence, slot.fields, &entry)) {
+            continue;
+        }
+
+        // Slots are never emptied, the disc would have been stored here
+        if (entry.version == 0) {
+            return false;
+        }
+
+        if (sameDisc(entry, key)) {
+            *content = Solid::OpticalDisc::ContentTypes(int(entry.content));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ContentTypesCache::add(const OpticalDisc::Identity &identity, Solid::OpticalDisc::ContentTypes content)
+{
+    if (!m_slots) {
+        return;
+    }
+
+    Entry key = entryFor(identity.m_detectTime, identity.m_size, identity.m_labelHash);
+    const quint32 start = quint32(mix(key.detectTime ^ mix(key.size ^ key.labelHash)));
+
+    // The same disc, else the first free slot, else one a dead writer left
+    // behind, else the one written the longest ago
+    Slot *target = nullptr;
+    Slot *stuck = nullptr;
+    quint32 stuckSequence = 0;
+    bool reusable = false;
+    quint32 oldest = 0;
+    const qint64 now = monotonicMsecs();
+    for (quint32 i = 0; i < MaxProbes; ++i) {
+        const quint32 index = (start + i) & m_mask;
+        Slot &slot = m_slots[index];
+        Entry entry;
+        if (!readSlot(slot.sequence, slot.fields, &entry)) {
+            // Stuck if it was already odd with the same value a while ago
+            const quint32 sequence = slot.sequence.load(std::memory_order_relaxed);
+            if (!(sequence & 1)) {
+                continue;
+            }
+            StuckSlot *seen = findStuckSlot(index);
+            if (!seen || seen->sequence != sequence) {
+                if (!seen) {
+                    seen = &m_stuckSlots[m_nextStuckSlot];
+                    m_nextStuckSlot = (m_nextStuckSlot + 1) % MaxStuckSlots;
+                }
+                seen->index = index;
+                seen->sequence = sequence;
+                seen->since = now;
+            } else if (!stuck && now - seen->since >= StuckWriterMsecs) {
+                stuck = &slot;
+                stuckSequence = sequence;
+            }
+            continue;
+        }
+
+        if (entry.version == 0 || sameDisc(entry, key)) {
+            target = &slot;
+            reusable = true;
+            break;
+        }
+
+        // Wrap-around safe comparison of the versions
+        if (!target || qint32(entry.version - oldest) < 0) {
+            target = &slot;
+            oldest = entry.version;
+        }
+    }
+
+    if (!target && !stuck) {
+        return;
+    }
+
+    do {
+        key.version = m_header->clock.fetch_add(1, std::memory_order_relaxed) + 1;
+    } while (key.version == 0);
+    key.content = quint32(content);
+
+    if (!reusable && stuck && reclaimSlot(stuck->sequence, stuckSequence, stuck->fields, key)) {
+        return;
+    }
+    if (target) {
+        writeSlot(target->sequence, target->fields, key);
+    }
+}
+
+int ContentTypesCache::capacity() const
+{
+    return m_slots ? int(m_mask + 1) : 0;
+}
+
+bool ContentTypesCache::isShared() const
+{
+    return m_shared;
+}
+
+int ContentTypesCache::defaultCapacity()
+{
+    bool ok = false;
+    const int capacity = qgetenv("SOLID_OPTICAL_CACHE_SIZE").toInt(&ok);
+    return ok && capacity > 0 ? capacity : DefaultCapacity;
+}
+
+QString ContentTypesCache::defaultFileName(int capacity)
+{
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (directory.isEmpty()) {
+        return QString();
+    }
+
+    return directory + QStringLiteral("/solid-optical-content-%1-%2").arg(LayoutVersion).arg(capacity);
+}
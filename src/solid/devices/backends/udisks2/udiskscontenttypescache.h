@@ -0,0 +1,103 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UDISKS2CONTENTTYPESCACHE_H
+#define UDISKS2CONTENTTYPESCACHE_H
+
+#include <solid/opticaldisc.h>
+
+#include <QtCore/QString>
+
+#include "udisksopticaldisc.h"
+
+namespace Solid
+{
+namespace Backends
+{
+namespace UDisks2
+{
+
+/**
+ * Content types of the optical discs probed so far, shared by all the
+ * processes of a user through a file mapped from XDG_RUNTIME_DIR.
+ *
+ * The file holds an open-addressed hash table. Every slot is guarded by a
+ * sequence counter: writers claim a slot by making its counter odd, readers
+ * never wait and only retry when the counter moved under them. When all the
+ * slots a disc may hash to are taken, the one written the longest ago gets
+ * evicted, every write being stamped with a process-wide version. A slot
+ * add() finds odd with the same counter again well after its writer should
+ * be done, because the writer died on it, gets taken over.
+ *
+ * The table lives in private memory if the file cannot be mapped, the cache
+ * then only serves the current process.
+ */
+class ContentTypesCache
+{
+public:
+    /**
+     * @param fileName the file to share the table through
+     * @param capacity number of slots, rounded up to a power of two
+     */
+    ContentTypesCache(const QString &fileName, int capacity);
+    ContentTypesCache();
+    ~ContentTypesCache();
+
+    bool find(const OpticalDisc::Identity &identity, Solid::OpticalDisc::ContentTypes *content) const;
+    void add(const OpticalDisc::Identity &identity, Solid::OpticalDisc::ContentTypes content);
+
+    int capacity() const;
+    bool isShared() const;
+
+    /**
+     * The number of slots, SOLID_OPTICAL_CACHE_SIZE when set.
+     */
+    static int defaultCapacity();
+    static QString defaultFileName(int capacity);
+
+private:
+    struct Header;
+    struct Slot;
+    struct StuckSlot {
+        quint32 index;
+        quint32 sequence;
+        qint64 since;
+    };
+    enum { MaxStuckSlots = 8 };
+
+    void map(const QString &fileName, int capacity);
+    StuckSlot *findStuckSlot(quint32 index);
+
+    Header *m_header;
+    Slot *m_slots;
+    quint32 m_mask;
+    size_t m_mappedSize;
+    bool m_shared;
+    // The last slots add() found odd, to tell the dead writers. A plain
+    // array: add() runs in forked processes that must not allocate.
+    StuckSlot m_stuckSlots[MaxStuckSlots];
+    int m_nextStuckSlot;
+};
+
+}
+}
+}
+
+#endif // UDISKS2CONTENTTYPESCACHE_H
@@ -23,7 +23,6 @@
 #include "udisksdevicebackend.h"
 
 #include <QtDBus/QDBusConnection>
-#include <QtDBus/QDBusInterface>
 #include <QtXml/QDomDocument>
 
 #include "solid/deviceinterface.h"
@@ -32,7 +31,7 @@
 using namespace Solid::Backends::UDisks2;
 
 /* Static cache for DeviceBackends for all UDIs */
-QMap<QString /* UDI */, DeviceBackend *> DeviceBackend::s_backends;
+QHash<QString /* UDI */, DeviceBackend *> DeviceBackend::s_backends;
 
 DeviceBackend *DeviceBackend::backendForUDI(const QString &udi, bool create)
 {
@@ -51,6 +50,24 @@ DeviceBackend *DeviceBackend::backendForUDI(const QString &udi, bool create)
     return backend;
 }
 
+DeviceBackend *DeviceBackend::backendForUDI(const QString &udi, const VariantMapMap &interfaces_and_properties)
+{
+    DeviceBackend *backend = nullptr;
+    if (udi.isEmpty()) {
+        return backend;
+    }
+
+    if (s_backends.contains(udi)) {
+        backend = s_backends.value(udi);
+        backend->setInterfacesAndProperties(interfaces_and_properties);
+    } else {
+        backend = new DeviceBackend(udi, interfaces_and_properties);
+        s_backends.insert(udi, backend);
+    }
+
+    return backend;
+}
+
 void DeviceBackend::destroyBackend(const QString &udi)
 {
     if (s_backends.contains(udi)) {
@@ -61,23 +78,19 @@ void DeviceBackend::destroyBackend(const QString &udi)
 }
 
 DeviceBackend::DeviceBackend(const QString &udi)
-    : m_udi(udi)
+    : m_propertiesLoaded(false)
+    , m_udi(udi)
 {
     //qDebug() << "Creating backend for device" << m_udi;
-    m_device = new QDBusInterface(UD2_DBUS_SERVICE, m_udi,
-                                  QString(), // no interface, we aggregate them
-                                  QDBusConnection::systemBus(), this);
-
-    if (m_device->isValid()) {
-        QDBusConnection::systemBus().connect(UD2_DBUS_SERVICE, m_udi, DBUS_INTERFACE_PROPS, "PropertiesChanged", this,
-                                             SLOT(slotPropertiesChanged(QString,QVariantMap,QStringList)));
-        QDBusConnection::systemBus().connect(UD2_DBUS_SERVICE, UD2_DBUS_PATH, DBUS_INTERFACE_MANAGER, "InterfacesAdded",
-                                             this, SLOT(slotInterfacesAdded(QDBusObjectPath,VariantMapMap)));
-        QDBusConnection::systemBus().connect(UD2_DBUS_SERVICE, UD2_DBUS_PATH, DBUS_INTERFACE_MANAGER, "InterfacesRemoved",
-                                             this, SLOT(slotInterfacesRemoved(QDBusObjectPath,QStringList)));
+    initInterfaces();
+}
 
-        initInterfaces();
-    }
+DeviceBackend::DeviceBackend(const QString &udi, const VariantMapMap &interfaces_and_properties)
+    : m_propertiesLoaded(false)
+    , m_udi(udi)
+{
+    //qDebug() << "Creating backend for device" << m_udi << "from the ObjectManager snapshot";
+    setInterfacesAndProperties(interfaces_and_properties);
 }
 
 DeviceBackend::~DeviceBackend()
@@ -127,6 +140,11 @@ QVariant DeviceBackend::prop(const QString &key) const
     return m_propertyCache.value(key);
 }
 
+QVariant DeviceBackend::cachedProp(const QString &key) const
+{
+    return m_propertyCache.value(key);
+}
+
 bool DeviceBackend::propertyExists(const QString &key) const
 {
     checkCache(key);
@@ -136,27 +154,110 @@ bool DeviceBackend::propertyExists(const QString &key) const
 }
 
 QVariantMap DeviceBackend::allProperties() const
+{
+    if (!m_propertiesLoaded) {
+        reloadProperties();
+    }
+
+    return m_propertyCache;
+}
+
+void DeviceBackend::reloadProperties() const
 {
     QDBusMessage call = QDBusMessage::createMethodCall(UD2_DBUS_SERVICE, m_udi, DBUS_INTERFACE_PROPS, "GetAll");
 
+    bool complete = true;
     Q_FOREACH (const QString &iface, m_interfaces) {
         call.setArguments(QVariantList() << iface);
         QDBusPendingReply<QVariantMap> reply = QDBusConnection::systemBus().call(call);
 
         if (reply.isValid()) {
-            m_propertyCache.unite(reply.value());
+            const QVariantMap props = reply.value();
+            for (QVariantMap::const_iterator it = props.constBegin(); it != props.constEnd(); ++it) {
+                m_propertyCache.insert(it.key(), it.value());
+            }
+            m_interfaceProperties.insert(iface, props.keys());
         } else {
             qWarning() << "Error getting props:" << reply.error().name() << reply.error().message();
+            complete = false;
         }
         //qDebug() << "After iface" << iface << ", cache now contains" << m_cache.size() << "items";
     }
 
-    return m_propertyCache;
+    m_invalidatedProperties.clear();
+    m_propertiesLoaded = complete;
+}
+
+void DeviceBackend::setInterfacesAndProperties(const VariantMapMap &interfaces_and_properties)
+{
+    m_interfaces.clear();
+    m_interfaceProperties.clear();
+    m_invalidatedProperties.clear();
+    m_propertyCache.clear();
+
+    addInterfaces(interfaces_and_properties);
+
+    /* The ObjectManager hands out every property of every interface */
+    m_propertiesLoaded = true;
 }
 
 void DeviceBackend::invalidateProperties()
 {
     m_propertyCache.clear();
+    m_interfaceProperties.clear();
+    m_invalidatedProperties.clear();
+    m_propertiesLoaded = false;
+}
+
+void DeviceBackend::invalidateProperties(const QStringList &keys)
+{
+    Q_FOREACH (const QString &key, keys) {
+        m_propertyCache.remove(key);
+        m_invalidatedProperties.insert(key);
+    }
+}
+
+void DeviceBackend::addInterfaces(const VariantMapMap &interfaces_and_properties)
+{
+    for (VariantMapMap::const_iterator it = interfaces_and_properties.constBegin(); it != interfaces_and_properties.constEnd(); ++it) {
+        const QString &iface = it.key();
+        /* Accept only org.freedesktop.UDisks2.* interfaces so that when the device is unplugged,
+         * m_interfaces goes empty and we can easily verify that the device is gone. */
+        if (!iface.startsWith(UD2_DBUS_SERVICE)) {
+            continue;
+        }
+
+        if (!m_interfaces.contains(iface)) {
+            m_interfaces.append(iface);
+        }
+
+        const QVariantMap &props = it.value();
+        for (QVariantMap::const_iterator prop = props.constBegin(); prop != props.constEnd(); ++prop) {
+            m_propertyCache.insert(prop.key(), prop.value());
+            m_invalidatedProperties.remove(prop.key());
+        }
+        m_interfaceProperties.insert(iface, props.keys());
+    }
+}
+
+void DeviceBackend::removeInterfaces(const QStringList &interfaces)
+{
+    Q_FOREACH (const QString &iface, interfaces) {
+        m_interfaces.removeAll(iface);
+
+        Q_FOREACH (const QString &key, m_interfaceProperties.take(iface)) {
+            m_propertyCache.remove(key);
+
+            /* Names like Size are shared between interfaces; the cached value may have
+             * come from the one going away, so fetch it again from those remaining. */
+            for (QMap<QString, QStringList>::const_iterator it = m_interfaceProperties.constBegin(); it != m_interfaceProperties.constEnd(); ++it) {
+                if (it.value().contains(key)) {
+                    m_invalidatedProperties.insert(key);
+                    break;
+                }
+            }
+        }
+    }
 }
 
 QString DeviceBackend::introspect() const
@@ -174,14 +275,21 @@ QString DeviceBackend::introspect() const
 
 void DeviceBackend::checkCache(const QString &key) const
 {
-    if (m_propertyCache.isEmpty()) { // recreate the cache
-        allProperties();
+    if (!m_propertiesLoaded) { // recreate the cache
+        reloadProperties();
     }
 
     if (m_propertyCache.contains(key)) {
         return;
     }
 
+    /* A complete cache is kept current from the PropertiesChanged and InterfacesAdded
+     * signals, so a key missing from it does not exist unless it got invalidated. */
+    if (m_propertiesLoaded && !m_invalidatedProperties.contains(key)) {
+        return;
+    }
+    m_invalidatedProperties.remove(key);
+
     QDBusMessage call = QDBusMessage::createMethodCall(UD2_DBUS_SERVICE, m_udi, DBUS_INTERFACE_PROPS, "Get");
     /*
      * Interface is set to an empty string as in this QDBusInterface is a meta-object of multiple interfaces on the same path
@@ -197,7 +305,7 @@ void DeviceBackend::checkCache(const QString &key) const
     m_propertyCache.insert(key, reply.value());
 }
 
-void DeviceBackend::slotPropertiesChanged(const QString &ifaceName, const QVariantMap &changedProps, const QStringList &invalidatedProps)
+void DeviceBackend::updateProperties(const QString &ifaceName, const QVariantMap &changedProps, const QStringList &invalidatedProps)
 {
     if (!ifaceName.startsWith(UD2_DBUS_SERVICE)) {
         return;
@@ -208,6 +316,7 @@ void DeviceBackend::slotPropertiesChanged(const QString &ifaceName, const QVaria
 
     Q_FOREACH (const QString &key, invalidatedProps) {
         m_propertyCache.remove(key);
+        m_invalidatedProperties.insert(key);
         changeMap.insert(key, Solid::GenericInterface::PropertyModified);
         //qDebug() << "\t invalidated:" << key;
     }
@@ -217,6 +326,10 @@ void DeviceBackend::slotPropertiesChanged(const QString &ifaceName, const QVaria
         i.next();
         const QString key = i.key();
         m_propertyCache.insert(key, i.value());  // replace the value
+        m_invalidatedProperties.remove(key);
+        if (!m_interfaceProperties.value(ifaceName).contains(key)) {
+            m_interfaceProperties[ifaceName].append(key);
+        }
         changeMap.insert(key, Solid::GenericInterface::PropertyModified);
         //qDebug() << "\t modified:" << key << ":" << m_propertyCache.value(key);
     }
@@ -224,28 +337,3 @@ void DeviceBackend::slotPropertiesChanged(const QString &ifaceName, const QVaria
     emit propertyChanged(changeMap);
     emit changed();
 }
-
-void DeviceBackend::slotInterfacesAdded(const QDBusObjectPath &object_path, const VariantMapMap &interfaces_and_properties)
-{
-    if (object_path.path() != m_udi) {
-        return;
-    }
-
-    Q_FOREACH (const QString &iface, interfaces_and_properties.keys()) {
-        /* Don't store generic DBus interfaces */
-        if (iface.startsWith(UD2_DBUS_SERVICE)) {
-            m_interfaces.append(iface);
-        }
-    }
-}
-
-void DeviceBackend::slotInterfacesRemoved(const QDBusObjectPath &object_path, const QStringList &interfaces)
-{
-    if (object_path.path() != m_udi) {
-        return;
-    }
-
-    Q_FOREACH (const QString &iface, interfaces) {
-        m_interfaces.removeAll(iface);
-    }
-}
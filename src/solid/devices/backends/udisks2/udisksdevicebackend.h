@@ -26,7 +26,8 @@
 #include <QObject>
 #include <QtDBus/QDBusConnection>
 #include <QtDBus/QDBusObjectPath>
-#include <QtDBus/QDBusInterface>
+#include <QHash>
+#include <QSet>
 #include <QStringList>
 
 #include "udisks2.h"
@@ -45,40 +46,52 @@ class DeviceBackend: public QObject
 
 public:
     static DeviceBackend *backendForUDI(const QString &udi, bool create = true);
+    static DeviceBackend *backendForUDI(const QString &udi, const VariantMapMap &interfaces_and_properties);
     static void destroyBackend(const QString &udi);
 
     DeviceBackend(const QString &udi);
+    DeviceBackend(const QString &udi, const VariantMapMap &interfaces_and_properties);
     ~DeviceBackend();
 
     QVariant prop(const QString &key) const;
+    /* What is known of key without asking the service, invalid if nothing */
+    QVariant cachedProp(const QString &key) const;
     bool propertyExists(const QString &key) const;
     QVariantMap allProperties() const;
+    void reloadProperties() const;
 
     QStringList interfaces() const;
     const QString &udi() const;
 
+    void setInterfacesAndProperties(const VariantMapMap &interfaces_and_properties);
     void invalidateProperties();
+    void invalidateProperties(const QStringList &keys);
+
+    /* Fed by the signal dispatcher of UDisks2::Manager */
+    void addInterfaces(const VariantMapMap &interfaces_and_properties);
+    void removeInterfaces(const QStringList &interfaces);
+    void updateProperties(const QString &ifaceName, const QVariantMap &changedProps, const QStringList &invalidatedProps);
+
 Q_SIGNALS:
     void propertyChanged(const QMap<QString, int> &changeMap);
     void changed();
 
-private Q_SLOTS:
-    void slotInterfacesAdded(const QDBusObjectPath &object_path, const VariantMapMap &interfaces_and_properties);
-    void slotInterfacesRemoved(const QDBusObjectPath &object_path, const QStringList &interfaces);
-    void slotPropertiesChanged(const QString &ifaceName, const QVariantMap &changedProps, const QStringList &invalidatedProps);
-
 private:
     void initInterfaces();
     QString introspect() const;
     void checkCache(const QString &key) const;
 
-    QDBusInterface *m_device;
-
     mutable QVariantMap m_propertyCache;
+    /* Keys of m_propertyCache provided by each interface, so they can be dropped with it */
+    mutable QMap<QString, QStringList> m_interfaceProperties;
+    /* Keys invalidated by PropertiesChanged, fetched again on next access */
+    mutable QSet<QString> m_invalidatedProperties;
+    /* Whether m_propertyCache holds all the properties of all the interfaces */
+    mutable bool m_propertiesLoaded;
     QStringList m_interfaces;
     QString m_udi;
 
-    static QMap<QString, DeviceBackend *> s_backends;
+    static QHash<QString, DeviceBackend *> s_backends;
 
 };
 
@@ -23,18 +23,24 @@
 
 #include <QtCore/QDebug>
 #include <QtDBus>
-#include <QtXml/QDomDocument>
 
 #include "../shared/rootdevice.h"
 
 using namespace Solid::Backends::UDisks2;
 using namespace Solid::Backends::Shared;
 
+/* Block devices of each drive, and the other way round */
+QHash<QString, QSet<QString> > Manager::s_driveBlocks;
+QHash<QString, QString> Manager::s_blockDrives;
+
 Manager::Manager(QObject *parent)
     : Solid::Ifaces::DeviceManager(parent),
       m_manager(UD2_DBUS_SERVICE,
                 UD2_DBUS_PATH,
-                QDBusConnection::systemBus())
+                QDBusConnection::systemBus()),
+      m_matchRules(0),
+      m_dispatchedSignals(0),
+      m_indexedDevices(0)
 {
     m_supportedInterfaces
             << Solid::DeviceInterface::GenericInterface
@@ -66,19 +72,33 @@ Manager::Manager(QObject *parent)
     }
 
     if (serviceFound) {
-        connect(&m_manager, SIGNAL(InterfacesAdded(QDBusObjectPath,VariantMapMap)),
-                this, SLOT(slotInterfacesAdded(QDBusObjectPath,VariantMapMap)));
-        connect(&m_manager, SIGNAL(InterfacesRemoved(QDBusObjectPath,QStringList)),
-                this, SLOT(slotInterfacesRemoved(QDBusObjectPath,QStringList)));
+        /* One subscription of each kind for the whole service: the signals are routed
+         * to the right DeviceBackend from here, instead of every backend registering
+         * its own match rules and filtering out the signals of all the other objects. */
+        if (connect(&m_manager, SIGNAL(InterfacesAdded(QDBusObjectPath,VariantMapMap)),
+                    this, SLOT(slotInterfacesAdded(QDBusObjectPath,VariantMapMap)))) {
+            m_matchRules++;
+        }
+        if (connect(&m_manager, SIGNAL(InterfacesRemoved(QDBusObjectPath,QStringList)),
+                    this, SLOT(slotInterfacesRemoved(QDBusObjectPath,QStringList)))) {
+            m_matchRules++;
+        }
+        /* QtDBus has no path_namespace matching, an empty path matches every object
+         * the UDisks2 service emits from, which amounts to the same */
+        if (QDBusConnection::systemBus().connect(UD2_DBUS_SERVICE, QString(), DBUS_INTERFACE_PROPS, "PropertiesChanged",
+                                                 this, SLOT(slotPropertiesChanged(QDBusMessage)))) {
+            m_matchRules++;
+        }
     }
 }
 
 Manager::~Manager()
 {
-    while (!m_deviceCache.isEmpty()) {
-        QString udi = m_deviceCache.takeFirst();
+    Q_FOREACH (const QString &udi, m_deviceCache) {
         DeviceBackend::destroyBackend(udi);
     }
+    s_driveBlocks.clear();
+    s_blockDrives.clear();
 }
 
 QObject *Manager::createDevice(const QString &udi)
@@ -100,81 +120,87 @@ QObject *Manager::createDevice(const QString &udi)
 
 QStringList Manager::devicesFromQuery(const QString &parentUdi, Solid::DeviceInterface::Type type)
 {
-    QStringList result;
+    if (!m_catalog.isPopulated()) {
+        allDevices();
+    }
+    return m_catalog.devices(parentUdi, type);
+}
 
-    if (!parentUdi.isEmpty()) {
-        Q_FOREACH (const QString &udi, deviceCache()) {
-            Device device(udi);
-            if (device.queryDeviceInterface(type) && device.parentUdi() == parentUdi) {
-                result << udi;
-            }
+QStringList Manager::allDevices()
+{
+    m_deviceCache.clear();
+    m_catalog.clear();
+    m_unbackedInterfaces.clear();
+    s_driveBlocks.clear();
+    s_blockDrives.clear();
+
+    /* One call fills the interfaces and property caches of all the backends,
+     * they are kept current from the ObjectManager and Properties signals afterwards */
+    QDBusPendingReply<DBUSManagerStruct> reply = m_manager.GetManagedObjects();
+    reply.waitForFinished();
+    if (reply.isError()) {
+        qWarning() << "Failed enumerating UDisks2 objects:" << reply.error().name() << "\n" << reply.error().message();
+        return QStringList();
+    }
+
+    const DBUSManagerStruct objects = reply.value();
+    for (DBUSManagerStruct::const_iterator it = objects.constBegin(); it != objects.constEnd(); ++it) {
+        const QString udi = it.key().path();
+
+        const bool isBlockDevice = udi.startsWith(UD2_DBUS_PATH_BLOCKDEVICES);
+        if (!isBlockDevice && !udi.startsWith(UD2_DBUS_PATH_DRIVES)) {
+            continue;
         }
 
-        return result;
-    } else if (type != Solid::DeviceInterface::Unknown) {
-        Q_FOREACH (const QString &udi, deviceCache()) {
+        DeviceBackend::backendForUDI(udi, it.value());
+
+        if (isBlockDevice) {
+            trackBlock(udi, it.value().value(UD2_DBUS_INTERFACE_BLOCK).value("Drive"));
+
             Device device(udi);
-            if (device.queryDeviceInterface(type)) {
-                result << udi;
+            if (device.mightBeOpticalDisc()) {
+                m_opticalCandidates.insert(udi);
+                if (!device.isOpticalDisc()) { // skip empty CD disc
+                    continue;
+                }
             }
         }
 
-        return result;
+        m_deviceCache.insert(udi);
+    }
+
+    // Indexed once all the backends are seeded, optical discs look at their drive
+    Q_FOREACH (const QString &udi, m_deviceCache) {
+        m_catalog.insert(Device(udi), m_supportedInterfaces);
     }
+    m_catalog.setPopulated(true);
 
-    return deviceCache();
+    return m_catalog.devices(QString(), Solid::DeviceInterface::Unknown);
 }
 
-QStringList Manager::allDevices()
+QSet< Solid::DeviceInterface::Type > Manager::supportedInterfaces() const
 {
-    introspect("/org/freedesktop/UDisks2/block_devices", true /*checkOptical*/);
-    introspect("/org/freedesktop/UDisks2/drives");
-
-    return m_deviceCache;
+    return m_supportedInterfaces;
 }
 
-void Manager::introspect(const QString &path, bool checkOptical)
+QString Manager::udiPrefix() const
 {
-    QDBusMessage call = QDBusMessage::createMethodCall(UD2_DBUS_SERVICE, path,
-                        DBUS_INTERFACE_INTROSPECT, "Introspect");
-    QDBusPendingReply<QString> reply = QDBusConnection::systemBus().call(call);
-
-    if (reply.isValid()) {
-        QDomDocument dom;
-        dom.setContent(reply.value());
-        QDomNodeList nodeList = dom.documentElement().elementsByTagName("node");
-        for (int i = 0; i < nodeList.count(); i++) {
-            QDomElement nodeElem = nodeList.item(i).toElement();
-            if (!nodeElem.isNull() && nodeElem.hasAttribute("name")) {
-                const QString udi = path + "/" + nodeElem.attribute("name");
-
-                if (checkOptical) {
-                    Device device(udi);
-                    if (device.mightBeOpticalDisc()) {
-                        QDBusConnection::systemBus().connect(UD2_DBUS_SERVICE, udi, DBUS_INTERFACE_PROPS, "PropertiesChanged", this,
-                                                             SLOT(slotMediaChanged(QDBusMessage)));
-                        if (!device.isOpticalDisc()) { // skip empty CD disc
-                            continue;
-                        }
-                    }
-                }
+    return UD2_UDI_DISKS_PREFIX;
+}
 
-                m_deviceCache.append(udi);
-            }
-        }
-    } else {
-        qWarning() << "Failed enumerating UDisks2 objects:" << reply.error().name() << "\n" << reply.error().message();
-    }
+int Manager::matchRules() const
+{
+    return m_matchRules;
 }
 
-QSet< Solid::DeviceInterface::Type > Manager::supportedInterfaces() const
+qulonglong Manager::dispatchedSignals() const
 {
-    return m_supportedInterfaces;
+    return m_dispatchedSignals;
 }
 
-QString Manager::udiPrefix() const
+qulonglong Manager::indexedDevices() const
 {
-    return UD2_UDI_DISKS_PREFIX;
+    return m_indexedDevices;
 }
 
 void Manager::slotInterfacesAdded(const QDBusObjectPath &object_path, const VariantMapMap &interfaces_and_properties)
@@ -188,16 +214,43 @@ void Manager::slotInterfacesAdded(const QDBusObjectPath &object_path, const Vari
 
     qDebug() << udi << "has new interfaces:" << interfaces_and_properties.keys();
 
-    updateBackend(udi);
+    /* The signal carries every property of the new interfaces, merge them
+     * rather than asking the service for what we have just been told */
+    DeviceBackend *backend = DeviceBackend::backendForUDI(udi, false);
+    if (backend) {
+        m_dispatchedSignals++;
+        backend->addInterfaces(interfaces_and_properties);
+    } else if (m_catalog.isPopulated() && !m_deviceCache.contains(udi)) {
+        /* Not in the last snapshot, so this is the whole object. Otherwise
+         * the backend is left to be created when the device is looked at. */
+        DeviceBackend::backendForUDI(udi, interfaces_and_properties);
+    } else {
+        QSet<QString> &known = m_unbackedInterfaces[udi];
+        Q_FOREACH (const QString &iface, interfaces_and_properties.keys()) {
+            if (iface.startsWith(UD2_DBUS_SERVICE)) {
+                known.insert(iface);
+            }
+        }
+    }
+
+    if (interfaces_and_properties.contains(UD2_DBUS_INTERFACE_BLOCK)) {
+        const QVariant driveProp = interfaces_and_properties.value(UD2_DBUS_INTERFACE_BLOCK).value("Drive");
+        trackBlock(udi, driveProp);
+        invalidateDriveMedia(driveProp);
+    }
 
     // new device, we don't know it yet
     if (!m_deviceCache.contains(udi)) {
-        m_deviceCache.append(udi);
+        m_deviceCache.insert(udi);
+        indexDevice(udi);
         emit deviceAdded(udi);
     }
     // re-emit in case of 2-stage devices like N9 or some Android phones
-    else if (m_deviceCache.contains(udi) && interfaces_and_properties.keys().contains(UD2_DBUS_INTERFACE_FILESYSTEM)) {
+    else if (interfaces_and_properties.contains(UD2_DBUS_INTERFACE_FILESYSTEM)) {
+        indexDevice(udi);
         emit deviceAdded(udi);
+    } else {
+        indexDevice(udi);
     }
 }
 
@@ -212,43 +265,109 @@ void Manager::slotInterfacesRemoved(const QDBusObjectPath &object_path, const QS
 
     qDebug() << udi << "lost interfaces:" << interfaces;
 
-    updateBackend(udi);
+    DeviceBackend *backend = DeviceBackend::backendForUDI(udi, false);
+    if (!backend && !m_unbackedInterfaces.contains(udi) && m_deviceCache.contains(udi)) {
+        /* Known without a record of its interfaces: ask what is left */
+        backend = DeviceBackend::backendForUDI(udi);
+    } else if (backend) {
+        m_dispatchedSignals++;
+        if (interfaces.contains(UD2_DBUS_INTERFACE_BLOCK)) {
+            invalidateDriveMedia(backend->cachedProp("Drive"));
+        }
+        backend->removeInterfaces(interfaces);
+    }
+
+    if (udi.isEmpty()) {
+        return;
+    }
 
-    Device device(udi);
+    if (interfaces.contains(UD2_DBUS_INTERFACE_BLOCK)) {
+        untrackBlock(udi);
+    }
 
-    if (!udi.isEmpty() && (interfaces.isEmpty() || device.interfaces().isEmpty())) {
-        emit deviceRemoved(udi);
-        m_deviceCache.removeAll(udi);
+    /* Only gone once none of its interfaces are left */
+    bool gone = interfaces.isEmpty();
+    if (backend) {
+        gone = gone || backend->interfaces().isEmpty();
+    } else if (m_unbackedInterfaces.contains(udi)) {
+        QSet<QString> &left = m_unbackedInterfaces[udi];
+        Q_FOREACH (const QString &iface, interfaces) {
+            left.remove(iface);
+        }
+        gone = gone || left.isEmpty();
+    } else {
+        // Never announced, there is nothing to keep
+        gone = true;
+    }
+
+    if (gone) {
+        m_unbackedInterfaces.remove(udi);
+        untrackBlock(udi);
+        if (backend || m_deviceCache.contains(udi)) {
+            emit deviceRemoved(udi);
+        }
+        m_deviceCache.remove(udi);
+        m_catalog.remove(udi);
+        m_opticalCandidates.remove(udi);
         DeviceBackend::destroyBackend(udi);
+    } else {
+        indexDevice(udi);
     }
 }
 
-void Manager::slotMediaChanged(const QDBusMessage &msg)
+void Manager::slotPropertiesChanged(const QDBusMessage &msg)
 {
+    if (msg.arguments().count() != 3) {
+        return;
+    }
+
+    const QString udi = msg.path();
+    const QString ifaceName = msg.arguments().at(0).toString();
     const QVariantMap properties = qdbus_cast<QVariantMap>(msg.arguments().at(1));
+    const QStringList invalidated = msg.arguments().at(2).toStringList();
+
+    DeviceBackend *backend = DeviceBackend::backendForUDI(udi, false);
+    if (backend) {
+        m_dispatchedSignals++;
+        backend->updateProperties(ifaceName, properties, invalidated);
+        if (affectsIndex(properties.keys() + invalidated)) {
+            indexDevice(udi);
+        }
+    }
+
+    if (ifaceName == UD2_DBUS_INTERFACE_BLOCK && properties.contains("Drive")) {
+        trackBlock(udi, properties.value("Drive"));
+    }
+
+    if (m_opticalCandidates.contains(udi)) {
+        mediaChanged(udi, properties);
+    }
+}
 
+void Manager::mediaChanged(const QString &udi, const QVariantMap &properties)
+{
     if (!properties.contains("Size")) { // react only on Size changes
         return;
     }
 
-    const QString udi = msg.path();
-    updateBackend(udi);
     qulonglong size = properties.value("Size").toULongLong();
     qDebug() << "MEDIA CHANGED in" << udi << "; size is:" << size;
 
     if (!m_deviceCache.contains(udi) && size > 0) { // we don't know the optdisc, got inserted
-        m_deviceCache.append(udi);
+        m_deviceCache.insert(udi);
+        indexDevice(udi);
         emit deviceAdded(udi);
     }
 
     if (m_deviceCache.contains(udi) && size == 0) {  // we know the optdisc, got removed
         emit deviceRemoved(udi);
-        m_deviceCache.removeAll(udi);
+        m_deviceCache.remove(udi);
+        m_catalog.remove(udi);
         DeviceBackend::destroyBackend(udi);
     }
 }
 
-const QStringList &Manager::deviceCache()
+const QSet<QString> &Manager::deviceCache()
 {
     if (m_deviceCache.isEmpty()) {
         allDevices();
@@ -257,26 +376,96 @@ const QStringList &Manager::deviceCache()
     return m_deviceCache;
 }
 
-void Manager::updateBackend(const QString &udi)
+bool Manager::affectsIndex(const QStringList &keys)
 {
-    DeviceBackend *backend = DeviceBackend::backendForUDI(udi);
-    if (!backend) {
+    /* What the catalog is keyed on: the parent (Drive, Table) and the
+     * interfaces that depend on properties rather than on D-Bus interfaces,
+     * which only change through InterfacesAdded and InterfacesRemoved */
+    static const QStringList indexKeys = QStringList() << "Drive" << "Table" << "MediaCompatibility" << "Optical";
+    Q_FOREACH (const QString &key, keys) {
+        if (indexKeys.contains(key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Manager::indexDevice(const QString &udi)
+{
+    if (!m_catalog.isPopulated() || !m_deviceCache.contains(udi)) {
         return;
     }
 
-    //This doesn't emit "changed" signals. Signals are emitted later by DeviceBackend's slots
-    backend->allProperties();
+    m_indexedDevices++;
+    const Device device(udi);
+    m_catalog.insert(device, m_supportedInterfaces);
+
+    // Whether a block device is an optical disc depends on its drive
+    if (device.isDrive()) {
+        Q_FOREACH (const QString &child, m_catalog.devices(udi, Solid::DeviceInterface::Unknown)) {
+            m_catalog.insert(Device(child), m_supportedInterfaces);
+        }
+    }
+}
+
+QString Manager::primaryBlockDevice(const QString &driveUdi)
+{
+    const QSet<QString> blocks = s_driveBlocks.value(driveUdi);
+
+    /* The whole disk rather than one of its partitions, the lowest path for
+     * a stable answer when several block devices share the drive (multipath) */
+    QString primary;
+    bool primaryIsPartition = true;
+    Q_FOREACH (const QString &block, blocks) {
+        DeviceBackend *backend = DeviceBackend::backendForUDI(block, false);
+        const bool isPartition = !backend || backend->interfaces().contains(UD2_DBUS_INTERFACE_PARTITION);
+        if (primary.isEmpty() || (primaryIsPartition && !isPartition)
+                || (primaryIsPartition == isPartition && block < primary)) {
+            primary = block;
+            primaryIsPartition = isPartition;
+        }
+    }
+    return primary;
+}
+
+void Manager::trackBlock(const QString &udi, const QVariant &driveProp)
+{
+    untrackBlock(udi);
+
+    const QString drivePath = qdbus_cast<QDBusObjectPath>(driveProp).path();
+    if (drivePath.isEmpty() || drivePath == "/") {
+        return;
+    }
+    s_blockDrives.insert(udi, drivePath);
+    s_driveBlocks[drivePath].insert(udi);
+}
 
-    QVariant driveProp = backend->prop("Drive");
-    if (!driveProp.isValid()) {
+void Manager::untrackBlock(const QString &udi)
+{
+    const QString drivePath = s_blockDrives.take(udi);
+    if (drivePath.isEmpty()) {
         return;
     }
 
-    QDBusObjectPath drivePath = qdbus_cast<QDBusObjectPath>(driveProp);
-    DeviceBackend *driveBackend = DeviceBackend::backendForUDI(drivePath.path(), false);
+    QHash<QString, QSet<QString> >::iterator it = s_driveBlocks.find(drivePath);
+    if (it != s_driveBlocks.end()) {
+        it->remove(udi);
+        if (it->isEmpty()) {
+            s_driveBlocks.erase(it);
+        }
+    }
+}
+
+void Manager::invalidateDriveMedia(const QVariant &driveProp)
+{
+    const QString drivePath = qdbus_cast<QDBusObjectPath>(driveProp).path();
+    DeviceBackend *driveBackend = DeviceBackend::backendForUDI(drivePath, false);
     if (!driveBackend) {
         return;
     }
 
-    driveBackend->invalidateProperties();
+    /* A block device coming or going on a drive is about its media, the
+     * rest of the drive is unaffected. Fetched again when next read. */
+    static const QStringList mediaKeys = QStringList() << "MediaAvailable" << "Media" << "Size" << "TimeMediaDetected";
+    driveBackend->invalidateProperties(mediaKeys);
 }
@@ -25,6 +25,7 @@
 #include "udisks2.h"
 #include "udisksdevice.h"
 #include "dbus/manager.h"
+#include "../shared/devicecatalog.h"
 
 #include <solid/devices/ifaces/devicemanager.h>
 
@@ -41,6 +42,12 @@ namespace UDisks2
 class Manager: public Solid::Ifaces::DeviceManager
 {
     Q_OBJECT
+    /* Signal subscriptions held on the system bus, independent of the number of devices */
+    Q_PROPERTY(int matchRules READ matchRules)
+    /* ObjectManager and Properties signals routed to the device backends so far */
+    Q_PROPERTY(qulonglong dispatchedSignals READ dispatchedSignals)
+    /* Devices (re)inserted into the catalog after a signal */
+    Q_PROPERTY(qulonglong indexedDevices READ indexedDevices)
 
 public:
     Manager(QObject *parent);
@@ -51,18 +58,43 @@ public:
     QString udiPrefix() const Q_DECL_OVERRIDE;
     virtual ~Manager();
 
+    int matchRules() const;
+    qulonglong dispatchedSignals() const;
+    qulonglong indexedDevices() const;
+
+    /**
+     * The block device standing for a drive object, which has neither a
+     * device file nor a device number of its own. Empty if none is known.
+     */
+    static QString primaryBlockDevice(const QString &driveUdi);
+
 private Q_SLOTS:
     void slotInterfacesAdded(const QDBusObjectPath &object_path, const VariantMapMap &interfaces_and_properties);
     void slotInterfacesRemoved(const QDBusObjectPath &object_path, const QStringList &interfaces);
-    void slotMediaChanged(const QDBusMessage &msg);
+    void slotPropertiesChanged(const QDBusMessage &msg);
 
 private:
-    const QStringList &deviceCache();
-    void introspect(const QString &path, bool checkOptical = false);
-    void updateBackend(const QString &udi);
+    const QSet<QString> &deviceCache();
+    void mediaChanged(const QString &udi, const QVariantMap &properties);
+    void invalidateDriveMedia(const QVariant &driveProp);
+    void trackBlock(const QString &udi, const QVariant &driveProp);
+    void untrackBlock(const QString &udi);
+    static bool affectsIndex(const QStringList &keys);
+    void indexDevice(const QString &udi);
     QSet<Solid::DeviceInterface::Type> m_supportedInterfaces;
     org::freedesktop::DBus::ObjectManager m_manager;
-    QStringList m_deviceCache;
+    QSet<QString> m_deviceCache;
+    Solid::Backends::Shared::DeviceCatalog m_catalog;
+    QSet<QString> m_opticalCandidates;
+    /* Interfaces of the objects announced before the snapshot, whose backend
+     * is left to be created when looked at */
+    QHash<QString, QSet<QString> > m_unbackedInterfaces;
+    int m_matchRules;
+    qulonglong m_dispatchedSignals;
+    qulonglong m_indexedDevices;
+
+    static QHash<QString, QSet<QString> > s_driveBlocks;
+    static QHash<QString, QString> s_blockDrives;
 };
 
 }
@@ -51,26 +51,42 @@ public:
     bool isBlank() const Q_DECL_OVERRIDE;
     bool isAppendable() const Q_DECL_OVERRIDE;
     Solid::OpticalDisc::DiscType discType() const Q_DECL_OVERRIDE;
+    /**
+     * While the disc is being probed only Data and Audio are reported,
+     * availableContentChanged() tells when the video content types are known.
+     */
     Solid::OpticalDisc::ContentTypes availableContent() const Q_DECL_OVERRIDE;
+    bool isContentProbePending() const Q_DECL_OVERRIDE;
 
     class Identity
     {
     public:
         Identity();
         Identity(const Device &device, const Device &drive);
+        Identity(long long detectTime, long long size, uint labelHash);
         bool operator ==(const Identity &) const;
 
     private:
+        friend class ContentTypesCache;
+
         long long m_detectTime;
         long long m_size;
         uint m_labelHash;
     };
 
+Q_SIGNALS:
+    void availableContentChanged(Solid::OpticalDisc::ContentTypes content, const QString &udi) Q_DECL_OVERRIDE;
+
+private Q_SLOTS:
+    void slotContentProbed(Solid::OpticalDisc::ContentTypes content);
+
 private:
 
     mutable Identity m_identity;
     QString media() const;
     mutable Solid::OpticalDisc::ContentTypes m_cachedContent;
+    mutable Identity m_probedIdentity;
+    mutable bool m_probePending;
     Device *m_drive;
 #if UDEV_FOUND
     UdevQt::Device m_udevDevice;
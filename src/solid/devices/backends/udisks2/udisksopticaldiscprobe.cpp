@@ -0,0 +1,169 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "udisksopticaldiscprobe.h"
+
+#include <sys/types.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include <QtCore/QThreadPool>
+#include <QtCore/QtEndian>
+
+using namespace Solid::Backends::UDisks2;
+
+/* The primary volume descriptor is in sector 16, offsets are relative to its start */
+static const off_t VolumeDescriptorOffset = 0x8000;
+static const int VolumeDescriptorSize = 2048;
+static const int BlockSizeOffset = 128;
+static const int PathTableSizeOffset = 132;
+static const int PathTableLocationOffset = 140;
+
+/* Entries are sorted by depth, the directories below the root are all at the
+   head of the table */
+static const quint32 MaxPathTableSize = 64 * 1024;
+
+static const struct {
+    const char *name;
+    Solid::OpticalDisc::ContentType content;
+    const char *description;
+} specialDirectories[] = {
+    { "VIDEO_TS", Solid::OpticalDisc::VideoDvd, "a Video DVD" },
+    { "BDMV", Solid::OpticalDisc::VideoBluRay, "a Blu-ray video disc" },
+    { "VCD", Solid::OpticalDisc::VideoCd, "a Video CD" },
+    { "SVCD", Solid::OpticalDisc::SuperVideoCd, "a Super Video CD" }
+};
+
+static ssize_t readAt(int fd, char *buffer, size_t size, off_t offset)
+{
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t n = pread(fd, buffer + done, size - done, offset + done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        done += n;
+    }
+    return done;
+}
+
+OpticalDiscProbe::OpticalDiscProbe(const QByteArray &deviceFile)
+    : m_deviceFile(deviceFile)
+{
+    qRegisterMetaType<Solid::OpticalDisc::ContentTypes>();
+    setAutoDelete(false);
+}
+
+OpticalDiscProbe::~OpticalDiscProbe()
+{
+}
+
+void OpticalDiscProbe::start()
+{
+    QThreadPool::globalInstance()->start(this);
+}
+
+void OpticalDiscProbe::run()
+{
+    emit finished(probe(m_deviceFile));
+
+    // Deleted from the thread it lives in, after the queued finished() got delivered
+    deleteLater();
+}
+
+// inspired by http://cgit.freedesktop.org/hal/tree/hald/linux/probing/probe-volume.c
+Solid::OpticalDisc::ContentTypes OpticalDiscProbe::probe(const QByteArray &deviceFile)
+{
+    const int fd = open(deviceFile.constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        qDebug("Advanced probing on %s failed while opening the device", deviceFile.constData());
+        return Solid::OpticalDisc::NoContent;
+    }
+
+    QByteArray descriptor(VolumeDescriptorSize, 0);
+    if (readAt(fd, descriptor.data(), descriptor.size(), VolumeDescriptorOffset) < PathTableLocationOffset + 4) {
+        qDebug("Advanced probing on %s failed while reading the volume descriptor", deviceFile.constData());
+        close(fd);
+        return Solid::OpticalDisc::NoContent;
+    }
+
+    const uchar *fields = reinterpret_cast<const uchar *>(descriptor.constData());
+    const quint16 blockSize = qFromLittleEndian<quint16>(fields + BlockSizeOffset);
+    const quint32 tableSize = qMin(qFromLittleEndian<quint32>(fields + PathTableSizeOffset), MaxPathTableSize);
+    const quint32 tableBlock = qFromLittleEndian<quint32>(fields + PathTableLocationOffset);
+
+    QByteArray table(tableSize, 0);
+    const ssize_t tableRead = readAt(fd, table.data(), table.size(), off_t(blockSize) * tableBlock);
+    close(fd);
+
+    if (tableRead < 0) {
+        qDebug("Advanced probing on %s failed while reading the path table", deviceFile.constData());
+        return Solid::OpticalDisc::NoContent;
+    }
+    table.truncate(tableRead);
+
+    const Solid::OpticalDisc::ContentTypes content = parsePathTable(table);
+    for (size_t i = 0; i < sizeof(specialDirectories) / sizeof(*specialDirectories); ++i) {
+        if (content == specialDirectories[i].content) {
+            qDebug("Disc in %s is %s", deviceFile.constData(), specialDirectories[i].description);
+        }
+    }
+    return content;
+}
+
+Solid::OpticalDisc::ContentTypes OpticalDiscProbe::parsePathTable(const QByteArray &table)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(table.constData());
+    const int size = table.size();
+
+    /* each entry: name length, extended attribute length, extent location (4),
+       parent entry number (2), then the name padded to an even length */
+    int pos = 0;
+    while (pos + 8 <= size) {
+        const int nameLength = data[pos];
+        const quint16 parent = qFromLittleEndian<quint16>(data + pos + 6);
+        const char *name = table.constData() + pos + 8;
+
+        if (pos + 8 + nameLength > size) {
+            break;
+        }
+
+        /* the first entry is the root directory, only its children matter */
+        if (parent == 1) {
+            for (size_t i = 0; i < sizeof(specialDirectories) / sizeof(*specialDirectories); ++i) {
+                if (uint(nameLength) == qstrlen(specialDirectories[i].name)
+                        && qstrnicmp(name, specialDirectories[i].name, nameLength) == 0) {
+                    return specialDirectories[i].content;
+                }
+            }
+        }
+
+        pos += 8 + nameLength + nameLength % 2;
+    }
+
+    return Solid::OpticalDisc::NoContent;
+}
@@ -0,0 +1,77 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UDISKS2OPTICALDISCPROBE_H
+#define UDISKS2OPTICALDISCPROBE_H
+
+#include <solid/opticaldisc.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QObject>
+#include <QtCore/QRunnable>
+
+namespace Solid
+{
+namespace Backends
+{
+namespace UDisks2
+{
+
+/**
+ * Looks for the special directories of video discs (VIDEO_TS, BDMV, VCD,
+ * SVCD) in the ISO 9660 path table of a disc.
+ *
+ * The volume descriptor and the path table are read with one pread()
+ * each and parsed from memory. start() runs the probe on the global
+ * thread pool and emits finished() when done, the object deletes itself
+ * afterwards.
+ */
+class OpticalDiscProbe : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    explicit OpticalDiscProbe(const QByteArray &deviceFile);
+    virtual ~OpticalDiscProbe();
+
+    void start();
+    void run() Q_DECL_OVERRIDE;
+
+    /**
+     * Probes the disc in deviceFile, blocking the calling thread.
+     */
+    static Solid::OpticalDisc::ContentTypes probe(const QByteArray &deviceFile);
+
+    /**
+     * Finds the content type of a disc from its raw path table.
+     */
+    static Solid::OpticalDisc::ContentTypes parsePathTable(const QByteArray &table);
+
+Q_SIGNALS:
+    void finished(Solid::OpticalDisc::ContentTypes content);
+
+private:
+    QByteArray m_deviceFile;
+};
+
+}
+}
+}
+
+#endif // UDISKS2OPTICALDISCPROBE_H
@@ -21,11 +21,11 @@
 
 #include "udisksstorageaccess.h"
 #include "udisks2.h"
+#include "soliddefs_p.h"
 
 #include <QDomDocument>
 #include <QDBusConnection>
-#include <QApplication>
-#include <QWidget>
+#include <QCoreApplication>
 
 using namespace Solid::Backends::UDisks2;
 
@@ -324,11 +324,8 @@ bool StorageAccess::requestPassphrase()
 
     QDBusConnection::sessionBus().registerObject(m_lastReturnObject, this, QDBusConnection::ExportScriptableSlots);
 
-    QWidget *activeWindow = QApplication::activeWindow();
-    uint wId = 0;
-    if (activeWindow != nullptr) {
-        wId = (uint)activeWindow->winId();
-    }
+    // Looked up by the frontend, this isn't the GUI thread
+    const uint wId = Solid::passphraseWindowId();
 
     QString appId = QCoreApplication::applicationName();
 
@@ -24,6 +24,7 @@
 #include "upowerdeviceinterface.h"
 #include "upowergenericinterface.h"
 #include "upowerbattery.h"
+#include "upowersleepmonitor.h"
 
 #include <solid/genericinterface.h>
 #include <solid/device.h>
@@ -34,32 +35,34 @@
 
 using namespace Solid::Backends::UPower;
 
+/* Device types by UDI, they never change over the lifetime of an object */
+QHash<QString, uint> UPowerDevice::s_types;
+
 UPowerDevice::UPowerDevice(const QString &udi)
     : Solid::Ifaces::Device()
-    , m_device(UP_DBUS_SERVICE,
-               udi,
-               UP_DBUS_INTERFACE_DEVICE,
-               QDBusConnection::systemBus())
     , m_udi(udi)
+    , m_getAllCallsAvoided(0)
+    , m_cacheMerged(false)
 {
-    if (m_device.isValid()) {
-        if (m_device.metaObject()->indexOfSignal("Changed()") != -1) {
-            connect(&m_device, SIGNAL(Changed()), this, SLOT(slotChanged()));
-        } else {
-            // for UPower >= 0.99.0, missing Changed() signal
-            QDBusConnection::systemBus().connect(UP_DBUS_SERVICE, m_udi, "org.freedesktop.DBus.Properties", "PropertiesChanged", this,
-                                                 SLOT(onPropertiesChanged(QString,QVariantMap,QStringList)));
-        }
-
-        // TODO port this to Solid::Power, we can't link against kdelibs4support for this signal
-        // older upower versions not affected
-        QDBusConnection::systemBus().connect("org.freedesktop.login1", "/org/freedesktop/login1", "org.freedesktop.login1.Manager", "PrepareForSleep",
-                                             this, SLOT(login1Resuming(bool)));
-    }
+    /* No QDBusInterface here: introspecting every wrapper only told which of
+     * the two change signals the daemon has, just listen to both instead */
+    // UPower < 0.99.0
+    QDBusConnection::systemBus().connect(UP_DBUS_SERVICE, m_udi, UP_DBUS_INTERFACE_DEVICE, "Changed", this,
+                                         SLOT(slotChanged()));
+    // UPower >= 0.99.0, missing Changed() signal
+    QDBusConnection::systemBus().connect(UP_DBUS_SERVICE, m_udi, "org.freedesktop.DBus.Properties", "PropertiesChanged", this,
+                                         SLOT(onPropertiesChanged(QString,QVariantMap,QStringList)));
+
+    // Resume is handled once for the whole process, see UPowerSleepMonitor
+    UPowerSleepMonitor::instance()->registerDevice(this);
 }
 
 UPowerDevice::~UPowerDevice()
 {
+    // The monitor is gone already when wrappers outlive the global statics
+    if (UPowerSleepMonitor *monitor = UPowerSleepMonitor::instance()) {
+        monitor->unregisterDevice(this);
+    }
 }
 
 QObject *UPowerDevice::createDeviceInterface(const Solid::DeviceInterface::Type &type)
@@ -82,9 +85,33 @@ QObject *UPowerDevice::createDeviceInterface(const Solid::DeviceInterface::Type
     return iface;
 }
 
+uint UPowerDevice::deviceType() const
+{
+    QHash<QString, uint>::const_iterator it = s_types.constFind(m_udi);
+    if (it != s_types.constEnd()) {
+        return *it;
+    }
+
+    const QVariant type = prop("Type");
+    if (type.isValid()) {
+        s_types.insert(m_udi, type.toUInt());
+    }
+    return type.toUInt();
+}
+
+void UPowerDevice::setCachedType(const QString &udi, uint type)
+{
+    s_types.insert(udi, type);
+}
+
+void UPowerDevice::forgetCachedType(const QString &udi)
+{
+    s_types.remove(udi);
+}
+
 bool UPowerDevice::queryDeviceInterface(const Solid::DeviceInterface::Type &type) const
 {
-    const uint uptype = prop("Type").toUInt();
+    const uint uptype = deviceType();
     switch (type) {
     case Solid::DeviceInterface::GenericInterface:
         return true;
@@ -173,16 +200,23 @@ void UPowerDevice::checkCache(const QString &key) const
 {
     if (m_cache.isEmpty()) { // recreate the cache
         allProperties();
+    } else if (m_cacheMerged) {
+        // Without the merged signals, this read would have fetched it all again
+        ++m_getAllCallsAvoided;
+        m_cacheMerged = false;
     }
 
     if (m_cache.contains(key)) {
         return;
     }
 
-    QVariant reply = m_device.property(key.toUtf8());
+    QDBusMessage call = QDBusMessage::createMethodCall(UP_DBUS_SERVICE, m_udi,
+                        "org.freedesktop.DBus.Properties", "Get");
+    call << QStringLiteral(UP_DBUS_INTERFACE_DEVICE) << key;
+    QDBusReply<QVariant> reply = QDBusConnection::systemBus().call(call);
 
     if (reply.isValid()) {
-        m_cache[key] = reply;
+        m_cache[key] = reply.value();
     } else {
         m_cache[key] = QVariant();
     }
@@ -202,11 +236,12 @@ bool UPowerDevice::propertyExists(const QString &key) const
 
 QMap<QString, QVariant> UPowerDevice::allProperties() const
 {
-    QDBusMessage call = QDBusMessage::createMethodCall(m_device.service(), m_device.path(),
+    QDBusMessage call = QDBusMessage::createMethodCall(UP_DBUS_SERVICE, m_udi,
                         "org.freedesktop.DBus.Properties", "GetAll");
-    call << m_device.interface();
+    call << QStringLiteral(UP_DBUS_INTERFACE_DEVICE);
     QDBusPendingReply< QVariantMap > reply = QDBusConnection::systemBus().asyncCall(call);
     reply.waitForFinished();
+    m_cacheMerged = false;
 
     if (reply.isValid()) {
         m_cache = reply.value();
@@ -219,27 +254,43 @@ QMap<QString, QVariant> UPowerDevice::allProperties() const
 
 void UPowerDevice::onPropertiesChanged(const QString &ifaceName, const QVariantMap &changedProps, const QStringList &invalidatedProps)
 {
-    Q_UNUSED(changedProps);
-    Q_UNUSED(invalidatedProps);
+    if (ifaceName != UP_DBUS_INTERFACE_DEVICE) {
+        return;
+    }
+
+    QMap<QString, int> changeMap;
 
-    if (ifaceName == UP_DBUS_INTERFACE_DEVICE) {
-        slotChanged(); // TODO maybe process the properties separately?
+    Q_FOREACH (const QString &key, invalidatedProps) {
+        m_cache.remove(key);
+        changeMap.insert(key, Solid::GenericInterface::PropertyModified);
+    }
+
+    // An empty cache means nothing was read yet, it gets filled as a whole on first access
+    const bool merge = !m_cache.isEmpty();
+    for (QVariantMap::const_iterator it = changedProps.constBegin(); it != changedProps.constEnd(); ++it) {
+        if (merge) {
+            m_cache.insert(it.key(), it.value());
+        }
+        changeMap.insert(it.key(), Solid::GenericInterface::PropertyModified);
     }
+
+    if (merge) {
+        m_cacheMerged = true;
+    }
+
+    emit propertyChanged(changeMap);
+    emit changed();
+}
+
+qulonglong UPowerDevice::getAllCallsAvoided() const
+{
+    return m_getAllCallsAvoided;
 }
 
 void UPowerDevice::slotChanged()
 {
     // given we cannot know which property/ies changed, clear the cache
     m_cache.clear();
+    m_cacheMerged = false;
     emit changed();
 }
-
-void UPowerDevice::login1Resuming(bool active)
-{
-    if (!active) {
-        QDBusReply<void> refreshCall = m_device.asyncCall("Refresh");
-        if (refreshCall.isValid()) {
-            slotChanged();
-        }
-    }
-}
@@ -26,7 +26,8 @@
 #include <ifaces/device.h>
 #include <solid/deviceinterface.h>
 
-#include <QtDBus/QDBusInterface>
+#include <QtDBus/QDBusConnection>
+#include <QtCore/QHash>
 #include <QtCore/QSet>
 
 namespace Solid
@@ -39,6 +40,9 @@ namespace UPower
 class UPowerDevice : public Solid::Ifaces::Device
 {
     Q_OBJECT
+    /* GetAll calls saved by merging PropertiesChanged signals into the cache:
+     * counted once on the first read after any number of merged signals */
+    Q_PROPERTY(qulonglong getAllCallsAvoided READ getAllCallsAvoided)
 public:
     UPowerDevice(const QString &udi);
     virtual ~UPowerDevice();
@@ -57,21 +61,37 @@ public:
     bool propertyExists(const QString &key) const;
     QMap<QString, QVariant> allProperties() const;
 
+    qulonglong getAllCallsAvoided() const;
+
+    /**
+     * UPower's device type (battery, UPS, mouse...), known from the
+     * process-wide cache when the manager or another wrapper already
+     * asked for it.
+     */
+    uint deviceType() const;
+    static void setCachedType(const QString &udi, uint type);
+    static void forgetCachedType(const QString &udi);
+
 Q_SIGNALS:
     void changed();
+    void propertyChanged(const QMap<QString, int> &changes);
 
 private Q_SLOTS:
     void onPropertiesChanged(const QString &ifaceName, const QVariantMap &changedProps, const QStringList &invalidatedProps);
     void slotChanged();
-    void login1Resuming(bool active);
 
 private:
     QString batteryTechnology() const;
-    mutable QDBusInterface m_device;
     QString m_udi;
     mutable QVariantMap m_cache;
+    mutable qulonglong m_getAllCallsAvoided;
+    mutable bool m_cacheMerged; // signals merged since the last read
 
     void checkCache(const QString &key) const;
+
+    static QHash<QString, uint> s_types;
+
+    friend class UPowerSleepMonitor;
 };
 
 }
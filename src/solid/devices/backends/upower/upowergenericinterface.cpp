@@ -27,6 +27,8 @@ using namespace Solid::Backends::UPower;
 GenericInterface::GenericInterface(UPowerDevice *device)
     : DeviceInterface(device)
 {
+    connect(device, SIGNAL(propertyChanged(QMap<QString,int>)),
+            this, SIGNAL(propertyChanged(QMap<QString,int>)));
 }
 
 GenericInterface::~GenericInterface()
@@ -24,12 +24,15 @@
 #include "upower.h"
 
 #include <QtDBus/QDBusReply>
+#include <QtDBus/QDBusPendingReply>
 #include <QtCore/QDebug>
 #include <QtDBus/QDBusMetaType>
 #include <QtDBus/QDBusConnectionInterface>
 
 #include "../shared/rootdevice.h"
 
+#include <algorithm>
+
 using namespace Solid::Backends::UPower;
 using namespace Solid::Backends::Shared;
 
@@ -38,7 +41,8 @@ UPowerManager::UPowerManager(QObject *parent)
       m_manager(UP_DBUS_SERVICE,
                 UP_DBUS_PATH,
                 UP_DBUS_INTERFACE,
-                QDBusConnection::systemBus())
+                QDBusConnection::systemBus()),
+      m_devicesEnumerated(false)
 {
     m_supportedInterfaces
             << Solid::DeviceInterface::GenericInterface
@@ -71,9 +75,9 @@ UPowerManager::UPowerManager(QObject *parent)
                     this, SLOT(onDeviceRemoved(QDBusObjectPath)));
         } else {
             connect(&m_manager, SIGNAL(DeviceAdded(QString)),
-                    this, SIGNAL(deviceAdded(QString)));
+                    this, SLOT(onDeviceAdded(QString)));
             connect(&m_manager, SIGNAL(DeviceRemoved(QString)),
-                    this, SIGNAL(deviceRemoved(QString)));
+                    this, SLOT(onDeviceRemoved(QString)));
         }
     }
 }
@@ -93,7 +97,7 @@ QObject *UPowerManager::createDevice(const QString &udi)
 
         return root;
 
-    } else if (allDevices().contains(udi)) {
+    } else if (devices().contains(udi)) {
         return new UPowerDevice(udi);
 
     } else {
@@ -103,57 +107,69 @@ QObject *UPowerManager::createDevice(const QString &udi)
 
 QStringList UPowerManager::devicesFromQuery(const QString &parentUdi, Solid::DeviceInterface::Type type)
 {
-    QStringList allDev = allDevices();
-    QStringList result;
-
-    if (!parentUdi.isEmpty()) {
-        Q_FOREACH (const QString &udi, allDev) {
-            if (udi == udiPrefix()) {
-                continue;
-            }
-
-            UPowerDevice device(udi);
-            if (device.queryDeviceInterface(type) && device.parentUdi() == parentUdi) {
-                result << udi;
-            }
-        }
+    if (parentUdi.isEmpty() && type == Solid::DeviceInterface::Unknown) {
+        return allDevices();
+    }
 
-        return result;
-    } else if (type != Solid::DeviceInterface::Unknown) {
-        Q_FOREACH (const QString &udi, allDev) {
-            if (udi == udiPrefix()) {
-                continue;
-            }
-
-            UPowerDevice device(udi);
-            if (device.queryDeviceInterface(type)) {
-                result << udi;
-            }
+    if (!m_catalog.isPopulated()) {
+        fetchTypes(devices().toList());
+        Q_FOREACH (const QString &udi, m_devices) {
+            m_catalog.insert(UPowerDevice(udi), m_supportedInterfaces);
         }
-
-        return result;
-    } else {
-        return allDev;
+        m_catalog.setPopulated(true);
     }
+
+    return m_catalog.devices(parentUdi, type);
 }
 
 QStringList UPowerManager::allDevices()
 {
+    QStringList retList = devices().toList();
+    std::sort(retList.begin(), retList.end());
+    retList.prepend(udiPrefix());
+
+    return retList;
+}
+
+const QSet<QString> &UPowerManager::devices()
+{
+    // Enumerated once, then kept current from DeviceAdded/DeviceRemoved
+    if (m_devicesEnumerated) {
+        return m_devices;
+    }
+
     QDBusReply<QList<QDBusObjectPath> > reply = m_manager.call("EnumerateDevices");
 
     if (!reply.isValid()) {
         qWarning() << Q_FUNC_INFO << " error: " << reply.error().name();
-        return QStringList();
+        return m_devices;
     }
 
-    QStringList retList;
-    retList << udiPrefix();
-
     Q_FOREACH (const QDBusObjectPath &path, reply.value()) {
-        retList << path.path();
+        m_devices.insert(path.path());
     }
+    m_devicesEnumerated = true;
 
-    return retList;
+    return m_devices;
+}
+
+void UPowerManager::fetchTypes(const QStringList &udis)
+{
+    // All the requests go out before waiting for any of the replies
+    QList<QDBusPendingCall> calls;
+    Q_FOREACH (const QString &udi, udis) {
+        QDBusMessage call = QDBusMessage::createMethodCall(UP_DBUS_SERVICE, udi, "org.freedesktop.DBus.Properties", "Get");
+        call << QStringLiteral(UP_DBUS_INTERFACE_DEVICE) << QStringLiteral("Type");
+        calls << QDBusConnection::systemBus().asyncCall(call);
+    }
+
+    for (int i = 0; i < calls.count(); ++i) {
+        QDBusPendingReply<QDBusVariant> reply = calls.at(i);
+        reply.waitForFinished();
+        if (reply.isValid()) {
+            UPowerDevice::setCachedType(udis.at(i), reply.value().variant().toUInt());
+        }
+    }
 }
 
 QSet< Solid::DeviceInterface::Type > UPowerManager::supportedInterfaces() const
@@ -168,11 +184,29 @@ QString UPowerManager::udiPrefix() const
 
 void UPowerManager::onDeviceAdded(const QDBusObjectPath &path)
 {
-    emit deviceAdded(path.path());
+    onDeviceAdded(path.path());
 }
 
 void UPowerManager::onDeviceRemoved(const QDBusObjectPath &path)
 {
-    emit deviceRemoved(path.path());
+    onDeviceRemoved(path.path());
+}
+
+void UPowerManager::onDeviceAdded(const QString &udi)
+{
+    m_devices.insert(udi);
+    if (m_catalog.isPopulated()) {
+        fetchTypes(QStringList() << udi);
+        m_catalog.insert(UPowerDevice(udi), m_supportedInterfaces);
+    }
+    emit deviceAdded(udi);
+}
+
+void UPowerManager::onDeviceRemoved(const QString &udi)
+{
+    m_devices.remove(udi);
+    m_catalog.remove(udi);
+    UPowerDevice::forgetCachedType(udi);
+    emit deviceRemoved(udi);
 }
 
@@ -24,6 +24,7 @@
 #define UPOWERMANAGER_H
 
 #include "solid/devices/ifaces/devicemanager.h"
+#include "../shared/devicecatalog.h"
 
 #include <QtDBus/QDBusInterface>
 #include <QtCore/QSet>
@@ -51,10 +52,18 @@ public:
 private Q_SLOTS:
     void onDeviceAdded(const QDBusObjectPath &path);
     void onDeviceRemoved(const QDBusObjectPath &path);
+    void onDeviceAdded(const QString &udi);
+    void onDeviceRemoved(const QString &udi);
 
 private:
+    const QSet<QString> &devices();
+    void fetchTypes(const QStringList &udis);
+
     QSet<Solid::DeviceInterface::Type> m_supportedInterfaces;
     QDBusInterface m_manager;
+    QSet<QString> m_devices;
+    bool m_devicesEnumerated;
+    Solid::Backends::Shared::DeviceCatalog m_catalog;
 };
 
 }
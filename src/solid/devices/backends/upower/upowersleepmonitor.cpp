@@ -0,0 +1,130 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "upowersleepmonitor.h"
+#include "upowerdevice.h"
+#include "upower.h"
+
+#include <QtCore/QPointer>
+#include <QtDBus/QDBusConnection>
+#include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusPendingCallWatcher>
+#include <QtDBus/QDBusPendingReply>
+
+using namespace Solid::Backends::UPower;
+
+Q_GLOBAL_STATIC(UPowerSleepMonitor, globalSleepMonitor)
+
+UPowerSleepMonitor::UPowerSleepMonitor()
+    : m_pendingRefreshes(0)
+    , m_refreshCalls(0)
+    , m_subscribed(false)
+{
+}
+
+UPowerSleepMonitor::~UPowerSleepMonitor()
+{
+}
+
+UPowerSleepMonitor *UPowerSleepMonitor::instance()
+{
+    return globalSleepMonitor;
+}
+
+void UPowerSleepMonitor::registerDevice(UPowerDevice *device)
+{
+    // Subscribed on first use so that processes without any UPower device pay nothing
+    if (!m_subscribed) {
+        // logind tells about the resume, after which UPower has stale values;
+        // older UPower versions refresh by themselves
+        m_subscribed = QDBusConnection::systemBus().connect("org.freedesktop.login1", "/org/freedesktop/login1", "org.freedesktop.login1.Manager", "PrepareForSleep",
+                                                            this, SLOT(login1Resuming(bool)));
+    }
+
+    m_devices[device->udi()].append(device);
+}
+
+void UPowerSleepMonitor::unregisterDevice(UPowerDevice *device)
+{
+    QHash<QString, QList<UPowerDevice *> >::iterator it = m_devices.find(device->udi());
+    if (it == m_devices.end()) {
+        return;
+    }
+
+    it->removeOne(device);
+    if (it->isEmpty()) {
+        m_devices.erase(it);
+    }
+}
+
+qulonglong UPowerSleepMonitor::refreshCalls() const
+{
+    return m_refreshCalls;
+}
+
+void UPowerSleepMonitor::login1Resuming(bool active)
+{
+    if (active) {
+        return;
+    }
+
+    // One Refresh per object however many wrappers it has, all of them in flight together
+    for (QHash<QString, QList<UPowerDevice *> >::const_iterator it = m_devices.constBegin(); it != m_devices.constEnd(); ++it) {
+        QDBusMessage call = QDBusMessage::createMethodCall(UP_DBUS_SERVICE, it.key(), UP_DBUS_INTERFACE_DEVICE, "Refresh");
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(QDBusConnection::systemBus().asyncCall(call), this);
+        watcher->setProperty("udi", it.key());
+        connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher*)), this, SLOT(refreshFinished(QDBusPendingCallWatcher*)));
+
+        ++m_pendingRefreshes;
+        ++m_refreshCalls;
+    }
+}
+
+void UPowerSleepMonitor::refreshFinished(QDBusPendingCallWatcher *watcher)
+{
+    watcher->deleteLater();
+
+    QDBusPendingReply<> reply = *watcher;
+    if (!reply.isError()) {
+        m_refreshed.insert(watcher->property("udi").toString());
+    }
+
+    if (--m_pendingRefreshes > 0) {
+        return;
+    }
+
+    // Wrappers created or destroyed while the calls were out are looked up only now,
+    // guarded since a receiver of changed() may delete any of them
+    QList<QPointer<UPowerDevice> > devices;
+    Q_FOREACH (const QString &udi, m_refreshed) {
+        Q_FOREACH (UPowerDevice *device, m_devices.value(udi)) {
+            devices << device;
+        }
+    }
+    m_refreshed.clear();
+
+    Q_FOREACH (const QPointer<UPowerDevice> &device, devices) {
+        if (device) {
+            device->slotChanged();
+        }
+    }
+
+    emit refreshed();
+}
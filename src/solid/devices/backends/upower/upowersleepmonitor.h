@@ -0,0 +1,87 @@
+/*
+    Copyright 2026 Solid developers
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UPOWERSLEEPMONITOR_H
+#define UPOWERSLEEPMONITOR_H
+
+#include <QtCore/QObject>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+class QDBusPendingCallWatcher;
+
+namespace Solid
+{
+namespace Backends
+{
+namespace UPower
+{
+
+class UPowerDevice;
+
+/**
+ * Process-wide listener for logind's PrepareForSleep signal.
+ *
+ * On resume every UPower object that has a live UPowerDevice wrapper is
+ * asked to Refresh once, all the calls in flight at the same time. When
+ * the last reply arrives the caches of all those wrappers are dropped
+ * together.
+ */
+class UPowerSleepMonitor : public QObject
+{
+    Q_OBJECT
+    /* Refresh calls sent since the process started */
+    Q_PROPERTY(qulonglong refreshCalls READ refreshCalls)
+public:
+    UPowerSleepMonitor();
+    virtual ~UPowerSleepMonitor();
+
+    static UPowerSleepMonitor *instance();
+
+    void registerDevice(UPowerDevice *device);
+    void unregisterDevice(UPowerDevice *device);
+
+    qulonglong refreshCalls() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted once the caches were invalidated after a resume.
+     */
+    void refreshed();
+
+private Q_SLOTS:
+    void login1Resuming(bool active);
+    void refreshFinished(QDBusPendingCallWatcher *watcher);
+
+private:
+    QHash<QString, QList<UPowerDevice *> > m_devices;
+    QSet<QString> m_refreshed;
+    int m_pendingRefreshes;
+    qulonglong m_refreshCalls;
+    bool m_subscribed;
+};
+
+}
+}
+}
+
+#endif // UPOWERSLEEPMONITOR_H
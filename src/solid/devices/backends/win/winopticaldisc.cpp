@@ -98,3 +98,8 @@ qulonglong WinOpticalDisc::capacity() const
 {
     return size();
 }
+
+bool WinOpticalDisc::isContentProbePending() const
+{
+    return false;
+}
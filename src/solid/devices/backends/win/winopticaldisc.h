@@ -51,6 +51,11 @@ public:
 
     virtual qulonglong capacity() const;
 
+    virtual bool isContentProbePending() const;
+
+Q_SIGNALS:
+    void availableContentChanged(Solid::OpticalDisc::ContentTypes content, const QString &udi);
+
 private:
     Solid::OpticalDisc::DiscType m_discType;
     bool m_isRewritable;
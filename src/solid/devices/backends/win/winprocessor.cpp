@@ -61,6 +61,77 @@ Solid::Processor::InstructionSets WinProcessor::instructionSets() const
     return set;
 }
 
+int WinProcessor::packageId() const
+{
+    return updateCache()[m_number].package;
+}
+
+int WinProcessor::dieId() const
+{
+    // Not reported by this platform
+    return -1;
+}
+
+int WinProcessor::coreId() const
+{
+    return updateCache()[m_number].id;
+}
+
+int WinProcessor::numaNode() const
+{
+    return updateCache()[m_number].numaNode;
+}
+
+QList<int> WinProcessor::siblings() const
+{
+    const QMap<int, ProcessorInfo> &cache = updateCache();
+    const int core = cache[m_number].id;
+
+    QList<int> out;
+    foreach (const ProcessorInfo &info, cache) {
+        if (info.id == core) {
+            out << info.lgicalId;
+        }
+    }
+    return out;
+}
+
+QList<Solid::Processor::Cache> WinProcessor::caches() const
+{
+    // Not reported by this platform
+    return QList<Solid::Processor::Cache>();
+}
+
+Solid::Processor::CoreClass WinProcessor::coreClass() const
+{
+    // Not reported by this platform
+    return Solid::Processor::UnknownCore;
+}
+
+int WinProcessor::capacity() const
+{
+    // Not reported by this platform
+    return -1;
+}
+
+bool WinProcessor::isUsable() const
+{
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    // The masks cover the processor group of the process only
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)
+            || m_number < 0 || m_number >= int(sizeof(DWORD_PTR) * 8)) {
+        return true;
+    }
+    return processMask & (DWORD_PTR(1) << m_number);
+}
+
+qreal WinProcessor::cpuQuota() const
+{
+    // Not reported by this platform
+    return -1;
+}
+
 QSet<QString> WinProcessor::getUdis()
 {
     static QSet<QString> out;
@@ -112,6 +183,8 @@ const QMap<int, WinProcessor::ProcessorInfo> &WinProcessor::updateCache()
                     ProcessorInfo proc;
                     proc.id = processorCoreCount;
                     proc.lgicalId = old;
+                    proc.package = -1;
+                    proc.numaNode = -1;
                     proc.speed = settings.value("~MHz").toInt();
                     proc.vendor = settings.value("VendorIdentifier").toString().trimmed();
                     proc.name = settings.value("ProcessorNameString").toString().trimmed();
@@ -123,6 +196,32 @@ const QMap<int, WinProcessor::ProcessorInfo> &WinProcessor::updateCache()
             }
 
         }
+
+        // Packages and nodes come as separate records, listing the
+        // logical processors they hold
+        int packageCount = 0;
+        for (uint i = 0; i < size; ++i) {
+            int package = -1;
+            int node = -1;
+            if (info[i].Relationship == RelationProcessorPackage) {
+                package = packageCount++;
+            } else if (info[i].Relationship == RelationNumaNode) {
+                node = info[i].NumaNode.NodeNumber;
+            } else {
+                continue;
+            }
+
+            for (int bit = 0; bit < int(sizeof(ULONG_PTR) * 8); ++bit) {
+                if (!(info[i].ProcessorMask & ((ULONG_PTR)1 << bit)) || !p.contains(bit)) {
+                    continue;
+                }
+                if (package != -1) {
+                    p[bit].package = package;
+                } else {
+                    p[bit].numaNode = node;
+                }
+            }
+        }
         delete [] buff;
     }
     return p;
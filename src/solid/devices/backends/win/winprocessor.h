@@ -47,6 +47,17 @@ public:
 
     virtual Solid::Processor::InstructionSets instructionSets() const;
 
+    virtual int packageId() const;
+    virtual int dieId() const;
+    virtual int coreId() const;
+    virtual int numaNode() const;
+    virtual QList<int> siblings() const;
+    virtual QList<Solid::Processor::Cache> caches() const;
+    virtual Solid::Processor::CoreClass coreClass() const;
+    virtual int capacity() const;
+    virtual bool isUsable() const;
+    virtual qreal cpuQuota() const;
+
     static QSet<QString> getUdis();
 
 private:
@@ -57,6 +68,8 @@ private:
     public:
         int lgicalId;
         int id;
+        int package;
+        int numaNode;
         int speed;
         QString vendor;
         QString name;
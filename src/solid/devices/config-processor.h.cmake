@@ -1,14 +0,0 @@
-/********** processor stuff *************/
-
-/* Defined to 1 if the assembler supports MMX instructions. */
-#cmakedefine HAVE_X86_MMX
-
-/* Defined to 1 if the assembler supports SSE instructions. */
-#cmakedefine HAVE_X86_SSE
-
-/* Defined to 1 if the assembler supports SSE2 instructions. */
-#cmakedefine HAVE_X86_SSE2
-
-/* Defined to 1 if the assembler supports AltiVec instructions. */
-#cmakedefine HAVE_PPC_ALTIVEC  
-
@@ -77,7 +77,9 @@ Solid::Device &Solid::Device::operator=(const Solid::Device &device)
 
 bool Solid::Device::isValid() const
 {
-    return d->backendObject() != nullptr;
+    return callWithBackendsLocked([this]() {
+        return d->backendObject() != nullptr;
+    });
 }
 
 QString Solid::Device::udi() const
@@ -142,9 +144,22 @@ Solid::DeviceInterface *Solid::Device::asDeviceInterface(const DeviceInterface::
 
 const Solid::DeviceInterface *Solid::Device::asDeviceInterface(const DeviceInterface::Type &type) const
 {
-    Ifaces::Device *device = qobject_cast<Ifaces::Device *>(d->backendObject());
+    DeviceInterface *cached = callWithBackendsLocked([this, &type]() -> DeviceInterface * {
+        return d->backendObject() != nullptr ? d->interface(type) : nullptr;
+    });
+    if (cached != nullptr) {
+        return cached;
+    }
+
+    // Interfaces are created and cached from the backend thread so that
+    // they keep receiving the backend signals
+    return callInBackendThread([this, &type]() -> DeviceInterface * {
+        Ifaces::Device *device = qobject_cast<Ifaces::Device *>(d->backendObject());
+
+        if (device == nullptr) {
+            return nullptr;
+        }
 
-    if (device != nullptr) {
         DeviceInterface *iface = d->interface(type);
 
         if (iface != nullptr) {
@@ -204,24 +219,30 @@ const Solid::DeviceInterface *Solid::Device::asDeviceInterface(const DeviceInter
         }
 
         return iface;
-    } else {
-        return nullptr;
-    }
+    });
 }
 
 //////////////////////////////////////////////////////////////////////
 
 Solid::DevicePrivate::DevicePrivate(const QString &udi)
-    : QObject(), QSharedData(), m_udi(udi)
+    : QObject(), QSharedData(), m_udi(udi), m_registry(nullptr)
 {
 }
 
 Solid::DevicePrivate::~DevicePrivate()
 {
-    Q_FOREACH (DeviceInterface *iface, m_ifaces) {
-        delete iface->d_ptr->backendObject();
-    }
-    setBackendObject(nullptr);
+    // The last reference can go away in any thread, but the backend
+    // objects and the registry entry belong to the backend thread
+    runInBackendThread([this]() {
+        if (m_registry) {
+            m_registry->unregisterDevice(this);
+        }
+
+        Q_FOREACH (DeviceInterface *iface, m_ifaces) {
+            delete iface->d_ptr->backendObject();
+        }
+        setBackendObject(nullptr);
+    });
 }
 
 void Solid::DevicePrivate::_k_destroyed(QObject *object)
@@ -262,6 +283,11 @@ Solid::DeviceInterface *Solid::DevicePrivate::interface(const DeviceInterface::T
     return m_ifaces[type];
 }
 
+void Solid::DevicePrivate::setRegistry(DeviceManagerPrivate *registry)
+{
+    m_registry = registry;
+}
+
 void Solid::DevicePrivate::setInterface(const DeviceInterface::Type &type, DeviceInterface *interface)
 {
     if (m_ifaces.isEmpty()) {
@@ -208,6 +208,9 @@ public:
      * Retrieves a specialized interface to interact with the device corresponding to
      * a particular device interface.
      *
+     * The interface belongs to Solid's event thread, see DeviceNotifier for
+     * what it means for its signals.
+     *
      * @param type the device interface type
      * @returns a pointer to the device interface interface if it exists, 0 otherwise
      */
@@ -217,6 +220,9 @@ public:
      * Retrieves a specialized interface to interact with the device corresponding to
      * a particular device interface.
      *
+     * The interface belongs to Solid's event thread, see DeviceNotifier for
+     * what it means for its signals.
+     *
      * @param type the device interface type
      * @returns a pointer to the device interface interface if it exists, 0 otherwise
      */
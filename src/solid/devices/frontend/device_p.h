@@ -33,6 +33,8 @@
 
 namespace Solid
 {
+class DeviceManagerPrivate;
+
 class DevicePrivate : public QObject, public QSharedData
 {
     Q_OBJECT
@@ -54,6 +56,8 @@ public:
     DeviceInterface *interface(const DeviceInterface::Type &type) const;
     void setInterface(const DeviceInterface::Type &type, DeviceInterface *interface);
 
+    void setRegistry(DeviceManagerPrivate *registry);
+
 public Q_SLOTS:
     void _k_destroyed(QObject *object);
 
@@ -61,6 +65,7 @@ private:
     QString m_udi;
     QPointer<Ifaces::Device> m_backendObject;
     QMap<DeviceInterface::Type, DeviceInterface *> m_ifaces;
+    DeviceManagerPrivate *m_registry;
 };
 }
 
@@ -20,6 +20,7 @@
 
 #include "deviceinterface.h"
 #include "deviceinterface_p.h"
+#include "soliddefs_p.h"
 
 #include <solid/devices/ifaces/deviceinterface.h>
 
@@ -42,7 +43,9 @@ Solid::DeviceInterface::~DeviceInterface()
 bool Solid::DeviceInterface::isValid() const
 {
     Q_D(const DeviceInterface);
-    return d->backendObject() != nullptr;
+    return callWithBackendsLocked([d]() {
+        return d->backendObject() != nullptr;
+    });
 }
 
 QString Solid::DeviceInterface::typeToString(Type type)
@@ -30,8 +30,61 @@
 
 #include "soliddefs_p.h"
 
+#include <QtCore/QAbstractEventDispatcher>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+
 Q_GLOBAL_STATIC(Solid::DeviceManagerStorage, globalDeviceStorage)
 
+namespace
+{
+class BackendCallEvent : public QEvent
+{
+public:
+    BackendCallEvent(const std::function<void()> &job, QSemaphore *done)
+        : QEvent(QEvent::User), m_job(job), m_done(done)
+    {
+    }
+
+    ~BackendCallEvent()
+    {
+        // Also wakes the caller up if the event thread is shutting down
+        // and drops the event without delivering it
+        m_done->release();
+    }
+
+    void run() const
+    {
+        m_job();
+    }
+
+private:
+    const std::function<void()> &m_job;
+    QSemaphore *m_done;
+};
+}
+
+void Solid::runInBackendThread(const std::function<void()> &job)
+{
+    // Devices outliving the registry tear down where they are
+    if (globalDeviceStorage.isDestroyed()) {
+        job();
+        return;
+    }
+
+    globalDeviceStorage->runInBackendThread(job);
+}
+
+void Solid::runWithBackendsLocked(const std::function<void()> &job)
+{
+    if (globalDeviceStorage.isDestroyed()) {
+        job();
+        return;
+    }
+
+    globalDeviceStorage->runWithBackendsLocked(job);
+}
+
 Solid::DeviceManagerPrivate::DeviceManagerPrivate()
     : m_nullDevice(new DevicePrivate(QString()))
 {
@@ -53,12 +106,10 @@ Solid::DeviceManagerPrivate::~DeviceManagerPrivate()
         disconnect(backend, nullptr, this, nullptr);
     }
 
-    Q_FOREACH (QPointer<DevicePrivate> dev, m_devicesMap) {
-        if (!dev.data()->ref.deref()) {
-            delete dev.data();
-        }
+    QWriteLocker locker(&m_devicesLock);
+    Q_FOREACH (DevicePrivate *device, m_devicesMap) {
+        device->setRegistry(nullptr);
     }
-
     m_devicesMap.clear();
 }
 
@@ -74,7 +125,9 @@ QList<Solid::Device> Solid::Device::allDevices()
             continue;
         }
 
-        QStringList udis = backend->allDevices();
+        const QStringList udis = callInBackendThread([backend]() {
+            return backend->allDevices();
+        });
 
         Q_FOREACH (const QString &udi, udis) {
             list.append(Device(udi));
@@ -112,7 +165,9 @@ QList<Solid::Device> Solid::Device::listFromType(const DeviceInterface::Type &ty
             continue;
         }
 
-        QStringList udis = backend->devicesFromQuery(parentUdi, type);
+        const QStringList udis = callInBackendThread([backend, &parentUdi, &type]() {
+            return backend->devicesFromQuery(parentUdi, type);
+        });
 
         Q_FOREACH (const QString &udi, udis) {
             list.append(Device(udi));
@@ -145,11 +200,15 @@ QList<Solid::Device> Solid::Device::listFromQuery(const Predicate &predicate,
 
             QList<DeviceInterface::Type> sortedTypes = supportedTypes.toList();
             std::sort(sortedTypes.begin(), sortedTypes.end());
-            Q_FOREACH (DeviceInterface::Type type, sortedTypes) {
-                udis += backend->devicesFromQuery(parentUdi, type);
-            }
+            runInBackendThread([backend, &parentUdi, &sortedTypes, &udis]() {
+                Q_FOREACH (DeviceInterface::Type type, sortedTypes) {
+                    udis += backend->devicesFromQuery(parentUdi, type);
+                }
+            });
         } else {
-            udis += backend->allDevices();
+            runInBackendThread([backend, &udis]() {
+                udis += backend->allDevices();
+            });
         }
 
         QSet<QString> seen;
@@ -184,16 +243,14 @@ Solid::DeviceNotifier *Solid::DeviceNotifier::instance()
 
 void Solid::DeviceManagerPrivate::_k_deviceAdded(const QString &udi)
 {
-    if (m_devicesMap.contains(udi)) {
-        DevicePrivate *dev = m_devicesMap[udi].data();
+    QExplicitlySharedDataPointer<DevicePrivate> dev = registeredDevice(udi);
 
-        // Ok, this one was requested somewhere was invalid
-        // and now becomes magically valid!
+    // Ok, this one was requested somewhere was invalid
+    // and now becomes magically valid!
 
-        if (dev && dev->backendObject() == nullptr) {
-            dev->setBackendObject(createBackendObject(udi));
-            Q_ASSERT(dev->backendObject() != nullptr);
-        }
+    if (dev && dev->backendObject() == nullptr) {
+        dev->setBackendObject(createBackendObject(udi));
+        Q_ASSERT(dev->backendObject() != nullptr);
     }
 
     emit deviceAdded(udi);
@@ -201,52 +258,99 @@ void Solid::DeviceManagerPrivate::_k_deviceAdded(const QString &udi)
 
 void Solid::DeviceManagerPrivate::_k_deviceRemoved(const QString &udi)
 {
-    if (m_devicesMap.contains(udi)) {
-        DevicePrivate *dev = m_devicesMap[udi].data();
+    QExplicitlySharedDataPointer<DevicePrivate> dev = registeredDevice(udi);
 
-        // Ok, this one was requested somewhere was valid
-        // and now becomes magically invalid!
+    // Ok, this one was requested somewhere was valid
+    // and now becomes magically invalid!
 
-        if (dev) {
-            Q_ASSERT(dev->backendObject() != nullptr);
-            dev->setBackendObject(nullptr);
-            Q_ASSERT(dev->backendObject() == nullptr);
-        }
+    if (dev) {
+        Q_ASSERT(dev->backendObject() != nullptr);
+        dev->setBackendObject(nullptr);
+        Q_ASSERT(dev->backendObject() == nullptr);
     }
 
     emit deviceRemoved(udi);
 }
 
-void Solid::DeviceManagerPrivate::_k_destroyed(QObject *object)
+void Solid::DeviceManagerPrivate::customEvent(QEvent *event)
 {
-    QString udi = m_reverseMap.take(object);
-
-    if (!udi.isEmpty()) {
-        m_devicesMap.remove(udi);
+    if (event->type() == QEvent::User) {
+        static_cast<BackendCallEvent *>(event)->run();
     }
 }
 
-Solid::DevicePrivate *Solid::DeviceManagerPrivate::findRegisteredDevice(const QString &udi)
+QExplicitlySharedDataPointer<Solid::DevicePrivate> Solid::DeviceManagerPrivate::findRegisteredDevice(const QString &udi)
 {
     if (udi.isEmpty()) {
-        return m_nullDevice.data();
-    } else if (m_devicesMap.contains(udi)) {
-        return m_devicesMap[udi].data();
-    } else {
-        Ifaces::Device *iface = createBackendObject(udi);
+        return m_nullDevice;
+    }
+
+    QExplicitlySharedDataPointer<DevicePrivate> dev = registeredDevice(udi);
+    if (dev) {
+        return dev;
+    }
 
-        DevicePrivate *devData = new DevicePrivate(udi);
-        devData->setBackendObject(iface);
+    return callInBackendThread([this, &udi]() {
+        return registerDevice(udi);
+    });
+}
+
+QExplicitlySharedDataPointer<Solid::DevicePrivate> Solid::DeviceManagerPrivate::registerDevice(const QString &udi)
+{
+    // Backends are serialized at this point, so nobody else can register
+    // the same udi between the lookup and the insertion
+    QExplicitlySharedDataPointer<DevicePrivate> devData = registeredDevice(udi);
+    if (devData) {
+        return devData;
+    }
 
-        QPointer<DevicePrivate> ptr(devData);
-        m_devicesMap[udi] = ptr;
-        m_reverseMap[devData] = udi;
+    Ifaces::Device *iface = createBackendObject(udi);
 
-        connect(devData, SIGNAL(destroyed(QObject*)),
-                this, SLOT(_k_destroyed(QObject*)));
+    devData = new DevicePrivate(udi);
+    devData->setBackendObject(iface);
 
+    // Don't let lookups of bogus udis fill the registry
+    if (iface == nullptr) {
         return devData;
     }
+
+    devData->setRegistry(this);
+
+    QWriteLocker locker(&m_devicesLock);
+    m_devicesMap.insert(udi, devData.data());
+
+    return devData;
+}
+
+QExplicitlySharedDataPointer<Solid::DevicePrivate> Solid::DeviceManagerPrivate::registeredDevice(const QString &udi) const
+{
+    QReadLocker locker(&m_devicesLock);
+    DevicePrivate *device = m_devicesMap.value(udi);
+
+    // The entry can be on its way out, its destructor waits for the lock
+    // to unregister it. Only take a reference while some are still held.
+    int count = device ? device->ref.load() : 0;
+    while (count > 0) {
+        if (device->ref.testAndSetOrdered(count, count + 1)) {
+            QExplicitlySharedDataPointer<DevicePrivate> result(device);
+            device->ref.deref();
+            return result;
+        }
+        count = device->ref.load();
+    }
+
+    return QExplicitlySharedDataPointer<DevicePrivate>();
+}
+
+void Solid::DeviceManagerPrivate::unregisterDevice(DevicePrivate *device)
+{
+    QWriteLocker locker(&m_devicesLock);
+    QHash<QString, DevicePrivate *>::iterator it = m_devicesMap.find(device->udi());
+
+    // A new entry may have replaced it already
+    if (it != m_devicesMap.end() && it.value() == device) {
+        m_devicesMap.erase(it);
+    }
 }
 
 Solid::Ifaces::Device *Solid::DeviceManagerPrivate::createBackendObject(const QString &udi)
@@ -278,28 +382,159 @@ Solid::Ifaces::Device *Solid::DeviceManagerPrivate::createBackendObject(const QS
     return nullptr;
 }
 
+Solid::DeviceManagerThread::DeviceManagerThread(QMutex *backendLock)
+    : m_backendLock(backendLock),
+      m_backendsLocked(false),
+      m_manager(nullptr)
+{
+    setObjectName(QStringLiteral("SolidDeviceManager"));
+}
+
+Solid::DeviceManagerPrivate *Solid::DeviceManagerThread::startManager()
+{
+    start();
+    m_started.acquire();
+    return m_manager;
+}
+
+bool Solid::DeviceManagerThread::postToManager(QEvent *event)
+{
+    // Held while the manager gets taken away, so it can't be posted to
+    // once run() is about to delete it
+    QMutexLocker locker(&m_managerLock);
+    if (m_manager == nullptr) {
+        return false;
+    }
+
+    QCoreApplication::postEvent(m_manager, event);
+    return true;
+}
+
+void Solid::DeviceManagerThread::run()
+{
+    lockBackends();
+    m_manager = new DeviceManagerPrivate();
+    m_started.release();
+
+    // Other threads read the backends in place, so events are handled with
+    // the backends locked, and the lock is free while this thread waits
+    QAbstractEventDispatcher *dispatcher = eventDispatcher();
+    connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock,
+            dispatcher, [this]() { unlockBackends(); }, Qt::DirectConnection);
+    connect(dispatcher, &QAbstractEventDispatcher::awake,
+            dispatcher, [this]() { lockBackends(); }, Qt::DirectConnection);
+
+    exec();
+
+    disconnect(dispatcher, nullptr, dispatcher, nullptr);
+    lockBackends();
+
+    DeviceManagerPrivate *manager = nullptr;
+    {
+        QMutexLocker locker(&m_managerLock);
+        manager = m_manager;
+        m_manager = nullptr;
+    }
+    delete manager;
+
+    unlockBackends();
+}
+
+void Solid::DeviceManagerThread::lockBackends()
+{
+    // awake() doesn't always come paired with aboutToBlock()
+    if (!m_backendsLocked) {
+        m_backendLock->lock();
+        m_backendsLocked = true;
+    }
+}
+
+void Solid::DeviceManagerThread::unlockBackends()
+{
+    if (m_backendsLocked) {
+        m_backendsLocked = false;
+        m_backendLock->unlock();
+    }
+}
+
 Solid::DeviceManagerStorage::DeviceManagerStorage()
+    : m_manager(nullptr),
+      m_thread(nullptr),
+      m_backendLock(QMutex::Recursive)
 {
 
 }
 
+Solid::DeviceManagerStorage::~DeviceManagerStorage()
+{
+    if (m_thread) {
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+    } else {
+        delete m_manager.load();
+    }
+}
+
 QList<QObject *> Solid::DeviceManagerStorage::managerBackends()
 {
-    ensureManagerCreated();
-    return m_storage.localData()->managerBackends();
+    return ensureManagerCreated()->managerBackends();
 }
 
 Solid::DeviceNotifier *Solid::DeviceManagerStorage::notifier()
+{
+    return ensureManagerCreated();
+}
+
+void Solid::DeviceManagerStorage::runInBackendThread(const std::function<void()> &job)
+{
+    ensureManagerCreated();
+
+    if (m_thread && QThread::currentThread() != m_thread) {
+        QSemaphore done;
+        BackendCallEvent *event = new BackendCallEvent(job, &done);
+        if (m_thread->postToManager(event)) {
+            done.acquire();
+            return;
+        }
+        // The thread is shutting down, the backends are left to the caller
+        delete event;
+    }
+
+    QMutexLocker locker(&m_backendLock);
+    job();
+}
+
+void Solid::DeviceManagerStorage::runWithBackendsLocked(const std::function<void()> &job)
 {
     ensureManagerCreated();
-    return m_storage.localData();
+
+    QMutexLocker locker(&m_backendLock);
+    job();
 }
 
-void Solid::DeviceManagerStorage::ensureManagerCreated()
+Solid::DeviceManagerPrivate *Solid::DeviceManagerStorage::ensureManagerCreated()
 {
-    if (!m_storage.hasLocalData()) {
-        m_storage.setLocalData(new DeviceManagerPrivate());
+    DeviceManagerPrivate *manager = m_manager.loadAcquire();
+    if (manager) {
+        return manager;
     }
+
+    QMutexLocker locker(&m_creationLock);
+    manager = m_manager.loadAcquire();
+    if (manager) {
+        return manager;
+    }
+
+    if (!qgetenv("SOLID_FAKEHW").isEmpty()) {
+        manager = new DeviceManagerPrivate();
+    } else {
+        m_thread = new DeviceManagerThread(&m_backendLock);
+        manager = m_thread->startManager();
+    }
+
+    m_manager.storeRelease(manager);
+    return manager;
 }
 
 #include "moc_devicemanager_p.cpp"
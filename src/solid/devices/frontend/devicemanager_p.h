@@ -25,10 +25,15 @@
 
 #include "devicenotifier.h"
 
-#include <QtCore/QMap>
-#include <QtCore/QPointer>
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSemaphore>
 #include <QtCore/QSharedData>
-#include <QtCore/QThreadStorage>
+#include <QtCore/QThread>
+
+#include <functional>
 
 namespace Solid
 {
@@ -45,33 +50,96 @@ public:
     DeviceManagerPrivate();
     ~DeviceManagerPrivate();
 
-    DevicePrivate *findRegisteredDevice(const QString &udi);
+    QExplicitlySharedDataPointer<DevicePrivate> findRegisteredDevice(const QString &udi);
+    void unregisterDevice(DevicePrivate *device);
+
+protected:
+    void customEvent(QEvent *event) Q_DECL_OVERRIDE;
 
 private Q_SLOTS:
     void _k_deviceAdded(const QString &udi);
     void _k_deviceRemoved(const QString &udi);
-    void _k_destroyed(QObject *object);
 
 private:
+    QExplicitlySharedDataPointer<DevicePrivate> registerDevice(const QString &udi);
+    QExplicitlySharedDataPointer<DevicePrivate> registeredDevice(const QString &udi) const;
     Ifaces::Device *createBackendObject(const QString &udi);
 
     QExplicitlySharedDataPointer<DevicePrivate> m_nullDevice;
-    QMap<QString, QPointer<DevicePrivate> > m_devicesMap;
-    QMap<QObject *, QString> m_reverseMap;
+
+    // Readers from any thread take m_devicesLock for reading, insertions and
+    // removals only ever happen with the backends serialized (see
+    // DeviceManagerStorage::runInBackendThread()). The entries don't hold
+    // a reference, devices unregister themselves when their last one dies.
+    mutable QReadWriteLock m_devicesLock;
+    QHash<QString, DevicePrivate *> m_devicesMap;
+};
+
+/**
+ * Event thread owning the process-wide DeviceManagerPrivate
+ *
+ * The manager and all its backends are created and destroyed from within
+ * this thread so that their sockets, D-Bus connections and timers keep
+ * working whichever thread is querying devices. It holds the backend lock
+ * whenever it is handling events, so that other threads can read the
+ * backends in between.
+ */
+class DeviceManagerThread : public QThread
+{
+public:
+    explicit DeviceManagerThread(QMutex *backendLock);
+
+    DeviceManagerPrivate *startManager();
+    /**
+     * Posts event to the manager, or returns false if it is gone already.
+     */
+    bool postToManager(QEvent *event);
+
+protected:
+    void run() Q_DECL_OVERRIDE;
+
+private:
+    void lockBackends();
+    void unlockBackends();
+
+    QMutex *m_backendLock;
+    bool m_backendsLocked;
+    QMutex m_managerLock;
+    DeviceManagerPrivate *m_manager;
+    QSemaphore m_started;
 };
 
+/**
+ * Process-wide device registry shared by all threads
+ *
+ * There is a single DeviceManagerPrivate per process. It lives in its own
+ * DeviceManagerThread, except for the fake backend which stays in the
+ * thread that first queried it so that tests driving it get synchronous
+ * notifications.
+ *
+ * Getters run in the calling thread, serialized with m_backendLock;
+ * only the calls creating objects or starting asynchronous work in the
+ * backends make the trip to the backend thread.
+ */
 class DeviceManagerStorage
 {
 public:
     DeviceManagerStorage();
+    ~DeviceManagerStorage();
 
     QList<QObject *> managerBackends();
     DeviceNotifier *notifier();
 
+    void runInBackendThread(const std::function<void()> &job);
+    void runWithBackendsLocked(const std::function<void()> &job);
+
 private:
-    void ensureManagerCreated();
+    DeviceManagerPrivate *ensureManagerCreated();
 
-    QThreadStorage<DeviceManagerPrivate *> m_storage;
+    QMutex m_creationLock;
+    QAtomicPointer<DeviceManagerPrivate> m_manager;
+    DeviceManagerThread *m_thread;
+    QMutex m_backendLock;
 };
 }
 
@@ -37,6 +37,12 @@ namespace Solid
  *
  * Note that it's implemented as a singleton and encapsulates the backend logic.
  *
+ * The notifier, like the device interfaces returned by Device::as(), lives
+ * in Solid's own event thread, which emits all their signals. Connected
+ * with the default connection type, slots still run in the thread of their
+ * receiver, after the queued signal reaches its event loop; use
+ * Qt::DirectConnection only with slots safe to run in Solid's thread.
+ *
  * @author Kevin Ottens <ervin@kde.org>
  */
 class SOLID_EXPORT DeviceNotifier : public QObject //krazy:exclude=dpointer (interface class)
@@ -27,6 +27,8 @@
 Solid::OpticalDisc::OpticalDisc(QObject *backendObject)
     : StorageVolume(*new OpticalDiscPrivate(), backendObject)
 {
+    connect(backendObject, SIGNAL(availableContentChanged(Solid::OpticalDisc::ContentTypes,QString)),
+            this, SIGNAL(availableContentChanged(Solid::OpticalDisc::ContentTypes,QString)));
 }
 
 Solid::OpticalDisc::~OpticalDisc()
@@ -70,3 +72,9 @@ qulonglong Solid::OpticalDisc::capacity() const
     return_SOLID_CALL(Ifaces::OpticalDisc *, d->backendObject(), 0, capacity());
 }
 
+bool Solid::OpticalDisc::isContentProbePending() const
+{
+    Q_D(const OpticalDisc);
+    return_SOLID_CALL(Ifaces::OpticalDisc *, d->backendObject(), false, isContentProbePending());
+}
+
@@ -44,6 +44,7 @@ class SOLID_EXPORT OpticalDisc : public StorageVolume
     Q_PROPERTY(bool blank READ isBlank)
     Q_PROPERTY(bool rewritable READ isRewritable)
     Q_PROPERTY(qulonglong capacity READ capacity)
+    Q_PROPERTY(bool contentProbePending READ isContentProbePending)
     Q_DECLARE_PRIVATE(OpticalDisc)
     friend class Device;
 
@@ -180,6 +181,27 @@ public:
      * @return the capacity of the disc in bytes
      */
     qulonglong capacity() const;
+
+    /**
+     * Indicates if the disc is still being read to find out its content
+     * types. Meanwhile availableContent() only reports the Data and Audio
+     * ones, availableContentChanged() is emitted once the others are known.
+     *
+     * @return true if the content types are being probed, false otherwise
+     * @since 5.32
+     */
+    bool isContentProbePending() const;
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted when the content types of the disc changed,
+     * such as when a content probe completes.
+     *
+     * @param content the new content types
+     * @param udi the UDI of the disc
+     * @since 5.32
+     */
+    void availableContentChanged(Solid::OpticalDisc::ContentTypes content, const QString &udi);
 };
 }
 
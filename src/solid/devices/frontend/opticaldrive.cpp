@@ -67,6 +67,10 @@ QList<int> Solid::OpticalDrive::writeSpeeds() const
 bool Solid::OpticalDrive::eject()
 {
     Q_D(OpticalDrive);
-    return_SOLID_CALL(Ifaces::OpticalDrive *, d->backendObject(), false, eject());
+    // It starts calls replying to the backend thread, like StorageAccess::setup()
+    return callInBackendThread([d]() {
+        Ifaces::OpticalDrive *t = qobject_cast<Ifaces::OpticalDrive *>(d->backendObject());
+        return t != nullptr ? t->eject() : false;
+    });
 }
 
@@ -19,35 +19,242 @@
 */
 
 #include "predicate.h"
+#include "predicate_p.h"
 
 #include <solid/device.h>
 #include <solid/deviceinterface.h>
+#include <solid/genericinterface.h>
+#include <solid/processor.h>
+#include <solid/block.h>
+#include <solid/storageaccess.h>
+#include <solid/storagedrive.h>
+#include <solid/opticaldrive.h>
+#include <solid/storagevolume.h>
+#include <solid/opticaldisc.h>
+#include <solid/camera.h>
+#include <solid/portablemediaplayer.h>
+#include <solid/networkshare.h>
+#include <solid/battery.h>
 #include <QtCore/QStringList>
 #include <QtCore/QMetaEnum>
+#include <QtCore/QVector>
 
 namespace Solid
 {
-class Predicate::Private
+namespace
 {
-public:
+/*
+ * One node of a compiled predicate. The tree is flattened in pre-order,
+ * so the first operand of a Conjunction/Disjunction immediately follows
+ * it and the second one starts 'size' instructions later.
+ *
+ * Property lookups and enum keys are resolved once against the
+ * metaObject of the frontend interface class, so matching a device no
+ * longer goes through indexOfProperty() or QMetaEnum::keysToValue().
+ */
+struct Instruction
+{
+    enum Op { Fail, IsInterface, CompareEquals, CompareMask, And, Or };
+
+    Op op = Fail;
+    int size = 1;
+    DeviceInterface::Type ifaceType = DeviceInterface::Unknown;
+    QByteArray property;
+    const QMetaObject *metaObject = nullptr;
+    int propertyIndex = -1;
+    QVariant expected;
+    int expectedMask = 0;
+    bool expectedMaskValid = false;
+};
+
+const QMetaObject *interfaceMetaObject(DeviceInterface::Type type)
+{
+    switch (type) {
+    case DeviceInterface::GenericInterface:
+        return &GenericInterface::staticMetaObject;
+    case DeviceInterface::Processor:
+        return &Processor::staticMetaObject;
+    case DeviceInterface::Block:
+        return &Block::staticMetaObject;
+    case DeviceInterface::StorageAccess:
+        return &StorageAccess::staticMetaObject;
+    case DeviceInterface::StorageDrive:
+        return &StorageDrive::staticMetaObject;
+    case DeviceInterface::OpticalDrive:
+        return &OpticalDrive::staticMetaObject;
+    case DeviceInterface::StorageVolume:
+        return &StorageVolume::staticMetaObject;
+    case DeviceInterface::OpticalDisc:
+        return &OpticalDisc::staticMetaObject;
+    case DeviceInterface::Camera:
+        return &Camera::staticMetaObject;
+    case DeviceInterface::PortableMediaPlayer:
+        return &PortableMediaPlayer::staticMetaObject;
+    case DeviceInterface::Battery:
+        return &Battery::staticMetaObject;
+    case DeviceInterface::NetworkShare:
+        return &NetworkShare::staticMetaObject;
+    case DeviceInterface::Unknown:
+    case DeviceInterface::Last:
+        break;
+    }
 
-    Private() : isValid(false), type(PropertyCheck),
-        compOperator(Predicate::Equals),
-        operand1(nullptr), operand2(nullptr) {}
+    return nullptr;
+}
+
+// Resolves the property and the expected value of a PropertyCheck against
+// a given metaObject, with the same semantics matches() always had
+void resolveProperty(Instruction &ins, const QMetaObject *metaObject, const QVariant &value)
+{
+    ins.metaObject = metaObject;
+    ins.propertyIndex = metaObject ? metaObject->indexOfProperty(ins.property.constData()) : -1;
+    ins.expected = value;
+
+    if (metaObject && ins.propertyIndex >= 0) {
+        const QMetaProperty metaProp = metaObject->property(ins.propertyIndex);
+        if (metaProp.isEnumType() && value.type() == QVariant::String) {
+            const QMetaEnum metaEnum = metaProp.enumerator();
+            const int enumValue = metaEnum.keysToValue(value.toString().toLatin1().constData());
+            if (enumValue >= 0) {
+                ins.expected = enumValue;
+            } else { // No value found for these keys, resetting expected to invalid
+                ins.expected = QVariant();
+            }
+        }
+    }
 
-    bool isValid;
-    Type type;
+    ins.expectedMask = ins.expected.toInt(&ins.expectedMaskValid);
+}
 
-    DeviceInterface::Type ifaceType;
-    QString property;
-    QVariant value;
-    Predicate::ComparisonOperator compOperator;
+bool compareValue(const Instruction &ins, const QVariant &value)
+{
+    if (ins.op == Instruction::CompareMask) {
+        bool ok;
+        const int v = value.toInt(&ok);
+        return ins.expectedMaskValid && ok && (v & ins.expectedMask);
+    }
+    return value == ins.expected;
+}
 
-    Predicate *operand1;
-    Predicate *operand2;
+bool evaluate(const Instruction *ins, const Device &device)
+{
+    switch (ins->op) {
+    case Instruction::Fail:
+        return false;
+    case Instruction::IsInterface:
+        return device.isDeviceInterface(ins->ifaceType);
+    case Instruction::And: {
+        const Instruction *lhs = ins + 1;
+        return evaluate(lhs, device) && evaluate(lhs + lhs->size, device);
+    }
+    case Instruction::Or: {
+        const Instruction *lhs = ins + 1;
+        return evaluate(lhs, device) || evaluate(lhs + lhs->size, device);
+    }
+    case Instruction::CompareEquals:
+    case Instruction::CompareMask: {
+        const DeviceInterface *iface = device.asDeviceInterface(ins->ifaceType);
+        if (iface == nullptr) {
+            return false;
+        }
+
+        const QMetaObject *metaObject = iface->metaObject();
+        if (Q_LIKELY(metaObject == ins->metaObject)) {
+            const QMetaProperty metaProp = metaObject->property(ins->propertyIndex);
+            return compareValue(*ins, metaProp.isReadable() ? metaProp.read(iface) : QVariant());
+        }
+
+        // Only reached if the frontend class is subclassed; resolve on the fly
+        Instruction resolved = *ins;
+        resolveProperty(resolved, metaObject, ins->expected);
+        const QMetaProperty metaProp = metaObject->property(resolved.propertyIndex);
+        return compareValue(resolved, metaProp.isReadable() ? metaProp.read(iface) : QVariant());
+    }
+    }
+
+    return false;
+}
+}
+
+// Instructions of a whole predicate, see Instruction. Shared between
+// copies of a predicate, since it is immutable once built.
+struct CompiledPredicate
+{
+    CompiledPredicate() : ref(1) {}
+
+    mutable QAtomicInt ref;
+    QVector<Instruction> instructions;
 };
 }
 
+static void releaseProgram(const Solid::CompiledPredicate *program)
+{
+    if (program && !program->ref.deref()) {
+        delete program;
+    }
+}
+
+Solid::Predicate::Private::~Private()
+{
+    releaseProgram(compiled.loadAcquire());
+}
+
+void Solid::Predicate::Private::compileInto(CompiledPredicate &compiledPredicate) const
+{
+    QVector<Instruction> &program = compiledPredicate.instructions;
+    const int start = program.size();
+    program.append(Instruction());
+
+    if (isValid) {
+        switch (type) {
+        case Conjunction:
+        case Disjunction:
+            program[start].op = (type == Conjunction) ? Instruction::And : Instruction::Or;
+            operand1->d->compileInto(compiledPredicate);
+            operand2->d->compileInto(compiledPredicate);
+            break;
+        case InterfaceCheck:
+            program[start].op = Instruction::IsInterface;
+            program[start].ifaceType = ifaceType;
+            break;
+        case PropertyCheck: {
+            Instruction &ins = program[start];
+            ins.op = (compOperator == Mask) ? Instruction::CompareMask : Instruction::CompareEquals;
+            ins.ifaceType = ifaceType;
+            ins.property = property.toLatin1();
+            resolveProperty(ins, interfaceMetaObject(ifaceType), value);
+            break;
+        }
+        }
+    }
+
+    program[start].size = program.size() - start;
+}
+
+const Solid::CompiledPredicate *Solid::Predicate::Private::program() const
+{
+    const CompiledPredicate *current = compiled.loadAcquire();
+    if (current) {
+        return current;
+    }
+
+    CompiledPredicate *fresh = new CompiledPredicate;
+    compileInto(*fresh);
+    fresh->instructions.squeeze();
+
+    if (!compiled.testAndSetOrdered(nullptr, fresh, current)) {
+        // Another thread compiled it first, use theirs
+        delete fresh;
+        return current;
+    }
+    return fresh;
+}
+
+void Solid::Predicate::Private::resetProgram()
+{
+    releaseProgram(compiled.fetchAndStoreOrdered(nullptr));
+}
+
 Solid::Predicate::Predicate()
     : d(new Private())
 {
@@ -119,6 +326,7 @@ Solid::Predicate::~Predicate()
 
 Solid::Predicate &Solid::Predicate::operator=(const Predicate &other)
 {
+    d->resetProgram();
     d->isValid = other.d->isValid;
     d->type = other.d->type;
 
@@ -136,6 +344,12 @@ Solid::Predicate &Solid::Predicate::operator=(const Predicate &other)
         d->compOperator = other.d->compOperator;
     }
 
+    // Copies are equivalent, no need to compile them again
+    if (const CompiledPredicate *program = other.d->compiled.loadAcquire()) {
+        program->ref.ref();
+        d->compiled.storeRelease(program);
+    }
+
     return *this;
 }
 
@@ -186,50 +400,7 @@ bool Solid::Predicate::matches(const Device &device) const
         return false;
     }
 
-    switch (d->type) {
-    case Disjunction:
-        return d->operand1->matches(device)
-               || d->operand2->matches(device);
-    case Conjunction:
-        return d->operand1->matches(device)
-               && d->operand2->matches(device);
-    case PropertyCheck: {
-        const DeviceInterface *iface = device.asDeviceInterface(d->ifaceType);
-
-        if (iface != nullptr) {
-            const int index = iface->metaObject()->indexOfProperty(d->property.toLatin1());
-            QMetaProperty metaProp = iface->metaObject()->property(index);
-            QVariant value = metaProp.isReadable() ? metaProp.read(iface) : QVariant();
-            QVariant expected = d->value;
-
-            if (metaProp.isEnumType() && expected.type() == QVariant::String) {
-                QMetaEnum metaEnum = metaProp.enumerator();
-                int value = metaEnum.keysToValue(d->value.toString().toLatin1());
-                if (value >= 0) { // No value found for these keys, resetting expected to invalid
-                    expected = value;
-                } else {
-                    expected = QVariant();
-                }
-            }
-
-            if (d->compOperator == Mask) {
-                bool v_ok;
-                int v = value.toInt(&v_ok);
-                bool e_ok;
-                int e = expected.toInt(&e_ok);
-
-                return (e_ok && v_ok && (v & e));
-            } else {
-                return (value == expected);
-            }
-        }
-        break;
-    }
-    case InterfaceCheck:
-        return device.isDeviceInterface(d->ifaceType);
-    }
-
-    return false;
+    return evaluate(d->program()->instructions.constData(), device);
 }
 
 QSet<Solid::DeviceInterface::Type> Solid::Predicate::usedTypes() const
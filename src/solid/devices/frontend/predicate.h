@@ -200,6 +200,23 @@ public:
      */
     static Predicate fromString(const QString &predicate);
 
+    /**
+     * Retrieves how many fromString() calls found their string, once
+     * whitespace is normalized, among the recently parsed ones.
+     *
+     * @return the process wide number of cache hits
+     * @since 5.32
+     */
+    static qulonglong cacheHits();
+
+    /**
+     * Retrieves how many fromString() calls had to parse their string.
+     *
+     * @return the process wide number of cache misses
+     * @since 5.32
+     */
+    static qulonglong cacheMisses();
+
     /**
     * Retrieves the predicate type, used to determine how to handle the predicate
     *
@@ -0,0 +1,70 @@
+/*
+    Copyright 2006 Kevin Ottens <ervin@kde.org>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) version 3, or any
+    later version accepted by the membership of KDE e.V. (or its
+    successor approved by the membership of KDE e.V.), which shall
+    act as a proxy defined in Section 6 of version 3 of the license.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOLID_PREDICATE_P_H
+#define SOLID_PREDICATE_P_H
+
+#include "predicate.h"
+
+#include <QtCore/QAtomicPointer>
+
+namespace Solid
+{
+struct CompiledPredicate;
+
+namespace PredicateParse
+{
+struct Result;
+}
+
+class Predicate::Private
+{
+public:
+
+    Private() : isValid(false), type(PropertyCheck),
+        compOperator(Predicate::Equals),
+        operand1(nullptr), operand2(nullptr) {}
+
+    ~Private();
+
+    void compileInto(CompiledPredicate &compiledPredicate) const;
+    const CompiledPredicate *program() const;
+    void resetProgram();
+
+    // Builds this predicate from the parsed node at 'index', see predicateparse.cpp
+    void build(const PredicateParse::Result &result, int index);
+
+    bool isValid;
+    Type type;
+
+    DeviceInterface::Type ifaceType;
+    QString property;
+    QVariant value;
+    Predicate::ComparisonOperator compOperator;
+
+    Predicate *operand1;
+    Predicate *operand2;
+
+    // Lazily built on the first matches(), dropped when the predicate changes
+    mutable QAtomicPointer<const CompiledPredicate> compiled;
+};
+}
+
+#endif
@@ -23,6 +23,12 @@
 
 #include "soliddefs_p.h"
 #include <solid/devices/ifaces/processor.h>
+#include <solid/device.h>
+
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <cmath>
 
 Solid::Processor::Processor(QObject *backendObject)
     : DeviceInterface(*new ProcessorPrivate(), backendObject)
@@ -58,3 +64,168 @@ Solid::Processor::InstructionSets Solid::Processor::instructionSets() const
     return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), InstructionSets(), instructionSets());
 }
 
+int Solid::Processor::packageId() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), -1, packageId());
+}
+
+int Solid::Processor::dieId() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), -1, dieId());
+}
+
+int Solid::Processor::coreId() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), -1, coreId());
+}
+
+int Solid::Processor::numaNode() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), -1, numaNode());
+}
+
+QList<int> Solid::Processor::siblings() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), QList<int>(), siblings());
+}
+
+QList<Solid::Processor::Cache> Solid::Processor::caches() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), QList<Cache>(), caches());
+}
+
+Solid::Processor::CoreClass Solid::Processor::coreClass() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), UnknownCore, coreClass());
+}
+
+int Solid::Processor::capacity() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), -1, capacity());
+}
+
+bool Solid::Processor::isUsable() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), true, isUsable());
+}
+
+static bool topologyLessThan(const Solid::Processor::Topology &a, const Solid::Processor::Topology &b)
+{
+    return a.number < b.number;
+}
+
+QList<Solid::Processor::Topology> Solid::Processor::topology()
+{
+    QList<Topology> table;
+
+    // A single trip to the backend thread, the calls made from there
+    // don't queue up again
+    runInBackendThread([&table]() {
+        const QList<Device> devices = Device::listFromType(DeviceInterface::Processor);
+        table.reserve(devices.count());
+        Q_FOREACH (const Device &device, devices) {
+            const Processor *processor = device.as<Processor>();
+            if (!processor) {
+                continue;
+            }
+            Topology entry;
+            entry.number = processor->number();
+            entry.packageId = processor->packageId();
+            entry.dieId = processor->dieId();
+            entry.coreId = processor->coreId();
+            entry.numaNode = processor->numaNode();
+            entry.siblings = processor->siblings();
+            entry.coreClass = processor->coreClass();
+            entry.capacity = processor->capacity();
+            table.append(entry);
+        }
+    });
+
+    std::sort(table.begin(), table.end(), topologyLessThan);
+    return table;
+}
+
+QMap<Solid::Processor::CoreClass, QList<int> > Solid::Processor::coreClasses()
+{
+    QMap<CoreClass, QList<int> > classes;
+
+    // topology() is sorted, and so are the lists
+    Q_FOREACH (const Topology &entry, topology()) {
+        classes[entry.coreClass].append(entry.number);
+    }
+
+    return classes;
+}
+
+QList<int> Solid::Processor::usableProcessors()
+{
+    QList<int> usable;
+
+    // One trip to the backend thread, which reads the affinity once
+    runInBackendThread([&usable]() {
+        const QList<Device> devices = Device::listFromType(DeviceInterface::Processor);
+        Q_FOREACH (const Device &device, devices) {
+            const Processor *processor = device.as<Processor>();
+            if (processor && processor->isUsable()) {
+                usable.append(processor->number());
+            }
+        }
+    });
+
+    std::sort(usable.begin(), usable.end());
+    return usable;
+}
+
+qreal Solid::Processor::processCpuQuota() const
+{
+    Q_D(const Processor);
+    return_SOLID_CALL(Ifaces::Processor *, d->backendObject(), -1, cpuQuota());
+}
+
+qreal Solid::Processor::cpuQuota()
+{
+    qreal quota = -1;
+
+    runInBackendThread([&quota]() {
+        // The quota is the same for all processors, ask the first one
+        const QList<Device> devices = Device::listFromType(DeviceInterface::Processor);
+        const Processor *processor = devices.isEmpty() ? nullptr : devices.first().as<Processor>();
+        if (processor) {
+            quota = processor->processCpuQuota();
+        }
+    });
+
+    return quota;
+}
+
+int Solid::Processor::idealThreadCount()
+{
+    int count = 0;
+    qreal quota = -1;
+
+    // Both helpers run directly from within the job
+    runInBackendThread([&count, &quota]() {
+        count = usableProcessors().count();
+        quota = cpuQuota();
+    });
+
+    if (count == 0) {
+        // No backend lists processors here
+        count = QThread::idealThreadCount();
+    }
+
+    if (quota > 0) {
+        count = qMin(count, int(std::ceil(quota)));
+    }
+
+    return qMax(1, count);
+}
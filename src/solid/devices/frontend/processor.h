@@ -25,6 +25,9 @@
 
 #include <solid/deviceinterface.h>
 
+#include <QtCore/QList>
+#include <QtCore/QMap>
+
 namespace Solid
 {
 class ProcessorPrivate;
@@ -40,6 +43,14 @@ class SOLID_EXPORT Processor : public DeviceInterface
     Q_PROPERTY(qulonglong maxSpeed READ maxSpeed)
     Q_PROPERTY(bool canChangeFrequency READ canChangeFrequency)
     Q_PROPERTY(InstructionSets instructionSets READ instructionSets)
+    Q_PROPERTY(int packageId READ packageId)
+    Q_PROPERTY(int dieId READ dieId)
+    Q_PROPERTY(int coreId READ coreId)
+    Q_PROPERTY(int numaNode READ numaNode)
+    Q_PROPERTY(QList<int> siblings READ siblings)
+    Q_PROPERTY(CoreClass coreClass READ coreClass)
+    Q_PROPERTY(int capacity READ capacity)
+    Q_PROPERTY(bool usable READ isUsable)
     Q_DECLARE_PRIVATE(Processor)
     friend class Device;
 
@@ -70,7 +81,23 @@ public:
         IntelSse41 = 0x10,
         IntelSse42 = 0x100,
         Amd3DNow = 0x20,
-        AltiVec = 0x40
+        AltiVec = 0x40,
+        IntelAvx = 0x200, ///< @since 5.32
+        IntelAvx2 = 0x400, ///< @since 5.32
+        IntelFma3 = 0x800, ///< @since 5.32
+        IntelAvx512F = 0x1000, ///< @since 5.32
+        IntelAvx512Cd = 0x2000, ///< @since 5.32
+        IntelAvx512Bw = 0x4000, ///< @since 5.32
+        IntelAvx512Dq = 0x8000, ///< @since 5.32
+        IntelAvx512Vl = 0x10000, ///< @since 5.32
+        IntelBmi1 = 0x20000, ///< @since 5.32
+        IntelBmi2 = 0x40000, ///< @since 5.32
+        IntelAes = 0x80000, ///< @since 5.32
+        IntelSha = 0x100000, ///< @since 5.32
+        IntelVaes = 0x200000, ///< @since 5.32
+        IntelVpclmulqdq = 0x400000, ///< @since 5.32
+        ArmNeon = 0x800000, ///< @since 5.32
+        ArmSve = 0x1000000 ///< @since 5.32
     };
     Q_ENUM(InstructionSet)
 
@@ -80,6 +107,70 @@ public:
     Q_DECLARE_FLAGS(InstructionSets, InstructionSet)
     Q_FLAG(InstructionSets)
 
+    /**
+     * This enum contains the kinds of data a cache holds.
+     *
+     * @since 5.32
+     */
+    enum CacheType {
+        UnknownCache,
+        DataCache,
+        InstructionCache,
+        UnifiedCache
+    };
+    Q_ENUM(CacheType)
+
+    /**
+     * This enum contains the kinds of cores of hybrid processors.
+     *
+     * @since 5.32
+     */
+    enum CoreClass {
+        UnknownCore,
+        PerformanceCore, ///< Intel "Core" cores, ARM big cores, and all cores of non-hybrid systems
+        EfficiencyCore ///< Intel "Atom" cores, ARM LITTLE cores
+    };
+    Q_ENUM(CoreClass)
+
+    /**
+     * One cache the processor uses, as returned by caches().
+     *
+     * @since 5.32
+     */
+    struct Cache {
+        Cache()
+            : level(0), type(UnknownCache), size(0), lineSize(0), associativity(0) { }
+
+        int level;
+        CacheType type;
+        qulonglong size; ///< in bytes
+        int lineSize; ///< in bytes
+        int associativity; ///< number of ways, 0 if unknown
+        QList<int> sharedWith; ///< the processor numbers using this very cache, empty if unknown
+    };
+
+    /**
+     * Where one logical processor sits in the system, as returned by topology().
+     *
+     * Identifiers the system doesn't report are -1.
+     *
+     * @since 5.32
+     */
+    struct Topology {
+        Topology()
+            : number(-1), packageId(-1), dieId(-1), coreId(-1), numaNode(-1),
+              coreClass(UnknownCore), capacity(-1) { }
+
+        int number;
+        int packageId;
+        int dieId;
+        int coreId;
+        int numaNode;
+        QList<int> siblings;
+        CoreClass coreClass;
+        int capacity;
+    };
+
     /**
      * Destroys a Processor object.
      */
@@ -128,6 +219,153 @@ public:
      * @see Solid::Processor::InstructionSet
      */
     InstructionSets instructionSets() const;
+
+    /**
+     * Retrieves the physical package (socket) holding the processor.
+     *
+     * @return the package id, or -1 if unknown
+     * @since 5.32
+     */
+    int packageId() const;
+
+    /**
+     * Retrieves the die of the package holding the processor.
+     *
+     * @return the die id within the package, or -1 if unknown
+     * @since 5.32
+     */
+    int dieId() const;
+
+    /**
+     * Retrieves the core the processor is a hardware thread of.
+     *
+     * Core ids are only unique within a package and die.
+     *
+     * @return the core id, or -1 if unknown
+     * @since 5.32
+     */
+    int coreId() const;
+
+    /**
+     * Retrieves the NUMA node the processor belongs to.
+     *
+     * @return the node number, or -1 if unknown
+     * @since 5.32
+     */
+    int numaNode() const;
+
+    /**
+     * Retrieves the logical processors sharing a core with this one
+     * (SMT siblings), including this processor.
+     *
+     * @return the sorted processor numbers, or an empty list if unknown
+     * @since 5.32
+     */
+    QList<int> siblings() const;
+
+    /**
+     * Retrieves the caches the processor uses, from the innermost
+     * level outwards.
+     *
+     * Processors that share a cache, like the SMT siblings of a core
+     * for its L2 or the cores of a package for its L3, list each other
+     * in Cache::sharedWith.
+     *
+     * @return the caches, or an empty list if unknown
+     * @since 5.32
+     */
+    QList<Cache> caches() const;
+
+    /**
+     * Retrieves the kind of core the processor is a hardware thread of.
+     *
+     * @return the core class, UnknownCore if the system doesn't tell
+     * @since 5.32
+     */
+    CoreClass coreClass() const;
+
+    /**
+     * Retrieves the relative compute capacity of the processor, on the
+     * scale the Linux scheduler uses: 1024 is the fastest processor of
+     * the system.
+     *
+     * Systems reporting no capacity get one from the maximum frequency.
+     *
+     * @return the capacity, or -1 if unknown
+     * @since 5.32
+     */
+    int capacity() const;
+
+    /**
+     * Indicates if the current process may run on the processor, as
+     * allowed by its affinity mask and, on Linux, its cgroup cpuset.
+     *
+     * The affinity mask is read on each call. On Linux, changes to the
+     * cgroup made from outside the process show within a second.
+     *
+     * @return true if the process can use the processor or nothing tells otherwise
+     * @since 5.32
+     */
+    bool isUsable() const;
+
+    /**
+     * Retrieves the topology of all the processors of the system at once,
+     * sorted by processor number.
+     *
+     * The whole table is gathered in a single call into the backend
+     * thread, so prefer this over querying every processor device when
+     * laying out threads.
+     *
+     * @since 5.32
+     */
+    static QList<Topology> topology();
+
+    /**
+     * Retrieves the processor numbers of each core class, sorted, for
+     * building affinity masks.
+     *
+     * @since 5.32
+     */
+    static QMap<CoreClass, QList<int> > coreClasses();
+
+    /**
+     * Retrieves the numbers of the processors the current process may
+     * run on, sorted.
+     *
+     * This reflects the affinity mask at the time of the call, so it follows
+     * sched_setaffinity(); cgroup changes show within a second.
+     *
+     * @see isUsable()
+     * @since 5.32
+     */
+    static QList<int> usableProcessors();
+
+    /**
+     * Retrieves the CPU bandwidth the current process may use, in
+     * processors, such as 1.5 for a cgroup cpu.max of "150000 100000".
+     *
+     * @return the quota, or -1 if unlimited or unknown
+     * @since 5.32
+     */
+    static qreal cpuQuota();
+
+    /**
+     * Retrieves how many threads the current process can keep busy:
+     * its usable processors, capped by its CPU quota rounded up.
+     *
+     * Unlike QThread::idealThreadCount(), this doesn't oversubscribe
+     * processes confined to a few CPUs of a large machine.
+     *
+     * @return the thread count, at least 1
+     * @since 5.32
+     */
+    static int idealThreadCount();
+
+private:
+    /**
+     * The backend side of cpuQuota(), asked of one processor.
+     */
+    qreal processCpuQuota() const;
 };
 }
 
@@ -24,6 +24,30 @@
 #include "soliddefs_p.h"
 #include <solid/devices/ifaces/storageaccess.h>
 
+#include <QtCore/QThread>
+#include <QApplication>
+#include <QWidget>
+
+// Only touched from within backend thread jobs, which never overlap
+static uint s_passphraseWindowId = 0;
+
+uint Solid::passphraseWindowId()
+{
+    return s_passphraseWindowId;
+}
+
+static uint activeWindowId()
+{
+    // Widgets belong to the GUI thread, callers elsewhere get no parent
+    if (!qobject_cast<QApplication *>(QCoreApplication::instance())
+            || QThread::currentThread() != QCoreApplication::instance()->thread()) {
+        return 0;
+    }
+
+    QWidget *activeWindow = QApplication::activeWindow();
+    return activeWindow != nullptr ? uint(activeWindow->winId()) : 0;
+}
+
 Solid::StorageAccess::StorageAccess(QObject *backendObject)
     : DeviceInterface(*new StorageAccessPrivate(), backendObject)
 {
@@ -76,13 +100,27 @@ QString Solid::StorageAccess::filePath() const
 bool Solid::StorageAccess::setup()
 {
     Q_D(StorageAccess);
-    return_SOLID_CALL(Ifaces::StorageAccess *, d->backendObject(), false, setup());
+    const uint windowId = activeWindowId();
+    return callInBackendThread([d, windowId]() {
+        Ifaces::StorageAccess *t = qobject_cast<Ifaces::StorageAccess *>(d->backendObject());
+        if (t == nullptr) {
+            return false;
+        }
+        s_passphraseWindowId = windowId;
+        const bool result = t->setup();
+        s_passphraseWindowId = 0;
+        return result;
+    });
 }
 
 bool Solid::StorageAccess::teardown()
 {
     Q_D(StorageAccess);
-    return_SOLID_CALL(Ifaces::StorageAccess *, d->backendObject(), false, teardown());
+    // Like setup(), it starts calls replying to the backend thread
+    return callInBackendThread([d]() {
+        Ifaces::StorageAccess *t = qobject_cast<Ifaces::StorageAccess *>(d->backendObject());
+        return t != nullptr ? t->teardown() : false;
+    });
 }
 
 bool Solid::StorageAccess::isIgnored() const
@@ -77,7 +77,8 @@ qulonglong Solid::StorageDrive::size() const
 bool Solid::StorageDrive::isInUse() const
 {
     Q_D(const StorageDrive);
-    Predicate p(DeviceInterface::StorageAccess);
+    // Built once, so that its compiled form is reused by every call
+    static const Predicate p(DeviceInterface::StorageAccess);
     QList<Device> devices = Device::listFromQuery(p, d->devicePrivate()->udi());
 
     bool inUse = false;
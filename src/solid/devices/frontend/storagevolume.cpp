@@ -80,13 +80,11 @@ Solid::Device Solid::StorageVolume::encryptedContainer() const
 {
     Q_D(const StorageVolume);
 
-    Ifaces::StorageVolume *iface
-        = qobject_cast<Ifaces::StorageVolume *>(d->backendObject());
-
-    if (iface != nullptr) {
-        return Device(iface->encryptedContainerUdi());
-    } else {
-        return Device();
-    }
+    const QString udi = callWithBackendsLocked([d]() {
+        Ifaces::StorageVolume *iface = qobject_cast<Ifaces::StorageVolume *>(d->backendObject());
+        return iface != nullptr ? iface->encryptedContainerUdi() : QString();
+    });
+
+    return Device(udi);
 }
 
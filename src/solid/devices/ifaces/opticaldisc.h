@@ -86,6 +86,25 @@ public:
      * @return the capacity of the disc in bytes
      */
     virtual qulonglong capacity() const = 0;
+
+    /**
+     * Indicates if the disc is still being read to find out its content
+     * types, availableContent() only reports part of them meanwhile.
+     *
+     * @return true if the content types are being probed, false otherwise
+     */
+    virtual bool isContentProbePending() const = 0;
+
+protected:
+    //Q_SIGNALS:
+    /**
+     * This signal is emitted when the content types of the disc changed,
+     * such as when a content probe completes.
+     *
+     * @param content the new content types
+     * @param udi the UDI of the disc
+     */
+    virtual void availableContentChanged(Solid::OpticalDisc::ContentTypes content, const QString &udi) = 0;
 };
 }
 }
@@ -70,6 +70,80 @@ public:
      */
     virtual Solid::Processor::InstructionSets instructionSets() const = 0;
 
+    /**
+     * Retrieves the physical package (socket) holding the processor.
+     *
+     * @return the package id, or -1 if unknown
+     */
+    virtual int packageId() const = 0;
+
+    /**
+     * Retrieves the die of the package holding the processor.
+     *
+     * @return the die id, or -1 if unknown
+     */
+    virtual int dieId() const = 0;
+
+    /**
+     * Retrieves the core the processor is a hardware thread of.
+     *
+     * @return the core id, or -1 if unknown
+     */
+    virtual int coreId() const = 0;
+
+    /**
+     * Retrieves the NUMA node the processor belongs to.
+     *
+     * @return the node number, or -1 if unknown
+     */
+    virtual int numaNode() const = 0;
+
+    /**
+     * Retrieves the logical processors sharing a core with this one,
+     * including itself.
+     *
+     * @return the sorted processor numbers, or an empty list if unknown
+     */
+    virtual QList<int> siblings() const = 0;
+
+    /**
+     * Retrieves the caches the processor uses, from the innermost level
+     * outwards.
+     *
+     * @return the caches, or an empty list if unknown
+     */
+    virtual QList<Solid::Processor::Cache> caches() const = 0;
+
+    /**
+     * Retrieves the kind of core the processor is a hardware thread of.
+     *
+     * @return the core class, UnknownCore if the system doesn't tell
+     */
+    virtual Solid::Processor::CoreClass coreClass() const = 0;
+
+    /**
+     * Retrieves the relative compute capacity of the processor, 1024
+     * being the fastest one of the system.
+     *
+     * @return the capacity, or -1 if unknown
+     */
+    virtual int capacity() const = 0;
+
+    /**
+     * Indicates if the current process may run on the processor.
+     *
+     * @return true if the process can use the processor or nothing tells otherwise
+     */
+    virtual bool isUsable() const = 0;
+
+    /**
+     * Retrieves the CPU bandwidth the current process may use, in
+     * processors. It is the same for all the processors of a system.
+     *
+     * @return the quota, or -1 if unlimited or unknown
+     */
+    virtual qreal cpuQuota() const = 0;
+
 };
 }
 }
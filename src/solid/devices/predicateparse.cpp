@@ -18,213 +18,597 @@
     License along with this library. If not, see <http://www.gnu.org/licenses/>.
 */
 
-extern "C"
-{
 #include "predicateparse.h"
+#include "predicate_p.h"
 
-    void PredicateParse_mainParse(const char *_code);
-}
-
-#include "predicate.h"
-#include "soliddefs_p.h"
-
-#include <stdlib.h>
-
+#include <QtCore/QCache>
+#include <QtCore/QMetaEnum>
+#include <QtCore/QMutex>
 #include <QtCore/QStringList>
-#include <QtCore/QThreadStorage>
 
 namespace Solid
 {
 namespace PredicateParse
 {
 
-struct ParsingData {
-    ParsingData()
-        : result(nullptr)
-    {}
-
-    Solid::Predicate *result;
-    QByteArray buffer;
-};
+// Deeper predicates are refused rather than risking the stack
+static const int MaxDepth = 256;
 
-}
-}
-
-Q_GLOBAL_STATIC(QThreadStorage<Solid::PredicateParse::ParsingData *>, s_parsingData)
-
-Solid::Predicate Solid::Predicate::fromString(const QString &predicate)
+/*
+ * Recursive descent parser for:
+ *
+ *   predicate := atom | '[' predicate ( AND | OR ) predicate ']'
+ *   atom      := ID '.' ID ( '==' | '&' ) value | IS ID
+ *   value     := STRING | BOOL | NUM | FLOAT | '{' list '}'
+ *   list      := <empty> | STRING | STRING ',' list
+ *
+ * Keywords are case insensitive. Tokens are never copied out of the
+ * parsed text, only values end up in QVariants.
+ */
+class Parser
 {
-    Solid::PredicateParse::ParsingData *data = new Solid::PredicateParse::ParsingData();
-    s_parsingData->setLocalData(data);
-    data->buffer = predicate.toLatin1();
-    PredicateParse_mainParse(data->buffer.constData());
-    Predicate result;
-    if (data->result) {
-        result = Predicate(*data->result);
-        delete data->result;
+public:
+    Parser(const QStringRef &text, Result *result)
+        : m_text(text)
+        , m_data(text.unicode())
+        , m_size(text.size())
+        , m_pos(0)
+        , m_result(result)
+    {
+        next();
     }
-    s_parsingData->setLocalData(nullptr);
-    return result;
-}
 
-void PredicateParse_setResult(void *result)
-{
-    Solid::PredicateParse::ParsingData *data = s_parsingData->localData();
-    data->result = (Solid::Predicate *) result;
-}
+    bool parse()
+    {
+        const int root = parsePredicate(0);
+        if (root < 0) {
+            return false;
+        }
+        if (m_token != End) {
+            return error(QStringLiteral("unexpected trailing input"));
+        }
+        m_result->root = root;
+        return true;
+    }
 
-void PredicateParse_errorDetected(const char *s)
-{
-    qWarning("ERROR from solid predicate parser: %s", s);
-    s_parsingData->localData()->result = nullptr;
-}
+private:
+    enum Token { End, Eq, Mask, And, Or, Is, Bool, String, Num, Float, Id,
+                 LeftBracket, RightBracket, LeftBrace, RightBrace, Comma, Dot, Invalid
+               };
 
-void PredicateParse_destroy(void *pred)
-{
-    Solid::PredicateParse::ParsingData *data = s_parsingData->localData();
-    Solid::Predicate *p = (Solid::Predicate *) pred;
-    if (p != data->result) {
-        delete p;
+    bool isLetter(QChar c) const
+    {
+        const ushort u = c.unicode();
+        return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z');
     }
-}
 
-void *PredicateParse_newAtom(char *interface, char *property, void *value)
-{
-    QString iface(interface);
-    QString prop(property);
-    QVariant *val = (QVariant *)value;
+    bool isDigit(int pos) const
+    {
+        if (pos >= m_size) {
+            return false;
+        }
+        const ushort u = m_data[pos].unicode();
+        return u >= '0' && u <= '9';
+    }
 
-    Solid::Predicate *result = new Solid::Predicate(iface, prop, *val);
+    bool isKeyword(const char *keyword) const
+    {
+        const int length = m_tokenEnd - m_tokenBegin;
+        for (int i = 0; i < length; ++i) {
+            if (!keyword[i] || m_data[m_tokenBegin + i].toLower().unicode() != ushort(keyword[i])) {
+                return false;
+            }
+        }
+        return keyword[length] == '\0';
+    }
 
-    delete val;
-    free(interface);
-    free(property);
+    void next()
+    {
+        while (m_pos < m_size) {
+            const QChar c = m_data[m_pos];
+            if (c == QLatin1Char(' ') || c == QLatin1Char('\t') || c == QLatin1Char('\n') || c == QLatin1Char('\r')) {
+                ++m_pos;
+                continue;
+            }
+
+            m_tokenBegin = m_pos;
+
+            if (isLetter(c)) {
+                do {
+                    ++m_pos;
+                } while (m_pos < m_size && (isLetter(m_data[m_pos]) || isDigit(m_pos) || m_data[m_pos] == QLatin1Char('-')));
+                m_tokenEnd = m_pos;
+
+                if (isKeyword("and")) {
+                    m_token = And;
+                } else if (isKeyword("or")) {
+                    m_token = Or;
+                } else if (isKeyword("is")) {
+                    m_token = Is;
+                } else if (isKeyword("true") || isKeyword("false")) {
+                    m_token = Bool;
+                } else {
+                    m_token = Id;
+                }
+                return;
+            }
+
+            if (isDigit(m_pos) || ((c == QLatin1Char('-') || c == QLatin1Char('.')) && isDigit(m_pos + 1))
+                || (c == QLatin1Char('-') && m_pos + 2 < m_size && m_data[m_pos + 1] == QLatin1Char('.') && isDigit(m_pos + 2))) {
+                if (c == QLatin1Char('-')) {
+                    ++m_pos;
+                }
+                while (isDigit(m_pos)) {
+                    ++m_pos;
+                }
+                m_token = Num;
+                if (m_pos < m_size && m_data[m_pos] == QLatin1Char('.') && isDigit(m_pos + 1)) {
+                    m_token = Float;
+                    ++m_pos;
+                    while (isDigit(m_pos)) {
+                        ++m_pos;
+                    }
+                }
+                m_tokenEnd = m_pos;
+                return;
+            }
+
+            ++m_pos;
+            m_tokenEnd = m_pos;
+
+            switch (c.unicode()) {
+            case '=':
+                if (m_pos < m_size && m_data[m_pos] == QLatin1Char('=')) {
+                    m_tokenEnd = ++m_pos;
+                    m_token = Eq;
+                    return;
+                }
+                break;
+            case '&':
+                m_token = Mask;
+                return;
+            case '[':
+                m_token = LeftBracket;
+                return;
+            case ']':
+                m_token = RightBracket;
+                return;
+            case '{':
+                m_token = LeftBrace;
+                return;
+            case '}':
+                m_token = RightBrace;
+                return;
+            case ',':
+                m_token = Comma;
+                return;
+            case '.':
+                m_token = Dot;
+                return;
+            case '\'':
+                while (m_pos < m_size && m_data[m_pos] != QLatin1Char('\'')) {
+                    ++m_pos;
+                }
+                if (m_pos == m_size) {
+                    m_token = Invalid;
+                    m_errorMessage = QStringLiteral("unterminated string");
+                    return;
+                }
+                m_tokenEnd = ++m_pos;
+                m_token = String;
+                return;
+            default:
+                break;
+            }
+
+            // Unknown characters were always skipped, keep accepting them
+            qWarning("ERROR from solid predicate parser: unrecognized token '%s' at position %d in predicate '%s'",
+                     qPrintable(QString(c)), m_tokenBegin, qPrintable(m_text.toString()));
+        }
+
+        m_tokenBegin = m_tokenEnd = m_pos;
+        m_token = End;
+    }
 
-    return result;
-}
+    bool error(const QString &message)
+    {
+        m_result->root = -1;
+        m_result->errorPosition = m_tokenBegin;
+        m_result->errorMessage = m_token == Invalid ? m_errorMessage : message;
+        return false;
+    }
 
-void *PredicateParse_newMaskAtom(char *interface, char *property, void *value)
-{
-    QString iface(interface);
-    QString prop(property);
-    QVariant *val = (QVariant *)value;
+    QStringRef tokenText() const
+    {
+        return m_text.mid(m_tokenBegin, m_tokenEnd - m_tokenBegin);
+    }
 
-    Solid::Predicate *result = new Solid::Predicate(iface, prop, *val, Solid::Predicate::Mask);
+    QString unquote() const
+    {
+        QString res;
+        res.reserve(m_tokenEnd - m_tokenBegin - 2);
+        for (int i = m_tokenBegin + 1; i < m_tokenEnd - 1; ++i) {
+            if (m_data[i] != QLatin1Char('\\')) {
+                res += m_data[i];
+            } else if (++i < m_tokenEnd - 1) {
+                switch (m_data[i].unicode()) {
+                case '\\':
+                    res += QLatin1Char('\\');
+                    break;
+                case 'n':
+                    res += QLatin1Char('\n');
+                    break;
+                case 'r':
+                    res += QLatin1Char('\r');
+                    break;
+                case 't':
+                    res += QLatin1Char('\t');
+                    break;
+                default: // Unknown escapes are dropped
+                    break;
+                }
+            }
+        }
+        return res;
+    }
 
-    delete val;
-    free(interface);
-    free(property);
+    DeviceInterface::Type interfaceType(bool *ok) const
+    {
+        static const QMetaEnum metaEnum = DeviceInterface::staticMetaObject.enumerator(
+                                              DeviceInterface::staticMetaObject.indexOfEnumerator("Type"));
 
-    return result;
-}
+        // Identifiers are plain ASCII, see next()
+        QVarLengthArray<char, 32> key;
+        for (int i = m_tokenBegin; i < m_tokenEnd; ++i) {
+            key.append(char(m_data[i].unicode()));
+        }
+        key.append('\0');
 
-void *PredicateParse_newIsAtom(char *interface)
-{
-    QString iface(interface);
+        return DeviceInterface::Type(metaEnum.keyToValue(key.constData(), ok));
+    }
 
-    Solid::Predicate *result = new Solid::Predicate(iface);
+    int addNode()
+    {
+        m_result->nodes.append(Node());
+        return m_result->nodes.size() - 1;
+    }
 
-    free(interface);
+    int parsePredicate(int depth)
+    {
+        if (depth > MaxDepth) {
+            error(QStringLiteral("predicate nested too deeply"));
+            return -1;
+        }
+
+        switch (m_token) {
+        case LeftBracket: {
+            next();
+            const int operand1 = parsePredicate(depth + 1);
+            if (operand1 < 0) {
+                return -1;
+            }
+
+            Predicate::Type type;
+            if (m_token == And) {
+                type = Predicate::Conjunction;
+            } else if (m_token == Or) {
+                type = Predicate::Disjunction;
+            } else {
+                error(QStringLiteral("expected AND or OR"));
+                return -1;
+            }
+            next();
+
+            const int operand2 = parsePredicate(depth + 1);
+            if (operand2 < 0) {
+                return -1;
+            }
+            if (m_token != RightBracket) {
+                error(QStringLiteral("expected ']'"));
+                return -1;
+            }
+            next();
+
+            const int index = addNode();
+            Node &node = m_result->nodes[index];
+            node.type = type;
+            node.isValid = true;
+            node.operand1 = operand1;
+            node.operand2 = operand2;
+            return index;
+        }
+        case Is: {
+            next();
+            if (m_token != Id) {
+                error(QStringLiteral("expected an interface name"));
+                return -1;
+            }
+
+            const int index = addNode();
+            Node &node = m_result->nodes[index];
+            node.type = Predicate::InterfaceCheck;
+            node.ifaceType = interfaceType(&node.isValid);
+            next();
+            return index;
+        }
+        case Id: {
+            const int index = addNode();
+            m_result->nodes[index].ifaceType = interfaceType(&m_result->nodes[index].isValid);
+            next();
+
+            if (m_token != Dot) {
+                error(QStringLiteral("expected '.'"));
+                return -1;
+            }
+            next();
+
+            if (m_token != Id) {
+                error(QStringLiteral("expected a property name"));
+                return -1;
+            }
+            m_result->nodes[index].property = tokenText();
+            next();
+
+            if (m_token == Eq) {
+                m_result->nodes[index].compOperator = Predicate::Equals;
+            } else if (m_token == Mask) {
+                m_result->nodes[index].compOperator = Predicate::Mask;
+            } else {
+                error(QStringLiteral("expected '==' or '&'"));
+                return -1;
+            }
+            next();
+
+            if (!parseValue(&m_result->nodes[index].value)) {
+                return -1;
+            }
+            return index;
+        }
+        default:
+            error(QStringLiteral("expected a predicate"));
+            return -1;
+        }
+    }
 
-    return result;
-}
+    bool parseValue(QVariant *value)
+    {
+        switch (m_token) {
+        case String:
+            *value = unquote();
+            break;
+        case Bool:
+            *value = isKeyword("true");
+            break;
+        case Num: {
+            bool ok;
+            *value = tokenText().toInt(&ok);
+            if (!ok) {
+                return error(QStringLiteral("number out of range"));
+            }
+            break;
+        }
+        case Float:
+            *value = tokenText().toDouble();
+            break;
+        case LeftBrace: {
+            QStringList list;
+            next();
+            while (m_token == String) {
+                list << unquote();
+                next();
+                if (m_token != Comma) {
+                    break;
+                }
+                next();
+            }
+            if (m_token != RightBrace) {
+                return error(QStringLiteral("expected a string or '}'"));
+            }
+            *value = list;
+            break;
+        }
+        default:
+            return error(QStringLiteral("expected a value"));
+        }
+
+        next();
+        return true;
+    }
 
-void *PredicateParse_newAnd(void *pred1, void *pred2)
+    const QStringRef m_text;
+    const QChar *const m_data;
+    const int m_size;
+    int m_pos;
+    Token m_token = End;
+    int m_tokenBegin = 0;
+    int m_tokenEnd = 0;
+    QString m_errorMessage;
+    Result *const m_result;
+};
+
+bool parse(const QStringRef &text, Result *result)
 {
-    Solid::Predicate *result = new Solid::Predicate();
+    Parser parser(text, result);
+    return parser.parse();
+}
 
-    Solid::PredicateParse::ParsingData *data = s_parsingData->localData();
-    Solid::Predicate *p1 = (Solid::Predicate *)pred1;
-    Solid::Predicate *p2 = (Solid::Predicate *)pred2;
+struct CacheData {
+    CacheData()
+        : predicates(Cache::MaxSize)
+        , hits(0)
+        , misses(0)
+    {}
 
-    if (p1 == data->result || p2 == data->result) {
-        data->result = nullptr;
-    }
+    QMutex lock;
+    QCache<QString, QSharedPointer<const Predicate> > predicates;
+    qulonglong hits;
+    qulonglong misses;
+};
 
-    *result = *p1 & *p2;
+Q_GLOBAL_STATIC(CacheData, s_cache)
 
-    delete p1;
-    delete p2;
+QString Cache::normalize(const QString &query)
+{
+    const QChar *data = query.unicode();
+    const int size = query.size();
+
+    // Most queries are written by hand in a consistent way, only copy
+    // them when there is actually something to strip
+    bool clean = size == 0 || (!data[0].isSpace() && !data[size - 1].isSpace());
+    bool quoted = false;
+    for (int i = 0; clean && i < size; ++i) {
+        if (data[i] == QLatin1Char('\'')) {
+            quoted = !quoted;
+        } else if (!quoted && data[i].isSpace()
+                   && (data[i] != QLatin1Char(' ') || data[i + 1].isSpace())) {
+            clean = false;
+        }
+    }
+    if (clean) {
+        return query;
+    }
 
+    QString result;
+    result.reserve(size);
+    quoted = false;
+    bool pendingSpace = false;
+    for (int i = 0; i < size; ++i) {
+        const QChar c = data[i];
+        if (!quoted && c.isSpace()) {
+            pendingSpace = !result.isEmpty();
+            continue;
+        }
+        if (pendingSpace) {
+            result += QLatin1Char(' ');
+            pendingSpace = false;
+        }
+        if (c == QLatin1Char('\'')) {
+            quoted = !quoted;
+        }
+        result += c;
+    }
     return result;
 }
 
-void *PredicateParse_newOr(void *pred1, void *pred2)
+// Returns the cached predicate for the normalized query, if any
+static QSharedPointer<const Predicate> cachedPredicate(const QString &key)
 {
-    Solid::Predicate *result = new Solid::Predicate();
-
-    Solid::PredicateParse::ParsingData *data = s_parsingData->localData();
-    Solid::Predicate *p1 = (Solid::Predicate *)pred1;
-    Solid::Predicate *p2 = (Solid::Predicate *)pred2;
-
-    if (p1 == data->result || p2 == data->result) {
-        data->result = nullptr;
+    CacheData *cache = s_cache();
+    QMutexLocker locker(&cache->lock);
+    if (QSharedPointer<const Predicate> *cached = cache->predicates.object(key)) {
+        ++cache->hits;
+        return *cached;
     }
-
-    *result = *p1 | *p2;
-
-    delete p1;
-    delete p2;
-
-    return result;
+    ++cache->misses;
+    return QSharedPointer<const Predicate>();
 }
 
-void *PredicateParse_newStringValue(char *val)
+static void insertPredicate(const QString &key, const Predicate &predicate)
 {
-    QString s(val);
-
-    free(val);
-
-    return new QVariant(s);
+    CacheData *cache = s_cache();
+    QMutexLocker locker(&cache->lock);
+    // Might have been parsed concurrently by another thread, keep the first
+    if (!cache->predicates.contains(key)) {
+        cache->predicates.insert(key, new QSharedPointer<const Predicate>(new Predicate(predicate)));
+    }
 }
 
-void *PredicateParse_newBoolValue(int val)
+qulonglong Cache::hits()
 {
-    bool b = (val != 0);
-    return new QVariant(b);
+    CacheData *cache = s_cache();
+    QMutexLocker locker(&cache->lock);
+    return cache->hits;
 }
 
-void *PredicateParse_newNumValue(int val)
+qulonglong Cache::misses()
 {
-    return new QVariant(val);
+    CacheData *cache = s_cache();
+    QMutexLocker locker(&cache->lock);
+    return cache->misses;
 }
 
-void *PredicateParse_newDoubleValue(double val)
+int Cache::size()
 {
-    return new QVariant(val);
+    CacheData *cache = s_cache();
+    QMutexLocker locker(&cache->lock);
+    return cache->predicates.size();
 }
 
-void *PredicateParse_newEmptyStringListValue()
+void Cache::clear()
 {
-    return new QVariant(QStringList());
+    CacheData *cache = s_cache();
+    QMutexLocker locker(&cache->lock);
+    cache->predicates.clear();
+    cache->hits = 0;
+    cache->misses = 0;
 }
 
-void *PredicateParse_newStringListValue(char *name)
-{
-    QStringList list;
-    list << QString(name);
+}
+}
 
-    free(name);
+void Solid::Predicate::Private::build(const PredicateParse::Result &result, int index)
+{
+    const PredicateParse::Node &node = result.nodes.at(index);
+    if (!node.isValid) {
+        return;
+    }
 
-    return new QVariant(list);
+    isValid = true;
+    type = node.type;
+
+    switch (node.type) {
+    case Conjunction:
+    case Disjunction:
+        operand1 = new Predicate();
+        operand1->d->build(result, node.operand1);
+        operand2 = new Predicate();
+        operand2->d->build(result, node.operand2);
+        break;
+    case InterfaceCheck:
+        ifaceType = node.ifaceType;
+        break;
+    case PropertyCheck:
+        ifaceType = node.ifaceType;
+        property = node.property.toString();
+        value = node.value;
+        compOperator = node.compOperator;
+        break;
+    }
 }
 
-void *PredicateParse_appendStringListValue(char *name, void *list)
+Solid::Predicate Solid::Predicate::fromString(const QString &predicate)
 {
-    QVariant *variant = (QVariant *)list;
+    const QString key = PredicateParse::Cache::normalize(predicate);
 
-    QStringList new_list = variant->toStringList();
+    // Copies share the compiled form of the cached instance
+    if (const QSharedPointer<const Predicate> cached = PredicateParse::cachedPredicate(key)) {
+        return *cached;
+    }
 
-    new_list << QString(name);
+    // Parsed without holding the cache lock, the parser is reentrant. The
+    // whitespace normalization strips doesn't matter to it, parse what the
+    // caller wrote so that error positions are offsets in it.
+    PredicateParse::Result parsed;
+    Predicate result;
 
-    delete variant;
-    free(name);
+    if (PredicateParse::parse(QStringRef(&predicate), &parsed)) {
+        result.d->build(parsed, parsed.root);
+        result.d->program();
+    } else {
+        qWarning("ERROR from solid predicate parser: %s at position %d in predicate '%s'",
+                 qPrintable(parsed.errorMessage), parsed.errorPosition, qPrintable(predicate));
+    }
 
-    return new QVariant(new_list);
+    PredicateParse::insertPredicate(key, result);
+    return result;
+}
+
+qulonglong Solid::Predicate::cacheHits()
+{
+    return PredicateParse::Cache::hits();
 }
 
-void PredicateLexer_unknownToken(const char *text)
+qulonglong Solid::Predicate::cacheMisses()
 {
-    qWarning("ERROR from solid predicate parser: unrecognized token '%s' in predicate '%s'\n",
-             text, s_parsingData->localData()->buffer.constData());
+    return PredicateParse::Cache::misses();
 }
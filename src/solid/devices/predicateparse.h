@@ -21,23 +21,81 @@
 #ifndef PREDICATEPARSE_H
 #define PREDICATEPARSE_H
 
-void PredicateLexer_unknownToken(const char *text);
-
-void PredicateParse_setResult(void *result);
-void PredicateParse_errorDetected(const char *error);
-void PredicateParse_destroy(void *pred);
-
-void *PredicateParse_newAtom(char *interface, char *property, void *value);
-void *PredicateParse_newMaskAtom(char *interface, char *property, void *value);
-void *PredicateParse_newIsAtom(char *interface);
-void *PredicateParse_newAnd(void *pred1, void *pred2);
-void *PredicateParse_newOr(void *pred1, void *pred2);
-void *PredicateParse_newStringValue(char *val);
-void *PredicateParse_newBoolValue(int val);
-void *PredicateParse_newNumValue(int val);
-void *PredicateParse_newDoubleValue(double val);
-void *PredicateParse_newEmptyStringListValue();
-void *PredicateParse_newStringListValue(char *name);
-void *PredicateParse_appendStringListValue(char *name, void *list);
+#include "predicate.h"
+
+#include <QtCore/QString>
+#include <QtCore/QVarLengthArray>
+
+namespace Solid
+{
+namespace PredicateParse
+{
+
+/**
+ * One node of a parsed predicate. Conjunctions and disjunctions refer to
+ * their operands by index in Result::nodes, property names are views on
+ * the parsed text.
+ */
+struct Node {
+    Predicate::Type type = Predicate::PropertyCheck;
+    bool isValid = false; // false if the interface name is unknown
+    DeviceInterface::Type ifaceType = DeviceInterface::Unknown;
+    Predicate::ComparisonOperator compOperator = Predicate::Equals;
+    QStringRef property;
+    QVariant value;
+    int operand1 = -1;
+    int operand2 = -1;
+};
+
+/**
+ * Outcome of parse(): all the nodes live in one array, the root one
+ * being the last. On error, root is -1 and errorPosition is the offset
+ * in the parsed text at which parsing stopped.
+ */
+struct Result {
+    QVarLengthArray<Node, 16> nodes;
+    int root = -1;
+    int errorPosition = -1;
+    QString errorMessage;
+};
+
+/**
+ * Parses the textual form of a predicate.
+ *
+ * This is reentrant: no global or thread local state is involved, so it
+ * can be called from any thread. The text has to outlive the result.
+ *
+ * @return true if the text is a syntactically correct predicate
+ */
+bool parse(const QStringRef &text, Result *result);
+
+/**
+ * Process wide cache of parsed and compiled predicates, keyed by their
+ * normalized text. Predicate::fromString(), and thus every string based
+ * query, goes through it: a given query is parsed once as long as it
+ * stays among the MaxSize most recently used ones. Invalid queries are
+ * cached too.
+ *
+ * All the methods are thread safe.
+ */
+class Cache
+{
+public:
+    enum { MaxSize = 256 };
+
+    /**
+     * Whitespace outside string values collapsed to single spaces and
+     * trimmed, used as the key
+     */
+    static QString normalize(const QString &query);
+
+    static qulonglong hits();
+    static qulonglong misses();
+    static int size();
+    static void clear();
+};
+
+}
+}
 
 #endif
@@ -23,22 +23,74 @@
 
 #include <QtCore/QObject>
 
+#include <functional>
+#include <type_traits>
+
+namespace Solid
+{
+/**
+ * Runs job on the thread owning the device backends and waits for it to
+ * complete. Jobs creating objects or starting asynchronous work in the
+ * backends go through here, so that the objects and the replies belong to
+ * the backend thread.
+ */
+void runInBackendThread(const std::function<void()> &job);
+
+/**
+ * Runs job in the calling thread with the backends locked, against the
+ * backend thread handling their events and against other callers. Cheaper
+ * than runInBackendThread() for the getters, which only read the backends.
+ * The job must not call runInBackendThread().
+ */
+void runWithBackendsLocked(const std::function<void()> &job);
+
+template<typename Function>
+auto callInBackendThread(Function function) -> decltype(function())
+{
+    // Left as is if the backend thread dropped the job while shutting down
+    decltype(function()) result = decltype(function())();
+    runInBackendThread([&result, &function]() {
+        result = function();
+    });
+    return result;
+}
+
+template<typename Function>
+auto callWithBackendsLocked(Function function) -> decltype(function())
+{
+    decltype(function()) result = decltype(function())();
+    runWithBackendsLocked([&result, &function]() {
+        result = function();
+    });
+    return result;
+}
+
+/**
+ * The window to parent the passphrase dialog of StorageAccess::setup() to,
+ * 0 if none. Backends can't look it up from their thread, winId() may
+ * create a native window, so the frontend does in the caller's.
+ */
+uint passphraseWindowId();
+}
+
+// The backend object is resolved with the backends locked, it only gets
+// deleted when its device goes away while they are, never during the call
 #define return_SOLID_CALL(Type, Object, Default, Method) \
-    Type t = qobject_cast<Type>(Object); \
-    if (t!=0) \
-    { \
-        return t->Method; \
-    } \
-    else \
-    { \
+    typedef std::decay<decltype(static_cast<Type>(nullptr)->Method)>::type SolidCallResult; \
+    return Solid::callWithBackendsLocked([&]() -> SolidCallResult { \
+        Type t = qobject_cast<Type>(Object); \
+        if (t != nullptr) { \
+            return t->Method; \
+        } \
         return Default; \
-    }
+    });
 
 #define SOLID_CALL(Type, Object, Method) \
-    Type t = qobject_cast<Type>(Object); \
-    if (t!=0) \
-    { \
-        t->Method; \
-    }
+    Solid::runWithBackendsLocked([&]() { \
+        Type t = qobject_cast<Type>(Object); \
+        if (t != nullptr) { \
+            t->Method; \
+        } \
+    });
 
 #endif